@@ -6,6 +6,7 @@
 #include <iomanip>
 
 #include <string>
+#include <cstring>
 #include <sstream>
 #include <fstream>
 
@@ -17,6 +18,13 @@
 #include <complex> 
 
 #include <algorithm> // weird that you need this to define std::max
+#include <vector>
+#include <stdexcept>
+#include <limits>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
 
 // Constants
 static const double EPS=(1.0e-16);
@@ -37,9 +45,15 @@ static const std::complex<double> one(1.0, 0.0);
 
 #include "Templates.h"
 #include "Useful.h"
+#include "Series_Acceleration.h"
 #include "Chebyshev_Approximation.h"
+#include "Chebyshev_Store.h"
 #include "Faddeeva.hh"
 #include "Special_Functions.h"
 #include "Probability_Functions.h"
+#include "Fourier.h"
+#include "Voigt_Fit.h"
+#include "Line_Spectrum.h"
+#include "Dielectric.h"
 
 #endif
\ No newline at end of file
@@ -2,6 +2,8 @@
 #include "Attach.h"
 #endif
 
+#include "Faddeeva_Simd.hh"
+
 void cheb_appr::chebft(double a, double b, double c[], int n, double (*func)(double))
 {
 	// Chebyshev fit to a function func(x) on the interval [a, b]
@@ -19,8 +21,8 @@ void cheb_appr::chebft(double a, double b, double c[], int n, double (*func)(dou
 
 		if(c1 && c2 && c3){
 
-			int k,j;
-			double fac,bpa,bma,*f;
+			int k; 
+			double bpa,bma,*f; 
 
 			//f=vector(0,n-1);
 			f = new (double [n]); 
@@ -30,13 +32,7 @@ void cheb_appr::chebft(double a, double b, double c[], int n, double (*func)(dou
 				double y=cos(PI*(k+0.5)/n);
 				f[k]=(*func)(y*bma+bpa);
 			}
-			fac=2.0/n;
-			for (j=0;j<n;j++) {
-				double sum=0.0;
-				for (k=0;k<n;k++)
-					sum += f[k]*cos(PI*j*(k+0.5)/n);
-				c[j]=fac*sum;
-			}
+			chebft_coeffs(n, f, c); 
 			//free_vector(f,0,n-1);
 			delete[] f; 
 		}
@@ -59,6 +55,44 @@ void cheb_appr::chebft(double a, double b, double c[], int n, double (*func)(dou
 	}
 }
 
+void cheb_appr::chebft_nodes(double a, double b, int n, double x[])
+{
+	// The Chebyshev nodes on [a, b] used by chebft
+
+	try{
+
+		bool c1 = ( a < b ? true : false); 
+		bool c2 = ( fabs(b - a) > EPS ? true : false); 
+		bool c3 = ( n > 29 ? true : false); 
+
+		if(c1 && c2 && c3){
+
+			double bma = 0.5*(b-a), bpa = 0.5*(b+a); 
+
+			for(int k=0; k<n; k++) x[k] = cos(PI*(k+0.5)/n)*bma + bpa; 
+		}
+		else{
+			std::string reason = "Error: void cheb_appr::chebft_nodes(double a, double b, int n, double x[])\n"; 
+			if(!c1 || !c2) reason += "Domain endpoints are not correctly defined\na = " + template_funcs::toString(a, 3) + ", b = "+ template_funcs::toString(b, 3) + "\n"; 
+			if(!c3) reason += "Number of expansion coefficients n = " + template_funcs::toString(n) + " is not sufficient\n"; 
+			throw std::invalid_argument(reason); 
+		}
+	}
+	catch(std::invalid_argument &e){
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
+	}
+}
+
+void cheb_appr::chebft_coeffs(int n, const double f[], double c[])
+{
+	// The sums c_j = (2/n) \sum_{k} f_k cos(pi j (k + 1/2) / n) form a DCT-II of f, done in O(n log n) by fourier::DCT
+
+	fourier::DCT(n).transform(f, c); 
+
+	for(int j=0; j<n; j++) c[j] *= 2.0/n; 
+}
+
 double cheb_appr::chebev(double a, double b, double c[], int m, double x)
 {
 	// Evaluation of Chebyshev approximation to func(x) on [a, b]
@@ -185,4 +219,890 @@ void cheb_appr::chint(double a, double b, double c[], double cint[], int n)
 		useful_funcs::exit_failure_output(e.what()); 
 		exit(EXIT_FAILURE); 
 	}
+}
+
+namespace {
+
+	struct PieceFit{
+		// Working storage of cheb_appr::PiecewiseChebyshev::build
+		double (*func)(double); 
+		double tol; 
+		int degree, max_depth; 
+		std::vector<double> node_cos; // cos(pi j (k + 0.5) / N), N = degree + 1, at j*N + k
+		std::vector<double> test_y; // cos(pi k / N), k = 1, .., degree, the midpoints in angle between the nodes
+		std::vector<double> f, c; 
+		bool converged; 
+	}; 
+
+	double clenshaw(const double *c, int m, double y)
+	{
+		// -c_0/2 + sum_{j=0}^{m-1} c_j T_j(y), as in chebev, with c_j - dd off the chain of dependent operations
+
+		int j; 
+		double d = 0.0, dd = 0.0, sv, y2 = 2.0 * y; 
+
+		for(j=m-1; j>=1; j--){
+			sv = d; 
+			d = y2 * d + (c[j] - dd); 
+			dd = sv; 
+		}
+
+		return ( y * d + (0.5 * c[0] - dd) ); 
+	}
+
+	static const int NOISE_STALL = 2; // bisections in a row that fail to halve the error before a piece is taken to be noise limited
+
+	void fit_piece(PieceFit &w, double lo, double hi, int depth, double parent_err, int stall, std::vector<double> &brk, std::vector<double> &table)
+	{
+		// Fit the expansion on [lo, hi], append it to the table if it meets the tolerance, bisect otherwise
+		// For a smooth function each bisection divides the error by about 2^degree, so a piece whose error relative to its
+		// scale is already below sqrt(tol) but has not halved over NOISE_STALL bisections is limited by rounding errors in func
+		// and is kept as it is, otherwise a region where func is noisier than tol would be split into 2^max_depth pieces
+		// Pieces next to a singularity also improve slowly, but with errors far above sqrt(tol) until they are resolved
+
+		int j, k, N = w.degree + 1; 
+		double bma = 0.5 * (hi - lo), bpa = 0.5 * (hi + lo), vscale = 0.0, err, sum; 
+
+		for(k=0; k<N; k++){
+			w.f[k] = w.func(w.node_cos[N + k] * bma + bpa); // row j = 1 holds the nodes cos(pi (k + 0.5) / N)
+			vscale = std::max(vscale, fabs(w.f[k])); 
+		}
+
+		for(j=0; j<N; j++){
+			sum = 0.0; 
+			for(k=0; k<N; k++) sum += w.f[k] * w.node_cos[j*N + k]; 
+			w.c[j] = 2.0 * sum / N; 
+		}
+
+		err = fabs(w.c[N-1]) + fabs(w.c[N-2]); 
+
+		for(k=0; k<w.degree; k++){
+			double fx = w.func(w.test_y[k] * bma + bpa); 
+			vscale = std::max(vscale, fabs(fx)); 
+			err = std::max(err, fabs(clenshaw(w.c.data(), N, w.test_y[k]) - fx)); 
+		}
+
+		bool ok = err <= w.tol * vscale; 
+		bool narrow = bma <= 8.0 * std::numeric_limits<double>::epsilon() * std::max(fabs(lo), fabs(hi)); 
+
+		err = vscale > 0.0 ? err / vscale : err; 
+		stall = err > 0.5 * parent_err && err < sqrt(w.tol) ? stall + 1 : 0; 
+
+		if(ok || narrow || depth >= w.max_depth || stall >= NOISE_STALL){
+			if(!ok) w.converged = false; 
+
+			table.push_back(bpa); 
+			table.push_back(1.0 / bma); 
+			table.insert(table.end(), w.c.begin(), w.c.end()); 
+			brk.push_back(hi); 
+		}
+		else{
+			fit_piece(w, lo, bpa, depth + 1, err, stall, brk, table); 
+			fit_piece(w, bpa, hi, depth + 1, err, stall, brk, table); 
+		}
+	}
+}
+
+cheb_appr::PiecewiseChebyshev::PiecewiseChebyshev()
+{
+	// Default constructor
+	pa = pb = inv_bucket = ptol = 0.0; 
+	pdegree = stride = npieces = nbucket = 0; 
+	pconverged = false; 
+	pbrk = ptable = nullptr; 
+	pbucket = nullptr; 
+}
+
+cheb_appr::PiecewiseChebyshev::PiecewiseChebyshev(double (*func)(double), double a, double b, double tol, int degree, int max_depth)
+{
+	// Primary constructor
+	build(func, a, b, tol, degree, max_depth); 
+}
+
+cheb_appr::PiecewiseChebyshev::PiecewiseChebyshev(const PiecewiseChebyshev &f)
+{
+	// Copy constructor
+	*this = f; 
+}
+
+cheb_appr::PiecewiseChebyshev &cheb_appr::PiecewiseChebyshev::operator=(const PiecewiseChebyshev &f)
+{
+	// A copy of an approximant that owns its tables owns copies of them, a copy of one read from a store refers to the same file
+
+	if(this != &f){
+		pa = f.pa; pb = f.pb; inv_bucket = f.inv_bucket; ptol = f.ptol; 
+		pdegree = f.pdegree; stride = f.stride; npieces = f.npieces; nbucket = f.nbucket; 
+		pconverged = f.pconverged; 
+
+		brk = f.brk; table = f.table; bucket = f.bucket; 
+
+		if(f.pbrk == f.brk.data()){
+			use_own_tables(); 
+		}
+		else{
+			pbrk = f.pbrk; ptable = f.ptable; pbucket = f.pbucket; 
+		}
+	}
+
+	return *this; 
+}
+
+void cheb_appr::PiecewiseChebyshev::use_own_tables()
+{
+	// Point the lookups at brk, table and bucket
+
+	pbrk = brk.data(); 
+	ptable = table.data(); 
+	pbucket = bucket.data(); 
+}
+
+void cheb_appr::PiecewiseChebyshev::build(double (*func)(double), double a, double b, double tol, int degree, int max_depth)
+{
+	// Build the piece table of func on [a, b]
+	// The buckets are 4 times as many as the pieces, rounded up to a power of two, so that pieces of average width
+	// are found at once and only the buckets over finely split regions need a binary search
+
+	try{
+		bool c1 = ( a < b ? true : false ); 
+		bool c2 = ( fabs(b - a) > EPS ? true : false ); 
+		bool c3 = ( degree >= 2 && tol > 0.0 && max_depth >= 0 ? true : false ); 
+
+		if(c1 && c2 && c3){
+
+			int i, j, k, N = degree + 1; 
+			PieceFit w; 
+
+			w.func = func; w.tol = tol; w.degree = degree; w.max_depth = max_depth; w.converged = true; 
+			w.node_cos.resize(N * N); w.test_y.resize(degree); w.f.resize(N); w.c.resize(N); 
+
+			for(j=0; j<N; j++){
+				for(k=0; k<N; k++) w.node_cos[j*N + k] = cos(PI * j * (k + 0.5) / N); 
+			}
+			for(k=0; k<degree; k++) w.test_y[k] = cos(PI * (k + 1) / N); 
+
+			pa = a; pb = b; ptol = tol; pdegree = degree; stride = N + 2; 
+
+			brk.assign(1, a); 
+			table.clear(); 
+
+			fit_piece(w, a, b, 0, HUGE_VAL, 0, brk, table); 
+
+			brk.back() = b; 
+			npieces = static_cast<int>(brk.size()) - 1; 
+			pconverged = w.converged; 
+
+			for(nbucket=1; nbucket < 4*npieces; nbucket <<= 1); 
+			inv_bucket = nbucket / (b - a); 
+
+			bucket.resize(nbucket + 1); 
+			for(i=0, k=0; i<nbucket; i++){
+				double xb = a + i / inv_bucket; 
+				while(k < npieces - 1 && brk[k+1] <= xb) k++; 
+				bucket[i] = k; 
+			}
+			bucket[nbucket] = npieces - 1; 
+
+			use_own_tables(); 
+		}
+		else{
+			std::string reason = "Error: void cheb_appr::PiecewiseChebyshev::build(double (*func)(double), double a, double b, double tol, int degree, int max_depth)\n"; 
+			if(!c1 || !c2) reason += "Domain endpoints are not correctly defined\na = " + template_funcs::toString(a, 3) + ", b = " + template_funcs::toString(b, 3) + "\n"; 
+			if(!c3) reason += "degree = " + template_funcs::toString(degree) + " must be at least 2, tol positive and max_depth non-negative\n"; 
+			throw std::invalid_argument(reason); 
+		}
+	}
+	catch(std::invalid_argument &e){
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
+	}
+}
+
+int cheb_appr::PiecewiseChebyshev::locate(double x) const
+{
+	// Pieces bucket[i] .. bucket[i+1] hold the whole of bucket i, search their breakpoints
+
+	int i = std::min(static_cast<int>((x - pa) * inv_bucket), nbucket - 1); 
+	int lo = pbucket[i], hi = pbucket[i+1]; 
+
+	if(lo == hi) return lo; 
+
+	return ( static_cast<int>(std::upper_bound(pbrk + lo + 1, pbrk + hi + 1, x) - pbrk) - 1 ); 
+}
+
+double cheb_appr::PiecewiseChebyshev::eval_piece(int i, double x) const
+{
+	// Clenshaw sum of piece i at x
+
+	const double *row = ptable + i * stride; 
+
+	return clenshaw(row + 2, pdegree + 1, (x - row[0]) * row[1]); 
+}
+
+double cheb_appr::PiecewiseChebyshev::operator()(double x) const
+{
+	// Value of the approximation at x in [a, b]
+
+	try{
+		if( x >= pa && x <= pb && npieces > 0 ){
+			return eval_piece(locate(x), x); 
+		}
+		else{
+			std::string reason = "Error: double cheb_appr::PiecewiseChebyshev::operator()(double x) const\n"; 
+			reason += "x = " + template_funcs::toString(x) + " is not in [" + template_funcs::toString(pa) + ", " + template_funcs::toString(pb) + "]\n"; 
+			throw std::invalid_argument(reason); 
+		}
+	}
+	catch(std::invalid_argument &e){
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
+	}
+}
+
+void cheb_appr::PiecewiseChebyshev::eval(int n, const double *x, double *f) const
+{
+	// Values of the approximation at the n points x[i]
+	// The Clenshaw recurrences of LANES points are run side by side, one recurrence on its own is limited by the latency
+	// of its chain of dependent multiply-adds rather than by the number of operations
+
+	static const int LANES = 4; 
+
+	int i, j, l, m = pdegree + 1; 
+	double y2[LANES], d[LANES], dd[LANES], sv; 
+	const double *row[LANES]; 
+
+	for(i=0; i + LANES <= n; i+=LANES){
+		for(l=0; l<LANES; l++){
+			if( !(x[i + l] >= pa && x[i + l] <= pb) ) (*this)(x[i + l]); // reports the point outside [a, b]
+
+			row[l] = ptable + locate(x[i + l]) * stride; 
+			y2[l] = 2.0 * (x[i + l] - row[l][0]) * row[l][1]; 
+			d[l] = dd[l] = 0.0; 
+		}
+
+		for(j=m-1; j>=1; j--){
+			for(l=0; l<LANES; l++){
+				sv = d[l]; 
+				d[l] = y2[l] * d[l] - dd[l] + row[l][2 + j]; 
+				dd[l] = sv; 
+			}
+		}
+
+		for(l=0; l<LANES; l++) f[i + l] = 0.5 * y2[l] * d[l] - dd[l] + 0.5 * row[l][2]; 
+	}
+
+	for(; i<n; i++) f[i] = (*this)(x[i]); 
+}
+
+cheb_appr::ChebyshevApproximant::ChebyshevApproximant()
+{
+	// Default constructor
+	pa = -1.0; pb = 1.0; scale = 1.0; shift = 0.0; ptol = 0.0; 
+	coef.assign(1, 0.0); 
+	pc = coef.data(); 
+	pn = 1; 
+}
+
+cheb_appr::ChebyshevApproximant::ChebyshevApproximant(double a, double b, const double c[], int n, double tol)
+{
+	// Primary constructor
+	set(a, b, c, n, tol); 
+}
+
+cheb_appr::ChebyshevApproximant::ChebyshevApproximant(const ChebyshevApproximant &f)
+{
+	// Copy constructor
+	*this = f; 
+}
+
+cheb_appr::ChebyshevApproximant &cheb_appr::ChebyshevApproximant::operator=(const ChebyshevApproximant &f)
+{
+	// As for PiecewiseChebyshev, a copy shares the coefficients only when they are in a mapped file
+
+	if(this != &f){
+		pa = f.pa; pb = f.pb; scale = f.scale; shift = f.shift; ptol = f.ptol; pn = f.pn; 
+		coef = f.coef; 
+		pc = f.pc == f.coef.data() ? coef.data() : f.pc; 
+	}
+
+	return *this; 
+}
+
+void cheb_appr::ChebyshevApproximant::set(double a, double b, const double c[], int n, double tol)
+{
+	// Copy the n coefficients c[0..n-1] of an expansion on [a, b] and truncate them to tol
+
+	try{
+
+		bool c1 = ( a < b ? true : false); 
+		bool c2 = ( fabs(b - a) > EPS ? true : false); 
+		bool c3 = ( n > 0 ? true : false); 
+
+		if(c1 && c2 && c3){
+			pa = a; pb = b; 
+			scale = 2.0 / (b - a); 
+			shift = -(a + b) / (b - a); 
+
+			coef.assign(c, c + n); 
+			pc = coef.data(); 
+			pn = n; 
+			ptol = 0.0; 
+
+			truncate(tol); 
+		}
+		else{
+			std::string reason = "Error: void cheb_appr::ChebyshevApproximant::set(double a, double b, const double c[], int n, double tol)\n"; 
+			if(!c1 || !c2) reason += "Domain endpoints are not correctly defined\na = " + template_funcs::toString(a, 3) + ", b = "+ template_funcs::toString(b, 3) + "\n"; 
+			if(!c3) reason += "Number of expansion coefficients n = " + template_funcs::toString(n) + " is not sufficient\n"; 
+			throw std::invalid_argument(reason); 
+		}
+	}
+	catch(std::invalid_argument &e){
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
+	}
+}
+
+void cheb_appr::ChebyshevApproximant::truncate(double tol)
+{
+	// Drop the trailing coefficients whose absolute sum is at most tol times that of all of them, c_0 counted at half weight
+
+	// Only the count changes, so an approximant read from a store is truncated without copying its coefficients
+
+	int m = pn; 
+	double total, tail; 
+
+	if(tol <= ptol || m < 2) return; 
+
+	total = 0.5 * fabs(pc[0]); 
+	for(int k=1; k<m; k++) total += fabs(pc[k]); 
+
+	tail = 0.0; 
+	while(m > 1 && tail + fabs(pc[m - 1]) <= tol * total){
+		tail += fabs(pc[m - 1]); 
+		m--; 
+	}
+
+	pn = m; 
+	ptol = tol; 
+}
+
+double cheb_appr::ChebyshevApproximant::operator()(double x) const
+{
+	// Clenshaw's recurrence, see chebev
+	// c_j - dd is formed off the chain of dependent operations, which is a multiplication and an addition per step
+
+	int j; 
+	double y, y2, d = 0.0, dd = 0.0, sv; 
+
+	y = scale * x + shift; 
+	y2 = 2.0 * y; 
+
+	for(j=pn-1; j>=1; j--){
+		sv = d; 
+		d = y2 * d + (pc[j] - dd); 
+		dd = sv; 
+	}
+
+	return y * d + (0.5 * pc[0] - dd); 
+}
+
+namespace {
+
+	namespace simd = Faddeeva::simd; 
+
+	static const int CLENSHAW_CHAINS = 4; // independent recurrences run together, to hide the latency of each multiply-add
+
+	template <int NV> void clenshaw_simd(const double *c, int m, double scale, double shift, const double *x, double *f)
+	{
+		// Clenshaw's recurrence at NV * simd::width points x[], each vector a separate chain of dependent multiply-adds
+
+		int j, v; 
+		simd::vdouble y[NV], y2[NV], d[NV], dd[NV], sv; 
+
+		for(v=0; v<NV; v++){
+			y[v] = simd::fma(simd::load(x + v * simd::width), simd::set1(scale), simd::set1(shift)); 
+			y2[v] = y[v] + y[v]; 
+			d[v] = dd[v] = simd::set1(0.0); 
+		}
+
+		for(j=m-1; j>=1; j--){
+			const simd::vdouble cj = simd::set1(c[j]); 
+
+			for(v=0; v<NV; v++){
+				sv = d[v]; 
+				d[v] = simd::fma(y2[v], d[v], cj - dd[v]); 
+				dd[v] = sv; 
+			}
+		}
+
+		for(v=0; v<NV; v++) simd::store(f + v * simd::width, simd::fma(y[v], d[v], simd::set1(0.5 * c[0]) - dd[v])); 
+	}
+}
+
+void cheb_appr::ChebyshevApproximant::eval(int n, const double *x, double *f) const
+{
+	// f[i] = f(x[i]) for i = 0, .., n-1, in blocks of CLENSHAW_CHAINS SIMD vectors, then single vectors, then point by point
+
+	int i = 0; 
+
+	for(; i + CLENSHAW_CHAINS * simd::width <= n; i += CLENSHAW_CHAINS * simd::width) clenshaw_simd<CLENSHAW_CHAINS>(pc, pn, scale, shift, x + i, f + i); 
+
+	for(; i + simd::width <= n; i += simd::width) clenshaw_simd<1>(pc, pn, scale, shift, x + i, f + i); 
+
+	for(; i<n; i++) f[i] = (*this)(x[i]); 
+}
+
+cheb_appr::ChebyshevApproximant cheb_appr::ChebyshevApproximant::derivative() const
+{
+	// The recurrence of chder, c'_{j} = c'_{j+2} + 2 (j+1) c_{j+1}, scaled by 2 / (b - a)
+	// The expansion of f' has one coefficient fewer than that of f
+
+	int j, m = size(); 
+	ChebyshevApproximant der; 
+
+	if(m < 2){
+		double zero = 0.0; 
+		der.set(pa, pb, &zero, 1); 
+		return der; 
+	}
+
+	std::vector<double> cder(m - 1); 
+
+	cder[m - 2] = 2.0 * (m - 1) * pc[m - 1]; 
+	if(m > 2) cder[m - 3] = 2.0 * (m - 2) * pc[m - 2]; 
+	for(j=m-4; j>=0; j--) cder[j] = cder[j + 2] + 2.0 * (j + 1) * pc[j + 1]; 
+
+	for(j=0; j<m-1; j++) cder[j] *= scale; 
+
+	der.set(pa, pb, cder.data(), m - 1); 
+
+	return der; 
+}
+
+cheb_appr::ChebyshevApproximant cheb_appr::ChebyshevApproximant::integral() const
+{
+	// The recurrence of chint, C_{j} = (b - a) (c_{j-1} - c_{j+1}) / 4j, with c_{j} = 0 for j >= m so that
+	// the expansion of the integral, one coefficient longer than that of f, is exact
+	// C_0 is chosen so that the integral vanishes at x = a, where T_j(-1) = (-1)^j
+
+	int j, m = size(); 
+	double con, sum, fac; 
+	ChebyshevApproximant in; 
+
+	std::vector<double> cint(m + 1); 
+
+	con = 0.25 * (pb - pa); 
+	sum = 0.0; 
+	fac = 1.0; 
+
+	for(j=1; j<=m; j++){
+		cint[j] = con * (pc[j - 1] - (j + 1 < m ? pc[j + 1] : 0.0)) / j; 
+		sum += fac * cint[j]; 
+		fac = -fac; 
+	}
+
+	cint[0] = 2.0 * sum; 
+
+	in.set(pa, pb, cint.data(), m + 1); 
+
+	return in; 
+}
+
+namespace {
+
+	static const int MAX_DEGREE_2D = 63; // so that a row of coefficients fits the fixed buffers of the 2D evaluation
+
+	struct PatchFit2D{
+		// Working storage of cheb_appr::Chebyshev2D::build_batch
+		const std::function<void(int, const double*, const double*, double*)> *func; 
+		double tol; 
+		int degree, max_depth, N, npad; 
+		std::vector<double> nodes; // cos(pi (k + 0.5) / N)
+		std::vector<double> test; // cos(pi k / N), k = 1, .., degree
+		std::vector<double> xs, ys, fv, tmp, col, colc, c, g; 
+		fourier::DCT dct; 
+		bool converged; 
+	}; 
+
+	double clenshaw2d(const double *c, int N, int ld, double u, double v, double *g)
+	{
+		// sum'_{i} sum'_{j} c[j*ld + i] T_i(u) T_j(v), the sums over j for every i first, into g[0..N-1]
+
+		int i, j; 
+		double v2 = 2.0 * v; 
+
+		for(i=0; i<N; i++){
+			double d = 0.0, dd = 0.0, sv; 
+
+			for(j=N-1; j>=1; j--){
+				sv = d; 
+				d = v2 * d - dd + c[j*ld + i]; 
+				dd = sv; 
+			}
+
+			g[i] = v * d - dd + 0.5 * c[i]; 
+		}
+
+		return clenshaw(g, N, u); 
+	}
+
+	void fit_patch(PatchFit2D &w, double x0, double x1, double y0, double y1, int depth, double parent_err, int stall, int node,
+		std::vector<double> &table, std::vector<double> &node_split, std::vector<int> &node_dim, std::vector<int> &node_next)
+	{
+		// Fit the expansion on [x0, x1] x [y0, y1], append it to the table if it meets the tolerance, bisect it otherwise
+		// The nodes and the test points of the patch are passed to func in one call
+		// Bisection and the test for noise follow fit_piece, depth counting the bisections in both variables
+
+		int i, j, k, N = w.N, nn = N * N, nt = 2 * w.degree; 
+		double hx = 0.5 * (x1 - x0), cx = 0.5 * (x1 + x0), hy = 0.5 * (y1 - y0), cy = 0.5 * (y1 + y0); 
+		double vscale = 0.0, ex = 0.0, ey = 0.0, err, scl = 4.0 / (static_cast<double>(N) * N); 
+
+		for(j=0; j<N; j++){
+			for(i=0; i<N; i++){
+				w.xs[j*N + i] = w.nodes[i] * hx + cx; 
+				w.ys[j*N + i] = w.nodes[j] * hy + cy; 
+			}
+		}
+		for(k=0; k<w.degree; k++){
+			w.xs[nn + 2*k] = w.xs[nn + 2*k + 1] = w.test[k] * hx + cx; 
+			w.ys[nn + 2*k] = w.test[k] * hy + cy; 
+			w.ys[nn + 2*k + 1] = w.test[w.degree - 1 - k] * hy + cy; 
+		}
+
+		(*w.func)(nn + nt, w.xs.data(), w.ys.data(), w.fv.data()); 
+
+		for(k=0; k<nn + nt; k++) vscale = std::max(vscale, fabs(w.fv[k])); 
+
+		// transform across x along each row of nodes, then across y down each column
+		for(j=0; j<N; j++) w.dct.transform(&w.fv[j*N], &w.tmp[j*N]); 
+		for(i=0; i<N; i++){
+			for(j=0; j<N; j++) w.col[j] = w.tmp[j*N + i]; 
+			w.dct.transform(w.col.data(), w.colc.data()); 
+			for(j=0; j<N; j++) w.c[j*N + i] = scl * w.colc[j]; 
+		}
+
+		for(j=0; j<N; j++) ex += fabs(w.c[j*N + N-1]) + fabs(w.c[j*N + N-2]); 
+		for(i=0; i<N; i++) ey += fabs(w.c[(N-1)*N + i]) + fabs(w.c[(N-2)*N + i]); 
+
+		err = std::max(ex, ey); 
+		for(k=0; k<nt; k++){
+			double u = (w.xs[nn + k] - cx) / hx, v = (w.ys[nn + k] - cy) / hy; 
+			err = std::max(err, fabs(clenshaw2d(w.c.data(), N, N, u, v, w.g.data()) - w.fv[nn + k])); 
+		}
+
+		int dim = ex >= ey ? 0 : 1; 
+		double lo = dim == 0 ? x0 : y0, hi = dim == 0 ? x1 : y1; 
+
+		bool ok = err <= w.tol * vscale; 
+		bool narrow = 0.5 * (hi - lo) <= 8.0 * std::numeric_limits<double>::epsilon() * std::max(fabs(lo), fabs(hi)); 
+
+		err = vscale > 0.0 ? err / vscale : err; 
+		stall = err > 0.5 * parent_err && err < sqrt(w.tol) ? stall + 1 : 0; 
+
+		if(ok || narrow || depth >= w.max_depth || stall >= NOISE_STALL){
+			if(!ok) w.converged = false; 
+
+			node_dim[node] = -1; 
+			node_next[node] = static_cast<int>(table.size()) / (4 + N * w.npad); 
+
+			table.push_back(cx); 
+			table.push_back(1.0 / hx); 
+			table.push_back(cy); 
+			table.push_back(1.0 / hy); 
+			for(j=0; j<N; j++){
+				for(i=0; i<w.npad; i++) table.push_back(i < N ? w.c[j*N + i] : 0.0); 
+			}
+		}
+		else{
+			double mid = 0.5 * (lo + hi); 
+			int child = static_cast<int>(node_dim.size()); 
+
+			node_dim[node] = dim; 
+			node_split[node] = mid; 
+			node_next[node] = child; 
+
+			node_dim.resize(child + 2, -1); 
+			node_split.resize(child + 2, 0.0); 
+			node_next.resize(child + 2, 0); 
+
+			if(dim == 0){
+				fit_patch(w, x0, mid, y0, y1, depth + 1, err, stall, child, table, node_split, node_dim, node_next); 
+				fit_patch(w, mid, x1, y0, y1, depth + 1, err, stall, child + 1, table, node_split, node_dim, node_next); 
+			}
+			else{
+				fit_patch(w, x0, x1, y0, mid, depth + 1, err, stall, child, table, node_split, node_dim, node_next); 
+				fit_patch(w, x0, x1, mid, y1, depth + 1, err, stall, child + 1, table, node_split, node_dim, node_next); 
+			}
+		}
+	}
+}
+
+namespace {
+
+	namespace simd = Faddeeva::simd; 
+
+	static const int GROUP_2D = 4; // points evaluated together by Chebyshev2D::eval
+	static const int MAXV_2D = (MAX_DEGREE_2D + simd::width) / simd::width; // vectors in the longest padded row
+
+	template <int P, int NV> void patch_sums_fixed(const double *const *rows, const double *x, const double *y, int N, int npad, double *f)
+	{
+		// f[p] = sum'_{i} sum'_{j} c_{ij} T_i(u_p) T_j(v_p) for P points, each in the patch whose table row is rows[p]
+		// The sums over j for NV vectors of i and P points are P NV independent recurrences, and the P sums over i P more
+		// Each recurrence is run to the end with its state in registers, the processor overlaps the independent ones
+		// to hide the latency of each multiply-add, which interleaving them step by step through arrays would not do
+		// NV = 0 takes the number of vectors from npad, for rows longer than the fixed cases
+
+		int i, j, k, p, nv = NV > 0 ? NV : npad / simd::width; 
+		double u, g[P][MAXV_2D * simd::width], d, dd, sv; // g sized for the longest row, the sums over i read N of its entries
+		simd::vdouble v, v2, b, bb, t; 
+
+		for(p=0; p<P; p++){
+			const double *row = rows[p] + 4; 
+
+			v = simd::set1((y[p] - rows[p][2]) * rows[p][3]); 
+			v2 = v + v; 
+			k = 0; 
+
+			// long rows, e.g. every row when simd::width = 1, have their vectors taken four at a time as four explicit chains
+			if(NV == 0){
+				simd::vdouble b1, b2, b3, bb1, bb2, bb3, t1, t2, t3; 
+
+				for(; k+4<=nv; k+=4){
+					const double *ck = row + k * simd::width; 
+
+					b = b1 = b2 = b3 = bb = bb1 = bb2 = bb3 = simd::set1(0.0); 
+					for(j=N-1; j>=1; j--){
+						const double *cj = ck + j * npad; 
+
+						t = b; t1 = b1; t2 = b2; t3 = b3; 
+						b = simd::fma(v2, b, simd::load(cj) - bb); 
+						b1 = simd::fma(v2, b1, simd::load(cj + simd::width) - bb1); 
+						b2 = simd::fma(v2, b2, simd::load(cj + 2 * simd::width) - bb2); 
+						b3 = simd::fma(v2, b3, simd::load(cj + 3 * simd::width) - bb3); 
+						bb = t; bb1 = t1; bb2 = t2; bb3 = t3; 
+					}
+					simd::store(g[p] + k * simd::width, simd::fma(v, b, simd::set1(0.5) * simd::load(ck) - bb)); 
+					simd::store(g[p] + (k + 1) * simd::width, simd::fma(v, b1, simd::set1(0.5) * simd::load(ck + simd::width) - bb1)); 
+					simd::store(g[p] + (k + 2) * simd::width, simd::fma(v, b2, simd::set1(0.5) * simd::load(ck + 2 * simd::width) - bb2)); 
+					simd::store(g[p] + (k + 3) * simd::width, simd::fma(v, b3, simd::set1(0.5) * simd::load(ck + 3 * simd::width) - bb3)); 
+				}
+			}
+
+			for(; k<nv; k++){
+				b = bb = simd::set1(0.0); 
+				for(j=N-1; j>=1; j--){
+					t = b; 
+					b = simd::fma(v2, b, simd::load(row + j * npad + k * simd::width) - bb); 
+					bb = t; 
+				}
+				simd::store(g[p] + k * simd::width, simd::fma(v, b, simd::set1(0.5) * simd::load(row + k * simd::width) - bb)); 
+			}
+		}
+
+		for(p=0; p<P; p++){
+			u = (x[p] - rows[p][0]) * rows[p][1]; 
+			d = dd = 0.0; 
+			for(i=N-1; i>=1; i--){
+				sv = d; 
+				d = 2.0 * u * d + (g[p][i] - dd); 
+				dd = sv; 
+			}
+			f[p] = u * d + (0.5 * g[p][0] - dd); 
+		}
+	}
+
+	template <int P> void patch_sums(const double *const *rows, const double *x, const double *y, int N, int npad, double *f)
+	{
+		// patch_sums_fixed for the number of vectors in a row, beyond 4 vectors the points are taken one at a time
+
+		switch(npad / simd::width){
+			case 1: patch_sums_fixed<P, 1>(rows, x, y, N, npad, f); break; 
+			case 2: patch_sums_fixed<P, 2>(rows, x, y, N, npad, f); break; 
+			case 3: patch_sums_fixed<P, 3>(rows, x, y, N, npad, f); break; 
+			case 4: patch_sums_fixed<P, 4>(rows, x, y, N, npad, f); break; 
+			default: 
+				for(int p=0; p<P; p++) patch_sums_fixed<1, 0>(rows + p, x + p, y + p, N, npad, f + p); 
+		}
+	}
+}
+
+cheb_appr::Chebyshev2D::Chebyshev2D()
+{
+	// Default constructor
+	pax = pbx = pay = pby = ptol = inv_cellx = inv_celly = 0.0; 
+	pdegree = npad = stride = npatches = ncx = ncy = 0; 
+	pconverged = false; 
+}
+
+void cheb_appr::Chebyshev2D::build_batch(const std::function<void(int, const double*, const double*, double*)> &func, double ax, double bx, double ay, double by, double tol, int degree, int max_depth)
+{
+	// Build the patch table and the k-d tree of f on [ax, bx] x [ay, by]
+
+	try{
+		bool c1 = ( ax < bx && ay < by ? true : false ); 
+		bool c2 = ( fabs(bx - ax) > EPS && fabs(by - ay) > EPS ? true : false ); 
+		bool c3 = ( degree >= 2 && degree <= MAX_DEGREE_2D && tol > 0.0 && max_depth >= 0 ? true : false ); 
+
+		if(c1 && c2 && c3){
+
+			int k, N = degree + 1; 
+			PatchFit2D w; 
+
+			w.func = &func; w.tol = tol; w.degree = degree; w.max_depth = max_depth; w.converged = true; 
+			w.N = N; 
+			w.npad = ((N + Faddeeva::simd::width - 1) / Faddeeva::simd::width) * Faddeeva::simd::width; 
+			w.nodes.resize(N); w.test.resize(degree); 
+			w.xs.resize(N * N + 2 * degree); w.ys.resize(N * N + 2 * degree); w.fv.resize(N * N + 2 * degree); 
+			w.tmp.resize(N * N); w.col.resize(N); w.colc.resize(N); w.c.resize(N * N); w.g.resize(N); 
+			w.dct.set_size(N); 
+
+			for(k=0; k<N; k++) w.nodes[k] = cos(PI * (k + 0.5) / N); 
+			for(k=0; k<degree; k++) w.test[k] = cos(PI * (k + 1) / N); 
+
+			pax = ax; pbx = bx; pay = ay; pby = by; ptol = tol; 
+			pdegree = degree; npad = w.npad; stride = 4 + N * npad; 
+
+			table.clear(); 
+			node_split.assign(1, 0.0); 
+			node_dim.assign(1, -1); 
+			node_next.assign(1, 0); 
+
+			fit_patch(w, ax, bx, ay, by, 0, HUGE_VAL, 0, 0, table, node_split, node_dim, node_next); 
+
+			npatches = static_cast<int>(table.size()) / stride; 
+			pconverged = w.converged; 
+
+			build_cells(); 
+		}
+		else{
+			std::string reason = "Error: void cheb_appr::Chebyshev2D::build_batch(const std::function<void(int, const double*, const double*, double*)> &func, double ax, double bx, double ay, double by, double tol, int degree, int max_depth)\n"; 
+			if(!c1 || !c2) reason += "Domain endpoints are not correctly defined\nax = " + template_funcs::toString(ax, 3) + ", bx = " + template_funcs::toString(bx, 3) + ", ay = " + template_funcs::toString(ay, 3) + ", by = " + template_funcs::toString(by, 3) + "\n"; 
+			if(!c3) reason += "degree = " + template_funcs::toString(degree) + " must lie in [2, " + template_funcs::toString(MAX_DEGREE_2D) + "], tol must be positive and max_depth non-negative\n"; 
+			throw std::invalid_argument(reason); 
+		}
+	}
+	catch(std::invalid_argument &e){
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
+	}
+}
+
+void cheb_appr::Chebyshev2D::build_cells()
+{
+	// The splits halve their node, so the cells of a uniform 2^lx by 2^ly grid lie wholly on one side of every split
+	// down to depth lx in x and ly in y, and the descent for a cell can stop at the first split that cuts through it
+	// The grid has about 4 cells per patch, shared between x and y in proportion to the deepest splits in each
+
+	int i, j, k, lx, ly, bits, dx = 0, dy = 0; 
+	std::vector<int> depth_x(node_dim.size(), 0), depth_y(node_dim.size(), 0); 
+
+	for(k=0; k<static_cast<int>(node_dim.size()); k++){
+		// children are always stored after their parent
+		if(node_dim[k] >= 0){
+			for(int c=node_next[k]; c<=node_next[k]+1; c++){
+				depth_x[c] = depth_x[k] + (node_dim[k] == 0 ? 1 : 0); 
+				depth_y[c] = depth_y[k] + (node_dim[k] == 1 ? 1 : 0); 
+			}
+		}
+		else{
+			dx = std::max(dx, depth_x[k]); 
+			dy = std::max(dy, depth_y[k]); 
+		}
+	}
+
+	for(bits=0; (1 << bits) < 4 * npatches && bits < 16; bits++); 
+
+	lx = dx + dy > 0 ? std::min(dx, (bits * dx + (dx + dy) / 2) / (dx + dy)) : 0; 
+	ly = std::min(dy, bits - lx); 
+	lx = std::min(dx, bits - ly); 
+
+	ncx = 1 << lx; 
+	ncy = 1 << ly; 
+	inv_cellx = ncx / (pbx - pax); 
+	inv_celly = ncy / (pby - pay); 
+
+	cell_node.resize(ncx * ncy); 
+
+	for(j=0; j<ncy; j++){
+		for(i=0; i<ncx; i++){
+			double xlo = pax + i / inv_cellx, xhi = pax + (i + 1) / inv_cellx; 
+			double ylo = pay + j / inv_celly, yhi = pay + (j + 1) / inv_celly; 
+
+			k = 0; 
+			while(node_dim[k] >= 0){
+				double lo = node_dim[k] == 0 ? xlo : ylo, hi = node_dim[k] == 0 ? xhi : yhi, s = node_split[k]; 
+
+				if(s <= lo) k = node_next[k] + 1; 
+				else if(s >= hi) k = node_next[k]; 
+				else break; 
+			}
+
+			cell_node[j*ncx + i] = k; 
+		}
+	}
+}
+
+int cheb_appr::Chebyshev2D::locate(double x, double y) const
+{
+	// Descend the k-d tree to the leaf holding (x, y), from the node of its cell
+
+	int i = std::min(static_cast<int>((x - pax) * inv_cellx), ncx - 1); 
+	int j = std::min(static_cast<int>((y - pay) * inv_celly), ncy - 1); 
+	int k = cell_node[j*ncx + i]; 
+
+	while(node_dim[k] >= 0) k = node_next[k] + ( (node_dim[k] == 0 ? x : y) >= node_split[k] ? 1 : 0 ); 
+
+	return node_next[k]; 
+}
+
+double cheb_appr::Chebyshev2D::eval_patch(int p, double x, double y) const
+{
+	// Value of patch p at (x, y)
+
+	const double *row = &table[p * stride]; 
+	double f; 
+
+	patch_sums<1>(&row, &x, &y, pdegree + 1, npad, &f); 
+
+	return f; 
+}
+
+double cheb_appr::Chebyshev2D::operator()(double x, double y) const
+{
+	// Value of the approximation at (x, y) in [ax, bx] x [ay, by]
+
+	try{
+		if( x >= pax && x <= pbx && y >= pay && y <= pby && npatches > 0 ){
+			return eval_patch(locate(x, y), x, y); 
+		}
+		else{
+			std::string reason = "Error: double cheb_appr::Chebyshev2D::operator()(double x, double y) const\n"; 
+			reason += "(x, y) = (" + template_funcs::toString(x) + ", " + template_funcs::toString(y) + ") is not in [" + template_funcs::toString(pax) + ", " + template_funcs::toString(pbx) + "] x [" + template_funcs::toString(pay) + ", " + template_funcs::toString(pby) + "]\n"; 
+			throw std::invalid_argument(reason); 
+		}
+	}
+	catch(std::invalid_argument &e){
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
+	}
+}
+
+void cheb_appr::Chebyshev2D::eval(int n, const double *x, const double *y, double *f) const
+{
+	// Values of the approximation at the n points (x[i], y[i]), GROUP_2D points at a time
+
+	int i, l; 
+	const double *rows[GROUP_2D]; 
+
+	for(i=0; i + GROUP_2D <= n; i+=GROUP_2D){
+		for(l=0; l<GROUP_2D; l++){
+			if( !(x[i + l] >= pax && x[i + l] <= pbx && y[i + l] >= pay && y[i + l] <= pby) ) (*this)(x[i + l], y[i + l]); // reports the point outside the domain
+
+			rows[l] = &table[locate(x[i + l], y[i + l]) * stride]; 
+		}
+
+		patch_sums<GROUP_2D>(rows, x + i, y + i, pdegree + 1, npad, f + i); 
+	}
+
+	for(; i<n; i++) f[i] = (*this)(x[i], y[i]); 
 }
\ No newline at end of file
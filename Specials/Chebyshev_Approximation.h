@@ -9,12 +9,221 @@ namespace cheb_appr{
 	
 	void chebft(double a, double b, double c[], int n, double (*func)(double)); 
 
+	// chebft for any callable func, e.g. a lambda binding the parameters of special::Voigt or the order of special::bessjy
+	// func(x) is called once at each of the n nodes and can be inlined
+	template <class F> void chebft(double a, double b, double c[], int n, F func); 
+
+	// chebft with all n nodes passed to func(n, x, f) in one call, which must set f[k] to the function value at x[k]
+	// so that an expensive function can be evaluated by its array version or shared out among threads
+	template <class F> void chebft_batch(double a, double b, double c[], int n, F func); 
+
+	// The n nodes x[0..n-1] at which chebft samples func on [a, b], x_k = 0.5(b-a) cos(pi (k + 1/2) / n) + 0.5(b+a)
+	// a, b and n must satisfy the same conditions as in chebft
+	void chebft_nodes(double a, double b, int n, double x[]); 
+
+	// The coefficients c[0..n-1] of chebft from the function values f[0..n-1] at the nodes of chebft_nodes
+	void chebft_coeffs(int n, const double f[], double c[]); 
+
 	double chebev(double a, double b, double c[], int m, double x); 
 
 	void chder(double a, double b, double c[], double cder[], int n); 
 
 	void chint(double a, double b, double c[], double cint[], int n); 
 
+	// Piecewise Chebyshev approximation to func on [a, b], for functions that a single expansion from chebft fits badly
+	// [a, b] is bisected recursively until on every piece the expansion of the given degree, fitted at degree + 1 Chebyshev nodes,
+	// has its last two coefficients and its error at the degree midpoints between the nodes below tol times max |func| on the piece
+	// A piece that reaches max_depth bisections, or whose error stops falling because func itself is not accurate to tol,
+	// is kept as it is and converged() returns false
+	// The pieces are stored in one flat table, each row holding the centre and inverse half-width of a piece followed by its
+	// coefficients, and a uniform grid of buckets over [a, b] gives the range of pieces to search for x, so that a lookup is
+	// a multiplication and usually a binary search over one or two breakpoints
+	// The tables are read through pointers, which refer to the object's own storage or, for an approximant found in an
+	// ApproximantStore, to the mapped file
+	class PiecewiseChebyshev{
+	public:
+		PiecewiseChebyshev(); 
+		PiecewiseChebyshev(double (*func)(double), double a, double b, double tol = 1.0e-13, int degree = 12, int max_depth = 40); 
+		PiecewiseChebyshev(const PiecewiseChebyshev &f); 
+
+		PiecewiseChebyshev &operator=(const PiecewiseChebyshev &f); 
+
+		void build(double (*func)(double), double a, double b, double tol = 1.0e-13, int degree = 12, int max_depth = 40); 
+
+		double operator()(double x) const; // x must lie in [a, b]
+		void eval(int n, const double *x, double *f) const; 
+
+		int locate(double x) const; // index of the piece holding x
+
+		int pieces() const { return npieces; }
+		int degree() const { return pdegree; }
+		int buckets() const { return nbucket; }
+		double lower() const { return pa; }
+		double upper() const { return pb; }
+		double tolerance() const { return ptol; }
+		bool converged() const { return pconverged; }
+
+		const double *breakpoints() const { return pbrk; } // npieces + 1 values
+		const double *pieces_table() const { return ptable; } // npieces rows of degree + 3 values
+		const int *bucket_table() const { return pbucket; } // nbucket + 1 values
+
+	private:
+		friend class ApproximantStore; 
+
+		double eval_piece(int i, double x) const; 
+		void use_own_tables(); 
+
+		double pa, pb, inv_bucket, ptol; 
+		int pdegree, stride, npieces, nbucket; 
+		bool pconverged; 
+
+		std::vector<double> brk; // breakpoints a = brk[0] < brk[1] < .. < brk[npieces] = b
+		std::vector<double> table; // row i at i*stride: centre, 1 / half-width, c_0, .., c_degree of piece i
+		std::vector<int> bucket; // piece holding the left end of each bucket, and npieces - 1 at the end
+
+		const double *pbrk, *ptable; // brk and table, or their copies in a mapped file
+		const int *pbucket; 
+	}; 
+
+	// A Chebyshev expansion f(x) = c_0/2 + sum_{k=1}^{m-1} c_k T_k(y) on [a, b] that owns its coefficients
+	// The map y = scale x + shift is computed once, so evaluation is the Clenshaw recurrence alone, without the checks of chebev
+	// x outside [a, b] is not checked and extrapolates
+	// The coefficients are truncated to the first m for which sum_{k>=m} |c_k| <= tol (|c_0|/2 + sum_{k>=1} |c_k|),
+	// a bound on the error relative to the largest value of the expansion, tol <= 0 keeps all of them
+	// eval evaluates arrays of points several SIMD vectors at a time
+	// Like PiecewiseChebyshev, the coefficients are read through a pointer that may refer to a mapped ApproximantStore
+	class ChebyshevApproximant{
+	public:
+		ChebyshevApproximant(); 
+		ChebyshevApproximant(double a, double b, const double c[], int n, double tol = 0.0); // from the n coefficients of chebft
+		template <class F> ChebyshevApproximant(F func, double a, double b, int n = 64, double tol = 1.0e-15); // fitted by chebft
+		ChebyshevApproximant(const ChebyshevApproximant &f); 
+
+		ChebyshevApproximant &operator=(const ChebyshevApproximant &f); 
+
+		void set(double a, double b, const double c[], int n, double tol = 0.0); 
+		template <class F> void build(F func, double a, double b, int n = 64, double tol = 1.0e-15); 
+
+		void truncate(double tol); 
+
+		double operator()(double x) const; 
+		void eval(int n, const double *x, double *f) const; 
+
+		ChebyshevApproximant derivative() const; // expansion of f'(x), as from chder
+		ChebyshevApproximant integral() const; // expansion of the integral of f from a to x, as from chint
+
+		int size() const { return pn; } // number of coefficients kept
+		const double *coeffs() const { return pc; }
+		double lower() const { return pa; }
+		double upper() const { return pb; }
+		double tolerance() const { return ptol; } // largest tol it has been truncated to
+
+	private:
+		friend class ApproximantStore; 
+
+		double pa, pb, scale, shift, ptol; 
+		int pn; 
+		std::vector<double> coef; 
+		const double *pc; // coef, or its copy in a mapped file
+	}; 
+
+	// Tensor-product Chebyshev approximation f(x, y) = sum'_{i} sum'_{j} c_{ij} T_i(u) T_j(v) on [ax, bx] x [ay, by],
+	// the primes halving the terms with i = 0 or j = 0 as in chebft, u and v the maps of x and y onto [-1, 1]
+	// The rectangle is split recursively, as in PiecewiseChebyshev, into patches on each of which the expansion of the given
+	// degree in x and in y, fitted at the (degree + 1)^2 tensor Chebyshev nodes, has its last two columns and rows of
+	// coefficients and its error at 2 degree test points between the nodes below tol times max |f| on the patch
+	// A patch that fails is bisected across the variable whose trailing coefficients are the larger, so that a function that
+	// varies quickly in one variable only is split along that one only
+	// The patches are found by descending a k-d tree of the splits from the node that a uniform grid of cells over the domain
+	// gives for x, so that most lookups start at their leaf, the sum over j is done for all i together in SIMD vectors
+	// and the sum over i by Clenshaw's recurrence, eval running the recurrences of several points side by side
+	// func(n, x, y, f) in build_batch must set f[k] = f(x[k], y[k]), it is passed all the nodes of a patch at once
+	class Chebyshev2D{
+	public:
+		Chebyshev2D(); 
+		template <class F> Chebyshev2D(F func, double ax, double bx, double ay, double by, double tol = 1.0e-12, int degree = 12, int max_depth = 24); 
+
+		template <class F> void build(F func, double ax, double bx, double ay, double by, double tol = 1.0e-12, int degree = 12, int max_depth = 24); 
+		void build_batch(const std::function<void(int, const double*, const double*, double*)> &func, double ax, double bx, double ay, double by, double tol = 1.0e-12, int degree = 12, int max_depth = 24); 
+
+		double operator()(double x, double y) const; // (x, y) must lie in [ax, bx] x [ay, by]
+		void eval(int n, const double *x, const double *y, double *f) const; 
+
+		int locate(double x, double y) const; // index of the patch holding (x, y)
+
+		int patches() const { return npatches; }
+		int degree() const { return pdegree; }
+		double tolerance() const { return ptol; }
+		bool converged() const { return pconverged; }
+
+	private:
+		double eval_patch(int p, double x, double y) const; 
+		void build_cells(); 
+
+		double pax, pbx, pay, pby, ptol, inv_cellx, inv_celly; 
+		int pdegree, npad, stride, npatches, ncx, ncy; 
+		bool pconverged; 
+
+		// row p at p*stride: centre and inverse half-width in x, the same in y, then c_{ij} at 4 + j*npad + i, for i < npad
+		// the rows of coefficients are padded with zeros to npad, a multiple of the SIMD width
+		std::vector<double> table; 
+
+		// k-d tree of the splits, node k splits at node_split[k] across x (node_dim[k] = 0) or y (1) and its children are
+		// node_next[k] and node_next[k] + 1 for below and above the split, a leaf (node_dim[k] = -1) holds patch node_next[k]
+		std::vector<double> node_split; 
+		std::vector<int> node_dim, node_next; 
+
+		std::vector<int> cell_node; // deepest node holding the whole of cell (i, j) at j*ncx + i
+	}; 
+
+	// Definitions
+
+	template <class F> void chebft(double a, double b, double c[], int n, F func)
+	{
+		std::vector<double> x(std::max(n, 1)), f(std::max(n, 1)); 
+
+		chebft_nodes(a, b, n, x.data()); 
+
+		for(int k=0; k<n; k++) f[k] = func(x[k]); 
+
+		chebft_coeffs(n, f.data(), c); 
+	}
+
+	template <class F> void chebft_batch(double a, double b, double c[], int n, F func)
+	{
+		std::vector<double> x(std::max(n, 1)), f(std::max(n, 1)); 
+
+		chebft_nodes(a, b, n, x.data()); 
+
+		func(n, static_cast<const double*>(x.data()), f.data()); 
+
+		chebft_coeffs(n, f.data(), c); 
+	}
+
+	template <class F> ChebyshevApproximant::ChebyshevApproximant(F func, double a, double b, int n, double tol)
+	{
+		build(func, a, b, n, tol); 
+	}
+
+	template <class F> void ChebyshevApproximant::build(F func, double a, double b, int n, double tol)
+	{
+		std::vector<double> c(std::max(n, 1)); 
+
+		chebft(a, b, c.data(), n, func); 
+
+		set(a, b, c.data(), n, tol); 
+	}
+
+	template <class F> Chebyshev2D::Chebyshev2D(F func, double ax, double bx, double ay, double by, double tol, int degree, int max_depth)
+	{
+		build(func, ax, bx, ay, by, tol, degree, max_depth); 
+	}
+
+	template <class F> void Chebyshev2D::build(F func, double ax, double bx, double ay, double by, double tol, int degree, int max_depth)
+	{
+		build_batch([&func](int n, const double *x, const double *y, double *f){ for(int k=0; k<n; k++) f[k] = func(x[k], y[k]); }, ax, bx, ay, by, tol, degree, max_depth); 
+	}
+
 }
 
 #endif
\ No newline at end of file
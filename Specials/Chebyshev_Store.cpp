@@ -0,0 +1,419 @@
+#ifndef ATTACH_H
+#include "Attach.h"
+#endif
+
+#include <cstdint>
+#include <cstdio>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Definition of the file of Chebyshev approximants declared in Chebyshev_Store.h
+
+namespace {
+
+	static const char STORE_TAG[8] = {'C', 'H', 'E', 'B', 'S', 'T', 'O', 'R'}; 
+	static const uint32_t STORE_VERSION = 1; 
+	static const uint64_t STORE_BYTE_ORDER = 0x0102030405060708ULL; // reads differently on a machine of the other byte order
+
+	static const int32_t KIND_SINGLE = 1; // ChebyshevApproximant
+	static const int32_t KIND_PIECEWISE = 2; // PiecewiseChebyshev
+
+	struct StoreHeader{
+		char tag[8]; 
+		uint32_t version; 
+		uint32_t nentries; 
+		uint64_t file_size; 
+		uint64_t byte_order; 
+		uint64_t checksum; // of the directory
+		uint64_t reserved[3]; 
+	}; 
+
+	struct StoreRecord{
+		char name[cheb_appr::ApproximantStore::STORE_NAME_LENGTH]; 
+		double a, b, tol; 
+		int32_t kind; 
+		int32_t degree; // of each piece, or number of coefficients - 1
+		int32_t count; // number of pieces, or of coefficients
+		int32_t nbucket; 
+		int32_t converged; 
+		int32_t reserved; 
+		uint64_t offset; // of the data from the start of the file
+		uint64_t bytes; 
+		uint64_t checksum; // of the data
+	}; 
+
+	static_assert(sizeof(StoreHeader) == 64, "StoreHeader must have no padding"); 
+	static_assert(sizeof(int) == sizeof(int32_t), "the bucket table of PiecewiseChebyshev is stored as 32-bit integers"); 
+	static_assert(sizeof(StoreRecord) % 8 == 0, "StoreRecord must keep the data 8-byte aligned"); 
+
+	uint64_t checksum64(const void *data, size_t bytes)
+	{
+		// FNV-1a taken over 64-bit words rather than bytes, with a shift folding the high bits of the product back down
+		// bytes must be a multiple of 8
+
+		const unsigned char *p = static_cast<const unsigned char*>(data); 
+		uint64_t h = 0xcbf29ce484222325ULL, w; 
+
+		for(size_t i=0; i<bytes; i+=8){
+			memcpy(&w, p + i, 8); 
+			h = (h ^ w) * 0x100000001b3ULL; 
+			h ^= h >> 29; 
+		}
+
+		return h; 
+	}
+
+	size_t pad8(size_t bytes)
+	{
+		return (bytes + 7) & ~static_cast<size_t>(7); 
+	}
+
+	size_t piecewise_bytes(int npieces, int degree, int nbucket)
+	{
+		// breakpoints, piece table and bucket table
+
+		return (npieces + 1) * sizeof(double) + static_cast<size_t>(npieces) * (degree + 3) * sizeof(double) + pad8((nbucket + 1) * sizeof(int32_t)); 
+	}
+
+	void fill_record(StoreRecord &r, const std::string &name, int32_t kind, double a, double b, double tol)
+	{
+		memset(&r, 0, sizeof(StoreRecord)); 
+		name.copy(r.name, cheb_appr::ApproximantStore::STORE_NAME_LENGTH - 1); 
+		r.kind = kind; 
+		r.a = a; 
+		r.b = b; 
+		r.tol = tol; 
+	}
+}
+
+cheb_appr::ApproximantStore::ApproximantStore()
+{
+	// Default constructor
+	base = nullptr; 
+	length = 0; 
+	nentries = 0; 
+	file_handle = map_handle = nullptr; 
+}
+
+cheb_appr::ApproximantStore::~ApproximantStore()
+{
+	// Destructor, unmaps the file
+	close(); 
+}
+
+void cheb_appr::ApproximantStore::add(const std::string &name, const ChebyshevApproximant &f)
+{
+	// Keep a copy of f to be written by save
+
+	try{
+		if( !name.empty() && name.size() < static_cast<size_t>(STORE_NAME_LENGTH) ){
+			single_names.push_back(name); 
+			single.push_back(f); 
+		}
+		else{
+			std::string reason = "Error: void cheb_appr::ApproximantStore::add(const std::string &name, const ChebyshevApproximant &f)\n"; 
+			reason += "name \"" + name + "\" must have between 1 and " + template_funcs::toString(STORE_NAME_LENGTH - 1) + " characters\n"; 
+			throw std::invalid_argument(reason); 
+		}
+	}
+	catch(std::invalid_argument &e){
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
+	}
+}
+
+void cheb_appr::ApproximantStore::add(const std::string &name, const PiecewiseChebyshev &f)
+{
+	// Keep a copy of f to be written by save
+
+	try{
+		if( !name.empty() && name.size() < static_cast<size_t>(STORE_NAME_LENGTH) && f.pieces() > 0 ){
+			piecewise_names.push_back(name); 
+			piecewise.push_back(f); 
+		}
+		else{
+			std::string reason = "Error: void cheb_appr::ApproximantStore::add(const std::string &name, const PiecewiseChebyshev &f)\n"; 
+			if(f.pieces() == 0) reason += "the approximant has not been built\n"; 
+			else reason += "name \"" + name + "\" must have between 1 and " + template_funcs::toString(STORE_NAME_LENGTH - 1) + " characters\n"; 
+			throw std::invalid_argument(reason); 
+		}
+	}
+	catch(std::invalid_argument &e){
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
+	}
+}
+
+bool cheb_appr::ApproximantStore::save(const std::string &filename) const
+{
+	// Lay out the directory and data, checksum them and write the file
+	// The file is written under a temporary name and renamed when complete, so that no process maps a partly written store
+	// The temporary name carries the process id and a count of the saves in this process, so that processes or threads saving
+	// the same store at once do not write over each other's file, whichever rename comes last leaves its complete store in place
+
+	size_t i, n = single.size() + piecewise.size(); 
+	size_t offset = sizeof(StoreHeader) + n * sizeof(StoreRecord); 
+
+	std::vector<StoreRecord> dir(n); 
+	std::vector<char> data; 
+
+	for(i=0; i<single.size(); i++){
+		const ChebyshevApproximant &f = single[i]; 
+		StoreRecord &r = dir[i]; 
+
+		fill_record(r, single_names[i], KIND_SINGLE, f.lower(), f.upper(), f.tolerance()); 
+		r.degree = f.size() - 1; 
+		r.count = f.size(); 
+		r.converged = 1; 
+		r.offset = offset + data.size(); 
+		r.bytes = f.size() * sizeof(double); 
+
+		data.insert(data.end(), reinterpret_cast<const char*>(f.coeffs()), reinterpret_cast<const char*>(f.coeffs() + f.size())); 
+		r.checksum = checksum64(&data[data.size() - r.bytes], r.bytes); 
+	}
+
+	for(i=0; i<piecewise.size(); i++){
+		const PiecewiseChebyshev &f = piecewise[i]; 
+		StoreRecord &r = dir[single.size() + i]; 
+		size_t start = data.size(); 
+
+		fill_record(r, piecewise_names[i], KIND_PIECEWISE, f.lower(), f.upper(), f.tolerance()); 
+		r.degree = f.degree(); 
+		r.count = f.pieces(); 
+		r.nbucket = f.buckets(); 
+		r.converged = f.converged() ? 1 : 0; 
+		r.offset = offset + start; 
+		r.bytes = piecewise_bytes(f.pieces(), f.degree(), f.buckets()); 
+
+		data.resize(start + r.bytes, 0); 
+		char *p = &data[start]; 
+		size_t nbrk = (f.pieces() + 1) * sizeof(double), ntab = static_cast<size_t>(f.pieces()) * (f.degree() + 3) * sizeof(double); 
+
+		memcpy(p, f.breakpoints(), nbrk); 
+		memcpy(p + nbrk, f.pieces_table(), ntab); 
+		memcpy(p + nbrk + ntab, f.bucket_table(), (f.buckets() + 1) * sizeof(int32_t)); 
+
+		r.checksum = checksum64(p, r.bytes); 
+	}
+
+	StoreHeader h; 
+	memset(&h, 0, sizeof(StoreHeader)); 
+	memcpy(h.tag, STORE_TAG, 8); 
+	h.version = STORE_VERSION; 
+	h.nentries = static_cast<uint32_t>(n); 
+	h.file_size = offset + data.size(); 
+	h.byte_order = STORE_BYTE_ORDER; 
+	h.checksum = checksum64(dir.data(), n * sizeof(StoreRecord)); 
+
+	static std::atomic<unsigned> nsaves(0); 
+
+#ifdef _WIN32
+	unsigned long pid = GetCurrentProcessId(); 
+#else
+	unsigned long pid = static_cast<unsigned long>(getpid()); 
+#endif
+
+	std::string tmpname = filename + "." + std::to_string(pid) + "." + std::to_string(nsaves++) + ".tmp"; 
+
+	std::ofstream write(tmpname.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc); 
+
+	if( !write.is_open() ) return false; 
+
+	write.write(reinterpret_cast<const char*>(&h), sizeof(StoreHeader)); 
+	write.write(reinterpret_cast<const char*>(dir.data()), n * sizeof(StoreRecord)); 
+	write.write(data.data(), data.size()); 
+	write.close(); 
+
+	if( write.fail() ){
+		std::remove(tmpname.c_str()); 
+		return false; 
+	}
+
+	// rename replaces an existing file atomically on POSIX, on Windows it fails if the file exists and MoveFileEx is needed
+#ifdef _WIN32
+	bool moved = MoveFileExA(tmpname.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING) != 0; 
+#else
+	bool moved = std::rename(tmpname.c_str(), filename.c_str()) == 0; 
+#endif
+
+	if(!moved) std::remove(tmpname.c_str()); 
+
+	return moved; 
+}
+
+bool cheb_appr::ApproximantStore::open(const std::string &filename)
+{
+	// Map the file read-only and check its header and directory
+	// The data of each entry is checked by find, so that opening the store does not read every page of it
+
+	close(); 
+
+	size_t len = 0; 
+	const char *p = nullptr; 
+
+#ifdef _WIN32
+	HANDLE fh = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL); 
+	if(fh == INVALID_HANDLE_VALUE) return false; 
+
+	LARGE_INTEGER size; 
+	if( !GetFileSizeEx(fh, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(StoreHeader)) ){
+		CloseHandle(fh); 
+		return false; 
+	}
+	len = static_cast<size_t>(size.QuadPart); 
+
+	HANDLE mh = CreateFileMappingA(fh, NULL, PAGE_READONLY, 0, 0, NULL); 
+	if(mh == NULL){
+		CloseHandle(fh); 
+		return false; 
+	}
+
+	p = static_cast<const char*>(MapViewOfFile(mh, FILE_MAP_READ, 0, 0, 0)); 
+	if(p == nullptr){
+		CloseHandle(mh); 
+		CloseHandle(fh); 
+		return false; 
+	}
+
+	file_handle = fh; 
+	map_handle = mh; 
+#else
+	int fd = ::open(filename.c_str(), O_RDONLY); 
+	if(fd < 0) return false; 
+
+	struct stat st; 
+	if( fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(StoreHeader)) ){
+		::close(fd); 
+		return false; 
+	}
+	len = static_cast<size_t>(st.st_size); 
+
+	void *v = mmap(nullptr, len, PROT_READ, MAP_SHARED, fd, 0); 
+	::close(fd); // the mapping keeps the file open
+	if(v == MAP_FAILED) return false; 
+
+	p = static_cast<const char*>(v); 
+#endif
+
+	base = p; 
+	length = len; 
+
+	StoreHeader h; 
+	memcpy(&h, base, sizeof(StoreHeader)); 
+
+	bool ok = memcmp(h.tag, STORE_TAG, 8) == 0 && h.version == STORE_VERSION && h.byte_order == STORE_BYTE_ORDER && h.file_size == length; 
+	ok = ok && h.nentries <= (length - sizeof(StoreHeader)) / sizeof(StoreRecord); 
+	ok = ok && checksum64(base + sizeof(StoreHeader), h.nentries * sizeof(StoreRecord)) == h.checksum; 
+
+	if(!ok){
+		close(); 
+		return false; 
+	}
+
+	nentries = static_cast<int>(h.nentries); 
+
+	return true; 
+}
+
+void cheb_appr::ApproximantStore::close()
+{
+	// Unmap the file, approximants found in it are no longer valid
+
+	if(base != nullptr){
+#ifdef _WIN32
+		UnmapViewOfFile(base); 
+		CloseHandle(static_cast<HANDLE>(map_handle)); 
+		CloseHandle(static_cast<HANDLE>(file_handle)); 
+#else
+		munmap(const_cast<char*>(base), length); 
+#endif
+	}
+
+	base = nullptr; 
+	length = 0; 
+	nentries = 0; 
+	file_handle = map_handle = nullptr; 
+}
+
+const void *cheb_appr::ApproximantStore::locate_entry(const std::string &name, int kind, double a, double b, double tol, int degree) const
+{
+	// Directory record matching all of the build parameters whose data lies inside the file and passes its checksum
+
+	if(base == nullptr || name.size() >= static_cast<size_t>(STORE_NAME_LENGTH)) return nullptr; 
+
+	const StoreRecord *dir = reinterpret_cast<const StoreRecord*>(base + sizeof(StoreHeader)); 
+
+	for(int i=0; i<nentries; i++){
+		const StoreRecord &r = dir[i]; 
+
+		if( r.kind != kind || r.a != a || r.b != b || r.tol != tol ) continue; 
+		if( kind == KIND_PIECEWISE && r.degree != degree ) continue; 
+		if( strncmp(r.name, name.c_str(), STORE_NAME_LENGTH) != 0 ) continue; 
+
+		bool ok = r.offset % 8 == 0 && r.offset <= length && r.bytes <= length - r.offset && r.count > 0; 
+
+		if(kind == KIND_SINGLE) ok = ok && r.bytes == r.count * sizeof(double); 
+		else ok = ok && r.degree >= 2 && r.nbucket > 0 && r.bytes == piecewise_bytes(r.count, r.degree, r.nbucket); 
+
+		if( ok && checksum64(base + r.offset, r.bytes) == r.checksum ) return &r; 
+	}
+
+	return nullptr; 
+}
+
+bool cheb_appr::ApproximantStore::find(const std::string &name, double a, double b, double tol, ChebyshevApproximant &f) const
+{
+	// Point f at the coefficients in the mapped file
+
+	const StoreRecord *r = static_cast<const StoreRecord*>(locate_entry(name, KIND_SINGLE, a, b, tol, 0)); 
+
+	if(r == nullptr) return false; 
+
+	f.pa = a; f.pb = b; f.ptol = tol; 
+	f.scale = 2.0 / (b - a); 
+	f.shift = -(a + b) / (b - a); 
+	f.coef.clear(); 
+	f.pc = reinterpret_cast<const double*>(base + r->offset); 
+	f.pn = r->count; 
+
+	return true; 
+}
+
+bool cheb_appr::ApproximantStore::find(const std::string &name, double a, double b, double tol, int degree, PiecewiseChebyshev &f) const
+{
+	// Point the tables of f at the mapped file
+
+	const StoreRecord *r = static_cast<const StoreRecord*>(locate_entry(name, KIND_PIECEWISE, a, b, tol, degree)); 
+
+	if(r == nullptr) return false; 
+
+	const double *p = reinterpret_cast<const double*>(base + r->offset); 
+
+	f.pa = a; f.pb = b; f.ptol = tol; 
+	f.pdegree = degree; 
+	f.stride = degree + 3; 
+	f.npieces = r->count; 
+	f.nbucket = r->nbucket; 
+	f.inv_bucket = f.nbucket / (b - a); 
+	f.pconverged = r->converged != 0; 
+
+	f.brk.clear(); f.table.clear(); f.bucket.clear(); 
+	f.pbrk = p; 
+	f.ptable = p + (f.npieces + 1); 
+	f.pbucket = reinterpret_cast<const int*>(f.ptable + static_cast<size_t>(f.npieces) * f.stride); 
+
+	return true; 
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#ifndef CHEBYSHEV_STORE_H
+#define CHEBYSHEV_STORE_H
+
+// Declaration of a binary file of Chebyshev approximants, so that approximants that take seconds to build are built once,
+// saved, and then read by every process that needs them by mapping the file into memory read-only
+// The operating system shares the pages of the mapped file between all processes that map it, and find() points the tables of
+// an approximant at the mapped data instead of copying them, so opening a store costs one mapping however large it is
+// Each entry records the name of the function and the parameters it was built with, find() only returns an entry that matches
+// all of them and whose data passes its checksum, otherwise the caller builds the approximant afresh
+// The format is native-endian, the header records the byte order and the version so that a foreign file is rejected
+//
+// File layout, all sections 8-byte aligned
+// header   : tag "CHEBSTOR", version, number of entries, file size, byte order mark, checksum of the directory
+// directory: one fixed-size record per entry, name, kind, domain, tol, degree, sizes, offset and checksum of its data
+// data     : coefficients of a ChebyshevApproximant, or breakpoints, piece table and bucket table of a PiecewiseChebyshev
+
+namespace cheb_appr{
+
+	class ApproximantStore{
+	public:
+		ApproximantStore(); 
+		~ApproximantStore(); 
+
+		// Writing, add copies the approximant, save writes everything added so far
+		// name identifies the function, e.g. "bessy0" or "Voigt G = 1.5", and is at most STORE_NAME_LENGTH - 1 characters
+		void add(const std::string &name, const ChebyshevApproximant &f); 
+		void add(const std::string &name, const PiecewiseChebyshev &f); 
+
+		bool save(const std::string &filename) const; // false if the file cannot be written
+
+		// Reading, open maps the file and checks its header and directory, false if it is missing, of another version or corrupt
+		// The approximants returned by find refer to the mapping and must not be used after close or the destruction of the store
+		bool open(const std::string &filename); 
+		void close(); 
+
+		bool is_open() const { return base != nullptr; }
+		int entries() const { return nentries; }
+
+		// Approximant saved under name with the same domain [a, b] and tolerance, and for PiecewiseChebyshev the same degree
+		// f is unchanged and false returned if there is none or its data fails the checksum
+		bool find(const std::string &name, double a, double b, double tol, ChebyshevApproximant &f) const; 
+		bool find(const std::string &name, double a, double b, double tol, int degree, PiecewiseChebyshev &f) const; 
+
+		static const int STORE_NAME_LENGTH = 64; 
+
+	private:
+		ApproximantStore(const ApproximantStore &); // not copyable, the mapping has one owner
+		ApproximantStore &operator=(const ApproximantStore &); 
+
+		const void *locate_entry(const std::string &name, int kind, double a, double b, double tol, int degree) const; 
+
+		// approximants added for writing
+		std::vector<std::string> single_names; 
+		std::vector<ChebyshevApproximant> single; 
+		std::vector<std::string> piecewise_names; 
+		std::vector<PiecewiseChebyshev> piecewise; 
+
+		// mapped file
+		const char *base; 
+		size_t length; 
+		int nentries; 
+		void *file_handle, *map_handle; // used on Windows only
+	}; 
+}
+
+#endif
\ No newline at end of file
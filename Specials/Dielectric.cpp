@@ -0,0 +1,177 @@
+#ifndef ATTACH_H
+#include "Attach.h"
+#endif
+
+// Definition of the dielectric function models declared in the namespace dielectric
+
+namespace {
+
+	static const int FREQ_BLOCK = 256; // frequencies whose w(z) are evaluated in one call of the array version of Faddeeva::w
+
+	void check_model(const dielectric::BrendelBormann &m, int n, const double *omega)
+	{
+		// Throw if a width or a frequency cannot be used
+
+		int i; 
+		size_t j; 
+		std::string reason; 
+
+		for(j=0; j<m.osc.size(); j++){
+			if( !(m.osc[j].sigma > 0.0) || !(m.osc[j].Gamma >= 0.0) ){
+				reason = "Error: dielectric::BrendelBormann\n"; 
+				reason += "oscillator " + template_funcs::toString(j) + " has sigma = " + template_funcs::toString(m.osc[j].sigma); 
+				reason += ", Gamma = " + template_funcs::toString(m.osc[j].Gamma) + ", sigma must be positive and Gamma non-negative\n"; 
+				throw std::invalid_argument(reason); 
+			}
+		}
+
+		for(i=0; i<n; i++){
+			if( !(omega[i] > 0.0) ){
+				reason = "Error: dielectric::BrendelBormann\n"; 
+				reason += "omega[" + template_funcs::toString(i) + "] = " + template_funcs::toString(omega[i]) + " must be positive\n"; 
+				throw std::invalid_argument(reason); 
+			}
+		}
+	}
+
+	void evaluate(const dielectric::BrendelBormann &m, int n, const double *omega, std::complex<double> *eps, std::complex<double> *deps)
+	{
+		// eps, and deps when it is not null, at the n frequencies
+		// For each block of frequencies the arguments x^- and x^+ of every oscillator are stored side by side, so that one call
+		// of Faddeeva::w covers them all, and each chi_j is then assembled from its pair of w
+		// With K = i sqrt(pi) f omega_p^2 / (2 sqrt(2) a sigma) and S = w(x^-) + w(x^+), chi = K S and
+		// dchi/df = K S / f, dchi/domega_p = 2 K S / omega_p, dchi/domega_j = K (w'(x^+) - w'(x^-)) / (sqrt(2) sigma)
+		// dchi/dsigma = -(chi + K (x^- w'(x^-) + x^+ w'(x^+))) / sigma, since dx^{+-}/dsigma = -x^{+-} / sigma
+		// dchi/dGamma = (i omega / (2 a)) (K (w'(x^-) + w'(x^+)) / (sqrt(2) sigma) - chi / a), since da/dGamma = i omega / (2 a)
+
+		const std::complex<double> itwo_rtpi(0.0, 2.0 / sqrt(PI)); 
+
+		int i, j, b, nb, nosc, q; 
+		double rt2s, wp2; 
+		std::complex<double> a, Ka, K, chi, xm, xp, wm, wp, dwm, dwp, drude, den; 
+
+		nosc = static_cast<int>(m.osc.size()); 
+		wp2 = m.omega_p * m.omega_p; 
+
+		std::vector<double> zr(2 * nosc * FREQ_BLOCK), zi(2 * nosc * FREQ_BLOCK), wr(2 * nosc * FREQ_BLOCK), wi(2 * nosc * FREQ_BLOCK); 
+		std::vector< std::complex<double> > av(nosc * FREQ_BLOCK); 
+
+		for(b=0; b<n; b+=FREQ_BLOCK){
+			nb = std::min(FREQ_BLOCK, n - b); 
+
+			for(j=0; j<nosc; j++){
+				rt2s = sqrt(2.0) * m.osc[j].sigma; 
+
+				for(i=0; i<nb; i++){
+					a = sqrt( std::complex<double>(omega[b + i] * omega[b + i], omega[b + i] * m.osc[j].Gamma) ); 
+
+					q = j*nb + i; 
+					av[q] = a; 
+					zr[2*q] = (real(a) - m.osc[j].omega) / rt2s; zi[2*q] = imag(a) / rt2s; 
+					zr[2*q + 1] = (real(a) + m.osc[j].omega) / rt2s; zi[2*q + 1] = imag(a) / rt2s; 
+				}
+			}
+
+			Faddeeva::w(2 * nosc * nb, zr.data(), zi.data(), wr.data(), wi.data()); 
+
+			for(i=0; i<nb; i++){
+				// Drude term
+				den = omega[b + i] * (omega[b + i] + eye * m.Gamma0); 
+				drude = m.f0 * wp2 / den; 
+
+				eps[b + i] = 1.0 - drude; 
+
+				if(deps != nullptr){
+					deps[b + i] = -2.0 * m.f0 * m.omega_p / den; 
+					deps[n + b + i] = -wp2 / den; 
+					deps[2*n + b + i] = eye * drude / (omega[b + i] + eye * m.Gamma0); 
+				}
+			}
+
+			for(j=0; j<nosc; j++){
+				const dielectric::Oscillator &o = m.osc[j]; 
+
+				rt2s = sqrt(2.0) * o.sigma; 
+
+				for(i=0; i<nb; i++){
+					q = j*nb + i; 
+					a = av[q]; 
+
+					wm = std::complex<double>(wr[2*q], wi[2*q]); 
+					wp = std::complex<double>(wr[2*q + 1], wi[2*q + 1]); 
+
+					Ka = eye * sqrt(PI) / (2.0 * a * rt2s); 
+					K = o.f * wp2 * Ka; 
+					chi = K * (wm + wp); 
+
+					eps[b + i] += chi; 
+
+					if(deps != nullptr){
+						xm = std::complex<double>(zr[2*q], zi[2*q]); 
+						xp = std::complex<double>(zr[2*q + 1], zi[2*q + 1]); 
+
+						dwm = -2.0 * xm * wm + itwo_rtpi; 
+						dwp = -2.0 * xp * wp + itwo_rtpi; 
+
+						deps[b + i] += 2.0 * o.f * m.omega_p * Ka * (wm + wp); 
+
+						std::complex<double> *dk = deps + (dielectric::NPAR_DRUDE + dielectric::NPAR_OSC * j) * n + b + i; 
+
+						dk[0] = wp2 * Ka * (wm + wp); 
+						dk[n] = (eye * omega[b + i] / (2.0 * a)) * (K * (dwm + dwp) / rt2s - chi / a); 
+						dk[2*n] = K * (dwp - dwm) / rt2s; 
+						dk[3*n] = -(chi + K * (xm * dwm + xp * dwp)) / o.sigma; 
+					}
+				}
+			}
+		}
+	}
+}
+
+int dielectric::npar(const BrendelBormann &m)
+{
+	// Number of parameters of the model
+
+	return ( NPAR_DRUDE + NPAR_OSC * static_cast<int>(m.osc.size()) ); 
+}
+
+void dielectric::epsilon(const BrendelBormann &m, int n, const double *omega, std::complex<double> *eps)
+{
+	// Brendel-Bormann dielectric function at n frequencies
+
+	try{
+		check_model(m, n, omega); 
+
+		evaluate(m, n, omega, eps, nullptr); 
+	}
+	catch(std::invalid_argument &e){
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
+	}
+}
+
+std::complex<double> dielectric::epsilon(const BrendelBormann &m, double omega)
+{
+	// Brendel-Bormann dielectric function at one frequency
+
+	std::complex<double> eps; 
+
+	epsilon(m, 1, &omega, &eps); 
+
+	return eps; 
+}
+
+void dielectric::epsilon_grad(const BrendelBormann &m, int n, const double *omega, std::complex<double> *eps, std::complex<double> *deps)
+{
+	// Brendel-Bormann dielectric function and its derivatives with respect to the npar(m) parameters at n frequencies
+
+	try{
+		check_model(m, n, omega); 
+
+		evaluate(m, n, omega, eps, deps); 
+	}
+	catch(std::invalid_argument &e){
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
+	}
+}
\ No newline at end of file
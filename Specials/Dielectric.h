@@ -0,0 +1,46 @@
+#ifndef DIELECTRIC_H
+#define DIELECTRIC_H
+
+// Declaration of a namespace for dielectric function models of metals
+// The Brendel-Bormann model of Rakic et al., Appl. Opt., 37, 5271, 1998, is a Drude term plus oscillators whose Lorentzian
+// line is convolved with a Gaussian distribution of resonance frequencies
+// eps(omega) = 1 - f0 omega_p^2 / (omega (omega + i Gamma0)) + sum_{j} chi_j(omega)
+// chi_j = (i sqrt(pi) f_j omega_p^2 / (2 sqrt(2) a_j sigma_j)) [w(x_j^-) + w(x_j^+)]
+// a_j = sqrt(omega^2 + i omega Gamma_j), Im(a_j) > 0, x_j^{+-} = (a_j +- omega_j) / (sqrt(2) sigma_j)
+// All frequencies and widths are in the same unit, usually eV, and Im(eps) > 0 for an absorbing medium
+// The 2 w(z) of every oscillator at every frequency are gathered into one call of the array version of Faddeeva::w
+// per block of frequencies, and the derivatives with respect to the parameters reuse those w through w' = -2 z w + 2i / sqrt(pi)
+
+namespace dielectric{
+
+	static const int NPAR_OSC = 4; // parameters per oscillator, stored in the order (f, Gamma, omega, sigma)
+	static const int NPAR_DRUDE = 3; // parameters of the Drude term, stored in the order (omega_p, f0, Gamma0)
+
+	struct Oscillator{
+		double f; // strength
+		double Gamma; // Lorentzian damping
+		double omega; // resonance frequency
+		double sigma; // standard deviation of the Gaussian broadening of the resonance frequency
+	}; 
+
+	struct BrendelBormann{
+		double omega_p; // plasma frequency
+		double f0; // strength of the Drude term
+		double Gamma0; // damping of the Drude term
+		std::vector<Oscillator> osc; 
+	}; 
+
+	// Number of parameters, NPAR_DRUDE + NPAR_OSC * (number of oscillators), in the order
+	// (omega_p, f0, Gamma0, f_1, Gamma_1, omega_1, sigma_1, f_2, ..)
+	int npar(const BrendelBormann &m); 
+
+	// eps[i] = eps(omega[i]) at n frequencies omega[i] > 0
+	void epsilon(const BrendelBormann &m, int n, const double *omega, std::complex<double> *eps); 
+
+	std::complex<double> epsilon(const BrendelBormann &m, double omega); 
+
+	// eps as above and its derivatives deps[k*n + i] = d eps(omega[i]) / dp_k, one column of n values per parameter in the order of npar
+	void epsilon_grad(const BrendelBormann &m, int n, const double *omega, std::complex<double> *eps, std::complex<double> *deps); 
+}
+
+#endif
\ No newline at end of file
@@ -31,31 +31,103 @@
 
 namespace Faddeeva {
 
+// Constants of the Algorithm 916 sums in w(z) for one accuracy relerr, as
+// set up at the top of w(z) on every call: a = pi/sqrt(-log(relerr/2)),
+// c = (2/pi) a, a2 = a^2, the table of exp(-a2 n^2) and the term bound
+// used by the array routines.  Build one per accuracy tier and pass it to
+// the overloads below instead of relerr.  The results agree with the relerr
+// overloads to within rounding (about 1e-15 relative, from the tabulated
+// exponentials), and bit for bit at the default relerr.
+class FaddeevaContext {
+public:
+  explicit FaddeevaContext(double relerr=0); // relerr as for w(z, relerr)
+
+  static const int NEXPA2N2 = 64; // table length, enough for relerr >= DBL_EPSILON
+
+  double relerr() const { return prelerr; }
+  double a() const { return pa; }
+  double c() const { return pc; }
+  double a2() const { return pa2; }
+  double kterm() const { return pkterm; } // sums stop within floor((x + kterm)/a) + 1 terms
+  const double *expa2n2() const { return pexpa2n2; } // exp(-a2 n^2) for n = 1, 2, ..., ending in 0
+
+private:
+  double prelerr, pa, pc, pa2, pkterm;
+  double pexpa2n2[NEXPA2N2];
+};
+
 // compute w(z) = exp(-z^2) erfc(-iz) [ Faddeeva / scaled complex error func ]
 extern std::complex<double> w(std::complex<double> z,double relerr=0);
+extern std::complex<double> w(std::complex<double> z, const FaddeevaContext &ctx);
 extern double w_im(double x); // special-case code for Im[w(x)] of real x
+extern void w_im(int n, const double *x, double *f); // f[j] = w_im(x[j]), vectorized
+
+// compute w(z) for the n points z[j] = re[j] + i*im[j], returning the real
+// and imaginary parts of w in wre[j] and wim[j]; vectorized, see Faddeeva_Batch.cc
+extern void w(int n, const double *re, const double *im, double *wre, double *wim, double relerr=0);
+extern void w(int n, const double *re, const double *im, double *wre, double *wim, const FaddeevaContext &ctx);
+extern const char *simd_isa(); // instruction set used by the array versions
+
+// Re w(z) alone, the Voigt function K(x, y) = Re w(x + iy), in real
+// arithmetic: the same regions as w(z) without the sums, sines and the
+// division that only feed Im w.  The array versions are vectorized as
+// those of w, see Faddeeva_Batch.cc.
+extern double w_re(double x, double y, double relerr=0);
+extern double w_re(double x, double y, const FaddeevaContext &ctx);
+extern void w_re(int n, const double *re, const double *im, double *wre, double relerr=0);
+extern void w_re(int n, const double *re, const double *im, double *wre, const FaddeevaContext &ctx);
+
+// Algorithms for w(z).  ADAPTIVE is the code above, accurate to relerr with a
+// cost that depends on z.  WEIDEMAN16 and WEIDEMAN32 are Weideman's rational
+// approximation with N = 16 or 32 terms, at a fixed cost per point and a
+// maximum error relative to |w| of about 5e-7 and 5e-13 respectively; the
+// error is absolute in size, so Re[w] alone loses relative accuracy where
+// Re[w] << |w|, i.e. near the real axis for |x| > 4.  See Faddeeva_Batch.cc.
+enum Method { ADAPTIVE, WEIDEMAN16, WEIDEMAN32 };
+extern std::complex<double> w(std::complex<double> z, Method method);
+extern void w(int n, const double *re, const double *im, double *wre, double *wim, Method method);
 
 // Various functions that we can compute with the help of w(z)
 
 // compute erfcx(z) = exp(z^2) erfc(z)
 extern std::complex<double> erfcx(std::complex<double> z, double relerr=0);
+extern std::complex<double> erfcx(std::complex<double> z, const FaddeevaContext &ctx);
 extern double erfcx(double x); // special case for real x
+extern void erfcx(int n, const double *x, double *f); // f[j] = erfcx(x[j]), vectorized
 
 // compute erf(z), the error function of complex arguments
 extern std::complex<double> erf(std::complex<double> z, double relerr=0);
+extern std::complex<double> erf(std::complex<double> z, const FaddeevaContext &ctx);
 extern double erf(double x); // special case for real x
+extern void erf(int n, const double *x, double *f); // f[j] = erf(x[j]), vectorized
 
 // compute erfi(z) = -i erf(iz), the imaginary error function
 extern std::complex<double> erfi(std::complex<double> z, double relerr=0);
+extern std::complex<double> erfi(std::complex<double> z, const FaddeevaContext &ctx);
 extern double erfi(double x); // special case for real x
 
 // compute erfc(z) = 1 - erf(z), the complementary error function
 extern std::complex<double> erfc(std::complex<double> z, double relerr=0);
+extern std::complex<double> erfc(std::complex<double> z, const FaddeevaContext &ctx);
 extern double erfc(double x); // special case for real x
+extern void erfc(int n, const double *x, double *f); // f[j] = erfc(x[j]), vectorized
 
 // compute Dawson(z) = sqrt(pi)/2  *  exp(-z^2) * erfi(z)
 extern std::complex<double> Dawson(std::complex<double> z, double relerr=0);
+extern std::complex<double> Dawson(std::complex<double> z, const FaddeevaContext &ctx);
 extern double Dawson(double x); // special case for real x
+extern void Dawson(int n, const double *x, double *f); // f[j] = Dawson(x[j]), vectorized
+
+// Single precision, accurate to 2e-6 relative in |w| for y >= 0 (5e-6 in
+// Im w alone) and to 3e-6 for y < 0 away from the zeros of w, near which
+// 2 exp(-z^2) - w(-z) cancels; the array versions run twice as many lanes
+// per vector as the double ones, see Faddeeva_Float.cc
+extern std::complex<float> w(std::complex<float> z);
+extern void w(int n, const float *re, const float *im, float *wre, float *wim);
+extern float erfcx(float x);
+extern void erfcx(int n, const float *x, float *f);
+extern float Dawson(float x);
+extern void Dawson(int n, const float *x, float *f);
 
 } // namespace Faddeeva
 
@@ -0,0 +1,932 @@
+//  -*- mode:c++; tab-width:2; indent-tabs-mode:nil;  -*-
+
+/* Array versions of the Faddeeva function w(z), companion to Faddeeva.cc
+   and distributed under the same MIT license.
+
+   Faddeeva::w(n, re, im, wre, wim, relerr) computes w(z) for the n points
+   z[j] = re[j] + i*im[j]; the overload taking a FaddeevaContext skips
+   building the relerr constants on each call.  Real and imaginary parts
+   are passed in separate arrays (structure of arrays) so that a vector
+   load picks up simd::width consecutive points without any shuffling.
+
+   Each point is assigned to one of the regions used by the scalar
+   FADDEEVA(w) in Faddeeva.cc:
+
+      continued fraction      ya > 7, or x > 6 away from the real axis
+      Algorithm 916 sums      5e-4 <= x < 10 otherwise
+
+   and evaluated by a vector kernel for that region (see Faddeeva_Simd.hh
+   for the instruction sets).  The remaining points are handed to the
+   scalar Faddeeva::w one at a time: Re z = 0, Im z = 0, Inf/NaN,
+   |z| > 1e150, the x < 5e-4 Taylor-series case and the x >= 10,
+   |y| < 1e-10 tail of Algorithm 916, and y < 0 points whose reflection
+   term 2 exp(-z^2) overflows or has a phase too large for the vector
+   sincos.
+
+   There are two ways of feeding the kernels:
+
+   - masked: consecutive blocks of simd::width points, running the kernel
+     of each region present in the block under a lane mask.  The kernels
+     follow the scalar code step by step, including the term-count
+     estimate of the continued fraction and the per-lane convergence test
+     of the sums, so the results agree with the scalar routine to a few
+     ulp.  This is used for short arrays and for ordered input such as a
+     frequency sweep, where neighbouring points fall in the same region.
+
+   - region-sorted (w_sorted below): the points of a chunk are keyed by
+     region and trip count, sorted into homogeneous sub-batches and run
+     through kernels with a fixed trip count and no masks, then scattered
+     back.  This keeps the vectors full when the regions are interleaved
+     at random.  The sums are taken to a term count bounded from x alone,
+     at most a couple of terms more than the scalar code uses, so the
+     results stay within relerr of it.
+
+   erfcx(y) in the Algorithm 916 region comes from the vector version of
+   the real erfcx below, which gathers the coefficients of the Chebyshev
+   tables of Faddeeva.cc lane by lane.  The same kernels give the array
+   versions of erfcx, erf, erfc, Dawson and w_im for real arguments.
+
+   Faddeeva::w_re(n, re, im, wre) runs the same code for Re w alone (the
+   kernels' IM = false instances): the Algorithm 916 lanes skip sum4,
+   sum5 and sin(2xy) and stop on sum3, as the scalar w_re in Faddeeva.cc,
+   and also take Re z = 0 and x < 5e-4, which need the scalar code only
+   for the cancellation in Im w.
+
+   The overloads taking a Faddeeva::Method replace all of this with
+   Weideman's rational approximation, which has a fixed cost per point
+   and a lower accuracy; see the table further down. */
+
+#include "Faddeeva.hh"
+#include "Faddeeva_Simd.hh"
+#include "Faddeeva_Tables.hh"
+
+#include <cfloat>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+using namespace Faddeeva::simd;
+
+/////////////////////////////////////////////////////////////////////////
+// The constants of the Algorithm 916 sums come from a FaddeevaContext, see
+// Faddeeva.hh, built once per call for a non-default relerr and once per
+// program run for the default one.
+
+using Faddeeva::FaddeevaContext;
+
+namespace {
+
+const int NEXPA2N2 = FaddeevaContext::NEXPA2N2; // terms needed for x < 10 at relerr = DBL_EPSILON is about 32
+
+const FaddeevaContext &default_context()
+{
+  static const FaddeevaContext ctx(0); // thread-safe initialisation in C++11
+  return ctx;
+}
+
+/////////////////////////////////////////////////////////////////////////
+// Real arguments, following FADDEEVA_RE(erfcx) and FADDEEVA(w_im) in
+// Faddeeva.cc: continued fractions for large |x| and otherwise the 100
+// piecewise Chebyshev polynomials of Faddeeva_Tables.hh, where each lane
+// gathers the coefficients of its own row for one Horner pass.
+
+namespace tables = Faddeeva::tables;
+
+// Row j = min(floor(y100), rows-1) of a table for each lane: the gather
+// offsets j*stride into idx, and t = 2*y100 - (2j+1) for the polynomial
+inline vdouble cheb_row(vdouble y100, int rows, int stride, int *idx)
+{
+  const vdouble j = min(floor(y100), set1(rows - 1));
+  store_int(idx, j * double(stride));
+  return 2.0*y100 - (2.0*j + 1.0);
+}
+
+// Horner sum, lowest degree first, of the coefficients c[idx[k] + i]
+template <int NCOEF>
+inline vdouble cheb_sum(const double *c, const int *idx, vdouble t)
+{
+  vdouble p = gather(c + (NCOEF-1), idx);
+  for (int i = NCOEF-2; i >= 0; --i)
+    p = p*t + gather(c + i, idx);
+  return p;
+}
+
+// erfcx(x) for x >= 0 or NaN
+inline vdouble erfcx_pos(vdouble x)
+{
+  const double ispi = 0.56418958354775628694807945156; // 1 / sqrt(pi)
+  // lanes with x > 50 or NaN read row 0 and are replaced below
+  const vdouble y100 = select(x <= 50.0, 400.0 / (x + 4.0), set1(0.5));
+  int idx[width];
+  const vdouble t = cheb_row(y100, tables::ERFCX_ROWS, tables::ERFCX_STRIDE, idx);
+  vdouble f = cheb_sum<7>(&tables::erfcx_cheb[0][0], idx, t);
+  f = select(y100 >= 100.0, set1(1.0), f); // x < 4 eps
+
+  // continued fraction for x > 50, 1 term for x > 5e7 to avoid overflow
+  const vdouble x2 = x*x;
+  const vdouble cf = select(x > 5e7, ispi / x,
+                            ispi*(x2*(x2 + 4.5) + 2.0) / (x*(x2*(x2 + 5.0) + 3.75)));
+  f = select(x > 50.0, cf, f);
+  return select(x == x, f, x);
+}
+
+// erfcx(x) for real x, erfcx(-x) = 2 exp(x^2) - erfcx(x)
+inline vdouble erfcx_real(vdouble x)
+{
+  const vdouble f = erfcx_pos(abs(x));
+  const vdouble e2 = 2.0*exp(x*x);
+  vdouble g = select(x < -6.1, e2, e2 - f);
+  g = select(x < -26.7, set1(HUGE_VAL), g);
+  return select(x < 0.0, g, f);
+}
+
+// erf(x) = 1 - exp(-x^2) erfcx(x) as in the pre-C++11 branch of
+// FADDEEVA_RE(erf) (the scalar routine now uses ::erf), but with the Taylor
+// series taken to x^17 and used for |x| < 0.25 rather than to x^9 for
+// |x| < 8e-2, which loses about 1e-14 on both sides of the switch.  The
+// exponent is clamped at -40, where 1 - exp(-x^2) erfcx(x) already rounds
+// to 1, so that lanes with large |x| do no arithmetic on subnormals
+inline vdouble erf_real(vdouble x)
+{
+  const vdouble mx2 = -(x*x);
+  const vdouble f = 1.0 - exp(max(mx2, set1(-40.0))) * erfcx_pos(abs(x));
+  //   erf(x) = 2/sqrt(pi) * x * (1 - x^2/3 + x^4/10 - x^6/42 + x^8/216 - ...)
+  const vdouble taylor =
+    x * (1.1283791670955125739
+         + mx2 * (0.37612638903183752463
+                  + mx2 * (0.11283791670955125739
+                           + mx2 * (0.026866170645131251759
+                                    + mx2 * (0.0052239776254421878421
+                                             + mx2 * (0.00085483270234508528325
+                                                      + mx2 * (0.00012055332981789664251
+                                                               + mx2 * (0.000014925650358406250977
+                                                                        + mx2 * 1.6462114365889247402e-6))))))));
+  const vdouble g = select(abs(x) < 0.25, taylor, copysign(f, x));
+  return select(x == x, g, x);
+}
+
+// erfc(x) = exp(-x^2) erfcx(x), and 2 - erfc(-x) for x < 0.  The rounding
+// error of x^2, recovered with an fma where there is one, is put back as
+// a factor (1 - lo); otherwise it costs x^2 eps in the result, ~5e-14 at x = 22.
+// exp(-x^2) is split as exp(-min(x^2, 700)) exp(-(x^2 - 700)) so that only
+// lanes whose result is itself subnormal, 700 < x^2 < 750, meet subnormals;
+// beyond that the second factor is 1 and the lane is replaced by 0 or 2
+inline vdouble erfc_real(vdouble x)
+{
+  const vdouble x2 = x*x, lo = fma(x, x, -x2);
+  const vdouble x2c = min(x2, set1(700.0));
+  const vmask uflow = x2 > 750.0;
+  const vdouble tail = exp(select(uflow, set1(0.0), x2c - x2));
+  const vdouble f = exp(-x2c) * (1.0 - lo) * erfcx_pos(abs(x)) * tail;
+  vdouble g = select(x < 0.0, 2.0 - f, f);
+  g = select(uflow, select(x < 0.0, set1(2.0), set1(0.0)), g);
+  return select(x == x, g, x);
+}
+
+// w_im(x) = 2 Dawson(x)/sqrt(pi), odd in x
+inline vdouble w_im_real(vdouble x)
+{
+  const double ispi = 0.56418958354775628694807945156; // 1 / sqrt(pi)
+  const vdouble xa = abs(x);
+  // lanes with |x| > 45 or NaN read row 0 and are replaced below
+  const vdouble y100 = select(xa <= 45.0, 100.0 / (xa + 1.0), set1(0.5));
+  int idx[width];
+  const vdouble t = cheb_row(y100, tables::W_IM_ROWS, tables::W_IM_STRIDE, idx);
+  vdouble f = cheb_sum<9>(&tables::w_im_cheb[0][0], idx, t);
+
+  // Taylor expansion for |x| <= 0.0309..., the rows y100 >= 97
+  //  (2/sqrt(pi)) * (x - 2/3 x^3  + 4/15 x^5  - 8/105 x^7 + 16/945 x^9)
+  const vdouble x2 = xa*xa;
+  const vdouble taylor =
+    xa * (1.1283791670955125739
+          - x2 * (0.75225277806367504925
+                  - x2 * (0.30090111122547001970
+                          - x2 * (0.085971746064420005629
+                                  - x2 * 0.016931216931216931217))));
+  f = select(y100 >= 97.0, taylor, f);
+
+  // continued fraction for |x| > 45, 1 term for |x| > 5e7 to avoid overflow
+  const vdouble cf = select(xa > 5e7, ispi / xa,
+                            ispi*(x2*(x2 - 4.5) + 2.0) / (xa*(x2*(x2 - 5.0) + 3.75)));
+  f = select(xa > 45.0, cf, f);
+  f = select(x < 0.0, -f, f);
+  return select(x == x, f, x);
+}
+
+// f[j] = kernel(x[j]), the tail through a padded copy; without a vector
+// unit the scalar routine is faster than both branches of the kernels
+template <class Kernel, class Scalar>
+void for_blocks_real(int n, const double *x, double *f, const Kernel &kernel,
+                     const Scalar &scalar)
+{
+  if (width == 1) {
+    for (int i = 0; i < n; ++i)
+      f[i] = scalar(x[i]);
+    return;
+  }
+
+  int i = 0;
+  for (; i + width <= n; i += width)
+    store(f + i, kernel(load(x + i)));
+
+  if (i < n) {
+    double bx[width], bf[width];
+    for (int k = 0; k < width; ++k)
+      bx[k] = i + k < n ? x[i + k] : 1.0;
+    store(bf, kernel(load(bx)));
+    for (int k = 0; i + k < n; ++k)
+      f[i + k] = bf[k];
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////
+// Region of each lane, see the comment at the top; lanes in neither mask
+// are left to the scalar routine.  Re w alone (IM = false) has no
+// sum5 - sum4 cancellation, so the sums also take x < 5e-4 and x = 0.
+
+template <bool IM>
+inline void classify(vdouble re, vdouble im, vmask &mcf, vmask &msum)
+{
+  const vdouble x = abs(re), ya = abs(im);
+
+  // finite, not too large and off both axes; NaN fails every comparison
+  const vmask ok = (x < 1e150) & (ya < 1e150) & !(im == set1(0.0))
+    & (IM ? !(re == set1(0.0)) : !none_set());
+
+  const vmask cf = (ya > 7.0)
+    | ((x > 6.0) & ((ya > 0.1) | ((x > 8.0) & (ya > 1e-10)) | (x > 28.0)));
+  // y < 0: leave overflowing or rapidly oscillating 2 exp(-z^2) to the scalar code
+  const vdouble e = (ya - x)*(x + ya);
+  const vmask badrefl = (im < 0.0) & ((e > 700.0) | ((2.0*x*ya >= 1e5) & (e > -745.0)));
+
+  mcf = ok & cf & !badrefl;
+  msum = ok & !cf & (x < 10.0) & (IM ? x >= 5e-4 : !none_set());
+}
+
+/////////////////////////////////////////////////////////////////////////
+// Continued fraction; see FADDEEVA(w) for the choice of the number of
+// terms nu.  Lanes with y < 0 use w(z) = 2 exp(-z^2) - w(-z).
+
+inline vdouble cf_terms(vdouble x, vdouble ya)
+{
+  const double c0=3.9, c1=11.398, c2=0.08254, c3=0.1421, c4=0.2023; // fit
+  const vdouble s = x + ya;
+  const vdouble nu = floor(set1(c0) + c1 / (c2*x + c3*ya + c4));
+  return select(s > 4000.0, select(s > 1e7, set1(1.0), set1(2.0)), nu);
+}
+
+// w(z) = i/sqrt(pi) / f from the continued fraction f, followed by the
+// reflection for the lanes in refl
+inline void cf_finish(vdouble fr, vdouble fi, vdouble xs, vdouble ya, vdouble im,
+                      vmask refl, vdouble &wr, vdouble &wi)
+{
+  const double ispi = 0.56418958354775628694807945156; // 1 / sqrt(pi)
+  const vdouble denom = ispi / (fr*fr + fi*fi);
+  wr = denom*fi;
+  wi = denom*fr;
+
+  if (any(refl)) {
+    // exp(-z*z) = exp(-(xs*xs-ya*ya) -2*i*xs*ya), classify() has checked
+    // that the modulus does not overflow and that the phase is < 1e5
+    vdouble sn, cs;
+    const vdouble mod = 2.0 * exp((ya - xs)*(xs + ya));
+    sincos(select(refl, 2.0*xs*im, set1(0.0)), sn, cs);
+    wr = select(refl, mod*cs - wr, wr);
+    wi = select(refl, mod*sn - wi, wi);
+  }
+}
+
+// Lanes in m, each with its own nu
+inline void w_cf(vdouble re, vdouble im, vmask m, vdouble &wr, vdouble &wi)
+{
+  const vdouble x = abs(re), ya = abs(im);
+  const vmask yneg = im < 0.0;
+  const vdouble xs = select(yneg, -re, re); // compute for -z if y < 0
+
+  // w <- z - nu/w, for nu = (nu-1)/2, (nu-2)/2, ..., 1/2
+  vdouble fr = xs, fi = ya;
+  vdouble nuk = 0.5*(cf_terms(x, ya) - 1.0);
+  vmask act = m & (nuk > 0.4);
+  while (any(act)) {
+    const vdouble denom = nuk / (fr*fr + fi*fi);
+    fr = select(act, xs - fr*denom, fr);
+    fi = select(act, ya + fi*denom, fi);
+    nuk = nuk - 0.5;
+    act = act & (nuk > 0.4);
+  }
+  cf_finish(fr, fi, xs, ya, im, m & yneg, wr, wi);
+}
+
+// Every lane with the same nu and the same sign of y, no masking
+inline void w_cf_fixed(vdouble re, vdouble im, int nu, bool yneg, vdouble &wr, vdouble &wi)
+{
+  const vdouble ya = abs(im);
+  const vdouble xs = yneg ? -re : re;
+
+  vdouble fr = xs, fi = ya;
+  for (double nuk = 0.5*(nu - 1); nuk > 0.4; nuk -= 0.5) {
+    const vdouble denom = nuk / (fr*fr + fi*fi);
+    fr = xs - fr*denom;
+    fi = ya + fi*denom;
+  }
+  cf_finish(fr, fi, xs, ya, im, yneg ? !none_set() : none_set(), wr, wi);
+}
+
+/////////////////////////////////////////////////////////////////////////
+// Algorithm 916 sums, 5e-4 <= x < 10.  This is the x > 5e-4 branch of
+// FADDEEVA(w) with the precomputed exp(-a2*n*n) table.
+
+struct sums {
+  vdouble expx2, sum1, sum2, sum3, sum4, sum5;
+};
+
+// Number of terms after which the scalar code stops, bounded above from x
+// alone as floor((x + kterm)/a) + 1.  The scalar term count, maximised
+// over |y| <= 7, was checked against this bound for x < 10 and relerr
+// from DBL_EPSILON to 0.1; it overestimates by one or two terms
+inline vdouble sum_terms(vdouble x, const FaddeevaContext &p)
+{
+  return min(floor((x + p.kterm()) * (1.0 / p.a())) + 1.0, set1(NEXPA2N2 - 1));
+}
+
+// Assemble w from the sums; Re w alone (IM = false)
+// needs neither sin(2xy), as cos(2xy) = 1 - 2 sin^2(xy), nor sum4, sum5
+template <bool IM>
+inline void sums_finish(vdouble re, vdouble im, const sums &s, const FaddeevaContext &p,
+                        vdouble &wr, vdouble &wi)
+{
+  const double c = p.c();
+  const vdouble zero = set1(0.0), one = set1(1.0);
+  const vdouble x = abs(re), y = im;
+
+  const vdouble expx2erfcxy = // avoid spurious overflow for large negative y
+    select(y > -6.0, s.expx2 * erfcx_real(y), 2.0 * exp(y*y - x*x));
+
+  vdouble sinxy, cosxy, sin2xy, cos2xy;
+  const vdouble xy = re*y;
+  sincos(xy, sinxy, cosxy);
+  if (IM)
+    sincos(xy + xy, sin2xy, cos2xy);
+  else
+    cos2xy = one - 2.0*(sinxy*sinxy);
+  // sinc(t) = sin(t)/t, with the Taylor series for small t
+  const vdouble sincxy = select(abs(xy) < 1e-4, one - 0.1666666666666666666667*(xy*xy), sinxy / xy);
+  const vdouble coef1 = expx2erfcxy - c*y*s.sum1;
+  const vdouble coef2 = c*re*s.expx2;
+  const vdouble rr = coef1 * cos2xy + coef2 * sinxy * sincxy;
+
+  wr = rr + (0.5*c)*y*(s.sum2 + s.sum3);
+
+  if (IM) {
+    const vdouble sinc2xy = select(abs(xy) < 0.5e-4, one - 0.6666666666666666666667*(xy*xy), sin2xy / (xy + xy));
+    vdouble ri = coef2 * sinc2xy - coef1 * sin2xy;
+    ri = select(y > 5.0, zero, ri); // imaginary terms cancel
+    wi = ri + (0.5*c)*copysign(s.sum5 - s.sum4, re);
+  }
+}
+
+// Lanes in m, each lane leaves the sums at the term where the scalar
+// code would break out and the loop ends when no lane is left; for Re w
+// alone the test is on sum3, as in the scalar w_re
+template <bool IM>
+inline void w_sums(vdouble re, vdouble im, vmask m, const FaddeevaContext &p,
+                   vdouble &wr, vdouble &wi)
+{
+  const double a = p.a(), a2 = p.a2();
+  const vdouble zero = set1(0.0), one = set1(1.0);
+
+  const vdouble x = abs(re), y2 = im*im;
+  const vdouble exp2ax = exp((2*a)*x), expm2ax = one / exp2ax;
+  const vdouble relerr = set1(p.relerr());
+  vdouble prod2ax = one, prodm2ax = one;
+  sums s;
+  s.expx2 = exp(-(x*x));
+  s.sum1 = s.sum2 = s.sum3 = s.sum4 = s.sum5 = zero;
+
+  vmask act = m;
+  for (int n = 1; n < NEXPA2N2 && any(act); ++n) {
+    const vdouble coef = p.expa2n2()[n-1] * s.expx2 / (set1(a2*(n*n)) + y2);
+    prod2ax = prod2ax * exp2ax;
+    prodm2ax = prodm2ax * expm2ax;
+    const vdouble t2 = coef * prodm2ax, t3 = coef * prod2ax;
+    const vdouble t5 = t3 * (a*n);
+    s.sum1 = select(act, s.sum1 + coef, s.sum1);
+    s.sum2 = select(act, s.sum2 + t2, s.sum2);
+    s.sum3 = select(act, s.sum3 + t3, s.sum3);
+    if (IM) {
+      s.sum4 = select(act, s.sum4 + t2 * (a*n), s.sum4);
+      s.sum5 = select(act, s.sum5 + t5, s.sum5);
+      // test convergence via sum5, since this sum has the slowest decay
+      act = act & !(t5 < relerr * s.sum5);
+    }
+    else
+      act = act & !(t3 < relerr * s.sum3);
+  }
+  sums_finish<IM>(re, im, s, p, wr, wi);
+}
+
+// Every lane summed to the same nterm terms, at least as many as any of
+// them needs, no masking and no convergence test
+template <bool IM>
+inline void w_sums_fixed(vdouble re, vdouble im, int nterm, const FaddeevaContext &p,
+                         vdouble &wr, vdouble &wi)
+{
+  const double a = p.a(), a2 = p.a2();
+  const vdouble zero = set1(0.0), one = set1(1.0);
+
+  const vdouble x = abs(re), y2 = im*im;
+  const vdouble exp2ax = exp((2*a)*x), expm2ax = one / exp2ax;
+  vdouble prod2ax = one, prodm2ax = one;
+  sums s;
+  s.expx2 = exp(-(x*x));
+  s.sum1 = s.sum2 = s.sum3 = s.sum4 = s.sum5 = zero;
+
+  for (int n = 1; n <= nterm; ++n) {
+    const vdouble coef = p.expa2n2()[n-1] * s.expx2 / (set1(a2*(n*n)) + y2);
+    prod2ax = prod2ax * exp2ax;
+    prodm2ax = prodm2ax * expm2ax;
+    const vdouble t2 = coef * prodm2ax, t3 = coef * prod2ax;
+    s.sum1 = s.sum1 + coef;
+    s.sum2 = s.sum2 + t2;
+    s.sum3 = s.sum3 + t3;
+    if (IM) {
+      s.sum4 = s.sum4 + t2 * (a*n);
+      s.sum5 = s.sum5 + t3 * (a*n);
+    }
+  }
+  sums_finish<IM>(re, im, s, p, wr, wi);
+}
+
+/////////////////////////////////////////////////////////////////////////
+// Masked evaluation of one block of simd::width points, used for short
+// arrays and for the chunks of w_sorted that gain nothing from sorting.
+// With IM = false only Re w is computed and wim is not written.
+
+// The scalar routine, for the points the kernels leave out
+template <bool IM>
+inline void w_scalar(double re, double im, double *wre, double *wim, const FaddeevaContext &p)
+{
+  if (IM) {
+    const std::complex<double> w = Faddeeva::w(std::complex<double>(re, im), p);
+    *wre = std::real(w);
+    *wim = std::imag(w);
+  }
+  else
+    *wre = Faddeeva::w_re(re, im, p);
+}
+
+template <bool IM>
+inline void w_block(const double *re, const double *im, double *wre, double *wim,
+                    const FaddeevaContext &p)
+{
+  const vdouble vre = load(re), vim = load(im);
+  vmask mcf, msum;
+  classify<IM>(vre, vim, mcf, msum);
+
+  vdouble wr = set1(0.0), wi = set1(0.0), tr, ti;
+  if (any(mcf)) {
+    w_cf(vre, vim, mcf, tr, ti);
+    wr = select(mcf, tr, wr);
+    wi = select(mcf, ti, wi);
+  }
+  if (any(msum)) {
+    w_sums<IM>(vre, vim, msum, p, tr, ti);
+    wr = select(msum, tr, wr);
+    wi = select(msum, ti, wi);
+  }
+  store(wre, wr);
+  if (IM)
+    store(wim, wi);
+
+  const int sb = bits(!(mcf | msum));
+  if (sb) {
+    for (int k = 0; k < width; ++k) {
+      if ((sb >> k) & 1)
+        w_scalar<IM>(re[k], im[k], &wre[k], IM ? &wim[k] : wim, p);
+    }
+  }
+}
+
+// Apply block(re, im, wre, wim) to consecutive blocks of simd::width
+// points, padding the last partial block with z = 1 + i; wim may be
+// null for a block that does not write it
+template <class Block>
+void for_blocks(int n, const double *re, const double *im, double *wre, double *wim,
+                const Block &block)
+{
+  int i = 0;
+  for (; i + width <= n; i += width)
+    block(re + i, im + i, wre + i, wim ? wim + i : wim);
+
+  if (i < n) {
+    double bre[width], bim[width], bwr[width], bwi[width];
+    for (int k = 0; k < width; ++k) {
+      bre[k] = i + k < n ? re[i + k] : 1.0;
+      bim[k] = i + k < n ? im[i + k] : 1.0;
+    }
+    block(bre, bim, bwr, bwi);
+    for (int k = 0; i + k < n; ++k) {
+      wre[i + k] = bwr[k];
+      if (wim)
+        wim[i + k] = bwi[k];
+    }
+  }
+}
+
+template <bool IM>
+void w_masked(int n, const double *re, const double *im, double *wre, double *wim,
+              const FaddeevaContext &p)
+{
+  for_blocks(n, re, im, wre, wim,
+             [&p](const double *bre, const double *bim, double *bwr, double *bwi) {
+               w_block<IM>(bre, bim, bwr, bwi, p);
+             });
+}
+
+/////////////////////////////////////////////////////////////////////////
+// Region-sorted evaluation.  With mixed input a block of the masked code
+// often contains lanes from both regions, or lanes with very different
+// term counts, so that most of the vector sits idle.  Here the points of
+// a chunk are given a key
+//
+//      0                             scalar routine
+//      KEY_CF + 2*(nu-1) + (y < 0)   continued fraction with nu terms
+//      KEY_SUM + nterm - 1           Algorithm 916 with nterm terms
+//
+// counting-sorted by key into homogeneous sub-batches, each padded to a
+// whole number of vectors, and every sub-batch is run through a kernel
+// with a fixed trip count and no lane masks.  The results are scattered
+// back to their original positions.
+
+const int NUMAX = 64; // the largest nu of the continued fraction is 60
+const int KEY_CF = 1, KEY_SUM = KEY_CF + 2*NUMAX, NKEY = KEY_SUM + NEXPA2N2;
+const int CHUNK = 4096; // points sorted at a time, keeps the buffers in cache
+const int SORT_MIN = 128; // shorter arrays go through w_masked
+
+template <bool IM>
+void w_sorted(int n, const double *re, const double *im, double *wre, double *wim,
+              const FaddeevaContext &p)
+{
+  const int nbuf = std::min(n, CHUNK) + NKEY*width; // room for the padding
+  std::vector<int> key(std::min(n, CHUNK) + width), perm(nbuf);
+  std::vector<double> sre(nbuf), sim(nbuf), swr(nbuf), swi(nbuf);
+  int count[NKEY], start[NKEY], fill[NKEY];
+
+  for (int i0 = 0; i0 < n; i0 += CHUNK) {
+    const int m = std::min(CHUNK, n - i0);
+    const double *cre = re + i0, *cim = im + i0;
+
+    // keys, a vector at a time; key has room for a whole last vector
+    for (int j = 0; j < m; j += width) {
+      vdouble vre, vim;
+      if (j + width <= m) {
+        vre = load(cre + j);
+        vim = load(cim + j);
+      }
+      else {
+        double bre[width], bim[width];
+        for (int k = 0; k < width; ++k) {
+          bre[k] = j + k < m ? cre[j + k] : 1.0;
+          bim[k] = j + k < m ? cim[j + k] : 1.0;
+        }
+        vre = load(bre);
+        vim = load(bim);
+      }
+      const vdouble x = abs(vre), ya = abs(vim);
+      vmask mcf, msum;
+      classify<IM>(vre, vim, mcf, msum);
+      const vdouble kcf = set1(KEY_CF - 2) + 2.0*min(cf_terms(x, ya), set1(NUMAX))
+        + select(vim < 0.0, set1(1.0), set1(0.0));
+      const vdouble ksum = set1(KEY_SUM - 1) + sum_terms(x, p);
+      store_int(&key[j], select(mcf, kcf, select(msum, ksum, set1(0.0))));
+    }
+
+    // Blocks that hold both continued fraction and Algorithm 916 lanes
+    // are what the masked code handles badly.  Inputs that are already
+    // ordered, e.g. a frequency sweep, give few of them, and then the
+    // masked code is faster than sorting.  (A spread of nu or of the term
+    // counts within one region costs the masked code less than the sort.)
+    int nmixed = 0;
+    for (int j = 0; j < m; j += width) {
+      bool hascf = false, hassum = false;
+      for (int k = 0; k < width && j + k < m; ++k) {
+        hascf = hascf || (key[j + k] >= KEY_CF && key[j + k] < KEY_SUM);
+        hassum = hassum || key[j + k] >= KEY_SUM;
+      }
+      if (hascf && hassum) ++nmixed;
+    }
+    if (8*nmixed*width <= m) {
+      w_masked<IM>(m, cre, cim, wre + i0, IM ? wim + i0 : wim, p);
+      continue;
+    }
+
+    // counting sort, every sub-batch starting on a multiple of width
+    for (int k = 0; k < NKEY; ++k) count[k] = 0;
+    for (int j = 0; j < m; ++j) ++count[key[j]];
+    int pos = 0;
+    for (int k = 1; k < NKEY; ++k) {
+      start[k] = fill[k] = pos;
+      pos += (count[k] + width - 1) / width * width;
+    }
+    for (int j = 0; j < m; ++j) {
+      const int k = key[j];
+      if (k == 0) { // scalar routine, in place
+        w_scalar<IM>(cre[j], cim[j], &wre[i0 + j], IM ? &wim[i0 + j] : wim, p);
+        continue;
+      }
+      const int q = fill[k]++;
+      perm[q] = j;
+      sre[q] = cre[j];
+      sim[q] = cim[j];
+    }
+
+    // pad each sub-batch with copies of its first point and run the kernels
+    for (int k = 1; k < NKEY; ++k) {
+      if (count[k] == 0) continue;
+      const int end = start[k] + (count[k] + width - 1) / width * width;
+      for (int q = fill[k]; q < end; ++q) {
+        perm[q] = -1;
+        sre[q] = sre[start[k]];
+        sim[q] = sim[start[k]];
+      }
+      for (int q = start[k]; q < end; q += width) {
+        vdouble wr, wi;
+        if (k < KEY_SUM)
+          w_cf_fixed(load(&sre[q]), load(&sim[q]), (k - KEY_CF) / 2 + 1, ((k - KEY_CF) & 1) != 0, wr, wi);
+        else
+          w_sums_fixed<IM>(load(&sre[q]), load(&sim[q]), k - KEY_SUM + 1, p, wr, wi);
+        store(&swr[q], wr);
+        if (IM)
+          store(&swi[q], wi);
+      }
+    }
+
+    // scatter
+    for (int q = 0; q < pos; ++q) {
+      if (perm[q] >= 0) {
+        wre[i0 + perm[q]] = swr[q];
+        if (IM)
+          wim[i0 + perm[q]] = swi[q];
+      }
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////
+// Weideman's rational approximation,
+//
+//    J. A. C. Weideman, "Computation of the complex error function,"
+//    SIAM J. Numer. Anal. 31(5), pp. 1497-1518 (1994),
+//
+//    w(z) = 2 p(Z) / (L - iz)^2 + 1 / (sqrt(pi) (L - iz)),
+//    Z = (L + iz) / (L - iz),  L = sqrt(N / sqrt(2)),
+//
+// with p a polynomial of degree N-1 whose coefficients are the Fourier
+// coefficients of exp(-t^2) (L^2 + t^2) under t = L tan(theta/2).  The
+// cost is the same at every z in the upper half plane: one division and
+// N complex multiply-adds.  y < 0 goes through w(z) = 2 exp(-z^2) - w(-z).
+//
+// Against the ADAPTIVE code, on one core with AVX-512, in ns per point
+// (1e6 points; random z in |x| < 12, |y| < 10; a sweep of x at y = 0.5;
+// random z in the Algorithm 916 region):
+//
+//                        random   sweep   Alg. 916   max |dw|/|w|   max |dRe w|/Re w, y >= 1e-3
+//    ADAPTIVE    array    55.7    22.8     66.5      relerr         relerr
+//                scalar  202.3   140.2    176.3
+//    WEIDEMAN16  array    13.1     6.5      5.8      4.3e-7         1.7e-3
+//                scalar   81.0    38.0     36.5
+//    WEIDEMAN32  array    23.6    14.1     13.3      3.2e-13        2.6e-9
+//                scalar  132.6    84.5     83.8
+//
+// The error is uniform in size relative to |w|, so the real part (the
+// Voigt profile) loses relative accuracy in the far wings, where
+// Re w ~ y / (sqrt(pi) x^2) << |w| ~ 1 / (sqrt(pi) |x|).
+
+struct weideman_coefs {
+  int N;
+  double L;
+  double a[32]; // p(Z) = a[0] + a[1] Z + ... + a[N-1] Z^(N-1)
+};
+
+// the coefficients from the trapezoidal rule on 2N intervals, which is
+// Weideman's FFT written out as a cosine sum
+weideman_coefs make_weideman_coefs(int N)
+{
+  const double pi = 3.14159265358979323846264338327950288419716939937510582;
+  weideman_coefs w;
+  const int M = 2*N;
+  w.N = N;
+  w.L = std::sqrt(N / std::sqrt(2.0));
+  for (int j = 1; j <= N; ++j) {
+    double sum = 0;
+    for (int k = -M + 1; k < M; ++k) {
+      const double t = w.L * std::tan(0.5 * k * pi / M);
+      sum += std::exp(-t*t) * (w.L*w.L + t*t) * std::cos(pi * j * k / M);
+    }
+    w.a[j-1] = sum / (2*M);
+  }
+  return w;
+}
+
+const weideman_coefs &weideman(Faddeeva::Method method)
+{
+  static const weideman_coefs w16 = make_weideman_coefs(16), w32 = make_weideman_coefs(32);
+  return method == Faddeeva::WEIDEMAN16 ? w16 : w32;
+}
+
+inline void w_weideman(vdouble re, vdouble im, const weideman_coefs &c,
+                       vdouble &wr, vdouble &wi)
+{
+  const double ispi = 0.56418958354775628694807945156; // 1 / sqrt(pi)
+  const double L = c.L;
+  const vmask yneg = im < 0.0;
+  const vdouble x = select(yneg, -re, re), y = abs(im); // compute for -z if y < 0
+
+  // q = 1/(L - iz) = ((L + y) + ix) / d, Z = (L + iz) q = ((L^2 - x^2 - y^2) + 2iLx) / d
+  const vdouble ly = y + L;
+  const vdouble rd = 1.0 / (ly*ly + x*x);
+  const vdouble qr = ly*rd, qi = x*rd;
+  const vdouble Zr = (set1(L*L) - x*x - y*y)*rd, Zi = (2*L)*x*rd;
+
+  vdouble pr = set1(c.a[c.N-1]), pi = set1(0.0);
+  for (int j = c.N - 2; j >= 0; --j) {
+    const vdouble t = pr*Zr - pi*Zi + c.a[j];
+    pi = pr*Zi + pi*Zr;
+    pr = t;
+  }
+
+  // w = 2 p q^2 + q / sqrt(pi)
+  const vdouble q2r = qr*qr - qi*qi, q2i = 2.0*qr*qi;
+  wr = 2.0*(pr*q2r - pi*q2i) + ispi*qr;
+  wi = 2.0*(pr*q2i + pi*q2r) + ispi*qi;
+
+  if (any(yneg)) {
+    // exp(-z*z) = exp(-(x*x-y*y) + 2*i*x*y) with x = -Re z, y = -Im z; the
+    // caller has checked that the modulus does not overflow and that the
+    // phase is < 1e5
+    vdouble sn, cs;
+    const vdouble mod = 2.0 * exp((y - x)*(x + y));
+    sincos(select(yneg, 2.0*x*im, set1(0.0)), sn, cs);
+    wr = select(yneg, mod*cs - wr, wr);
+    wi = select(yneg, mod*sn - wi, wi);
+  }
+}
+
+inline void w_weideman_block(const double *re, const double *im, double *wre, double *wim,
+                             const weideman_coefs &c)
+{
+  const vdouble vre = load(re), vim = load(im);
+  const vdouble x = abs(vre), ya = abs(vim);
+  const vdouble e = (ya - x)*(x + ya);
+  const vmask ok = (x < 1e150) & (ya < 1e150)
+    & !((vim < 0.0) & ((e > 700.0) | ((2.0*x*ya >= 1e5) & (e > -745.0))));
+
+  vdouble wr, wi;
+  w_weideman(vre, vim, c, wr, wi);
+  store(wre, wr);
+  store(wim, wi);
+
+  const int sb = bits(!ok);
+  if (sb) { // Inf, NaN, huge |z| or overflowing reflection
+    for (int k = 0; k < width; ++k) {
+      if ((sb >> k) & 1) {
+        std::complex<double> wk = Faddeeva::w(std::complex<double>(re[k], im[k]));
+        wre[k] = std::real(wk);
+        wim[k] = std::imag(wk);
+      }
+    }
+  }
+}
+
+} // anonymous namespace
+
+/////////////////////////////////////////////////////////////////////////
+
+void Faddeeva::w(int n, const double *re, const double *im,
+                 double *wre, double *wim, double relerr)
+{
+  if (relerr <= DBL_EPSILON)
+    w(n, re, im, wre, wim, default_context());
+  else
+    w(n, re, im, wre, wim, FaddeevaContext(relerr));
+}
+
+void Faddeeva::w(int n, const double *re, const double *im,
+                 double *wre, double *wim, const FaddeevaContext &ctx)
+{
+  if (width == 1) { // no vector unit, the scalar routine is as fast
+    for (int i = 0; i < n; ++i) {
+      std::complex<double> wi = Faddeeva::w(std::complex<double>(re[i], im[i]), ctx);
+      wre[i] = std::real(wi);
+      wim[i] = std::imag(wi);
+    }
+    return;
+  }
+
+  if (n < SORT_MIN)
+    w_masked<true>(n, re, im, wre, wim, ctx);
+  else
+    w_sorted<true>(n, re, im, wre, wim, ctx);
+}
+
+void Faddeeva::w_re(int n, const double *re, const double *im,
+                    double *wre, double relerr)
+{
+  if (relerr <= DBL_EPSILON)
+    w_re(n, re, im, wre, default_context());
+  else
+    w_re(n, re, im, wre, FaddeevaContext(relerr));
+}
+
+void Faddeeva::w_re(int n, const double *re, const double *im,
+                    double *wre, const FaddeevaContext &ctx)
+{
+  if (width == 1) {
+    for (int i = 0; i < n; ++i)
+      wre[i] = Faddeeva::w_re(re[i], im[i], ctx);
+    return;
+  }
+
+  if (n < SORT_MIN)
+    w_masked<false>(n, re, im, wre, 0, ctx);
+  else
+    w_sorted<false>(n, re, im, wre, 0, ctx);
+}
+
+std::complex<double> Faddeeva::w(std::complex<double> z, Method method)
+{
+  if (method == ADAPTIVE)
+    return w(z);
+
+  const double ispi = 0.56418958354775628694807945156; // 1 / sqrt(pi)
+  const weideman_coefs &c = weideman(method);
+  const double x = std::real(z), y = std::imag(z);
+  if (!(std::fabs(x) < 1e150 && std::fabs(y) < 1e150))
+    return w(z);
+
+  // as in w_weideman, in real arithmetic
+  const double xs = y < 0 ? -x : x, ya = std::fabs(y), L = c.L;
+  const double ly = ya + L, rd = 1 / (ly*ly + xs*xs);
+  const double qr = ly*rd, qi = xs*rd;
+  const double Zr = (L*L - xs*xs - ya*ya)*rd, Zi = 2*L*xs*rd;
+  double pr = c.a[c.N-1], pi = 0;
+  for (int j = c.N - 2; j >= 0; --j) {
+    const double t = pr*Zr - pi*Zi + c.a[j];
+    pi = pr*Zi + pi*Zr;
+    pr = t;
+  }
+  const double q2r = qr*qr - qi*qi, q2i = 2*qr*qi;
+  const std::complex<double> ret(2*(pr*q2r - pi*q2i) + ispi*qr, 2*(pr*q2i + pi*q2r) + ispi*qi);
+  if (y < 0) // w(z) = 2.0*exp(-z*z) - w(-z)
+    return 2.0*std::exp(std::complex<double>((ya-xs)*(xs+ya), 2*xs*y)) - ret;
+  return ret;
+}
+
+void Faddeeva::w(int n, const double *re, const double *im,
+                 double *wre, double *wim, Method method)
+{
+  if (method == ADAPTIVE) {
+    w(n, re, im, wre, wim);
+    return;
+  }
+  const weideman_coefs &c = weideman(method);
+  for_blocks(n, re, im, wre, wim,
+             [&c](const double *bre, const double *bim, double *bwr, double *bwi) {
+               w_weideman_block(bre, bim, bwr, bwi, c);
+             });
+}
+
+const char *Faddeeva::simd_isa() { return isa; }
+
+/////////////////////////////////////////////////////////////////////////
+
+void Faddeeva::erfcx(int n, const double *x, double *f)
+{
+  for_blocks_real(n, x, f, [](vdouble v) { return erfcx_real(v); },
+                  [](double v) { return Faddeeva::erfcx(v); });
+}
+
+void Faddeeva::erf(int n, const double *x, double *f)
+{
+  for_blocks_real(n, x, f, [](vdouble v) { return erf_real(v); },
+                  [](double v) { return Faddeeva::erf(v); });
+}
+
+void Faddeeva::erfc(int n, const double *x, double *f)
+{
+  for_blocks_real(n, x, f, [](vdouble v) { return erfc_real(v); },
+                  [](double v) { return Faddeeva::erfc(v); });
+}
+
+void Faddeeva::w_im(int n, const double *x, double *f)
+{
+  for_blocks_real(n, x, f, [](vdouble v) { return w_im_real(v); },
+                  [](double v) { return Faddeeva::w_im(v); });
+}
+
+void Faddeeva::Dawson(int n, const double *x, double *f)
+{
+  const double spi2 = 0.8862269254527580136490837416705725913990; // sqrt(pi)/2
+  for_blocks_real(n, x, f, [spi2](vdouble v) { return spi2 * w_im_real(v); },
+                  [](double v) { return Faddeeva::Dawson(v); });
+}
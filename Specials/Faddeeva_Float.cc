@@ -0,0 +1,620 @@
+//  -*- mode:c++; tab-width:2; indent-tabs-mode:nil;  -*-
+
+/* Single-precision versions of w(z), erfcx and Dawson, companion to
+   Faddeeva.cc and distributed under the same MIT license.
+
+   These are meant for callers that need a relative error of a few 1e-6
+   and want twice the throughput of the double-precision array routines:
+   the kernels work on simd::vfloat, with 2*simd::width lanes per vector
+   (see Faddeeva_Simd.hh), and are tuned for float accuracy rather than
+   derived from the double code by a change of type:
+
+      continued fraction   x >= 5 or |y| >= 3, with the number of terms
+                           fitted for 1e-7 instead of DBL_EPSILON (at most
+                           14 rather than 60), and exp(-z^2) added for
+                           |y| < 1 so that it also covers the real axis
+                           for 5 <= x < 10, where the double code needs
+                           Algorithm 916
+      Algorithm 916 sums   otherwise, with a and the exp(-a^2 n^2) table
+                           of a FaddeevaContext at relerr = 1e-7 (about
+                           14 terms rather than 40), written so that no
+                           intermediate overflows the float range; the
+                           sum giving Im w is accumulated without the
+                           cancellation of sum5 - sum4, so that no x < 5e-4
+                           Taylor branch is needed
+      scalar double code   Inf, NaN, |z| > 1e18, and y < 0 points whose
+                           reflection term 2 exp(-z^2) overflows or
+                           oscillates too fast for the float sincos
+
+   erfcx and w_im of real arguments use the Chebyshev tables of
+   Faddeeva.cc rounded to float and cut to the degree that float needs
+   (4 for erfcx, 5 for w_im, out of 6 and 8).
+
+   A block is two vectors, which go through the continued fraction
+   together to hide the latency of its division, and each region's kernel
+   runs with a fixed trip count, the largest any of its lanes needs,
+   rather than the per-lane convergence tests of Faddeeva_Batch.cc.
+   Long arrays whose blocks mix the two regions are first split by region
+   (w_split_f), a two-key version of w_sorted in Faddeeva_Batch.cc.
+
+   Against the double array routines, on one core with AVX-512 (16 floats
+   per vector), in ns per point (1e6 points):
+
+                                      double   float   max rel. error of the float version
+      w, random |x| < 12, 0 < y < 10    39.5    20.0   Re w 1.3e-6, Im w 4.4e-6 for y >= 0
+      w, sweep of x at y = 0.5          37.0    15.6
+      w, Algorithm 916 region           65.3    25.5
+      erfcx, -5 < x < 30                 8.0     4.2   4.7e-7
+      Dawson, -5 < x < 30                7.5     3.9   4.5e-7
+
+   For y < 0, w is the difference 2 exp(-z^2) - w(-z).  The exponent of
+   exp(-z^2) keeps its rounding error as well as the phase, and the error
+   is 1.4e-6 relative to the larger of the two terms, 2.5e-6 relative to
+   |w| where |w| is at least a tenth of that term (|x| < 12, |y| < 10).
+   Nearer the zeros of w it grows relative to |w|, to 2.8e-5 in the same
+   test.
+
+   The scalar overloads evaluate the double-precision code at the float
+   context's relerr and round the result: one point does not fill a
+   vector, and the double code is no slower per point than a float one. */
+
+#include "Faddeeva.hh"
+#include "Faddeeva_Simd.hh"
+#include "Faddeeva_Tables.hh"
+
+#include <cfloat>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+using namespace Faddeeva::simd;
+
+using Faddeeva::FaddeevaContext;
+
+namespace {
+
+namespace tables = Faddeeva::tables;
+
+const double RELERR_F = 1e-7; // accuracy of the float kernels' term counts
+
+const FaddeevaContext &float_context()
+{
+  static const FaddeevaContext ctx(RELERR_F);
+  return ctx;
+}
+
+const int ERFCX_NCOEF_F = 5, W_IM_NCOEF_F = 6; // coefficients kept per row
+const int STRIDE_F = 8;
+const int NTERM_F = 16; // Algorithm 916 terms for x < 5 at RELERR_F is 14
+
+// Constants of the float kernels.  a is rounded to float first and the
+// others are derived from that value, so that the terms of the sums agree
+// with each other to float accuracy.
+struct float_consts {
+  float a, a2, c, kterm, expma2, expm2a2;
+  float expa2n2[NTERM_F]; // exp(-a2 n^2), n = 1, 2, ..., flushed to 0 below FLT_MIN
+  float erfcx_cheb[tables::ERFCX_ROWS][STRIDE_F];
+  float w_im_cheb[tables::W_IM_ROWS][STRIDE_F];
+};
+
+float_consts make_float_consts()
+{
+  const FaddeevaContext &p = float_context();
+  float_consts k;
+  const double pi = 3.14159265358979323846264338327950288419716939937510582;
+  k.a = float(p.a());
+  const double a2 = double(k.a) * k.a;
+  k.a2 = float(a2);
+  k.c = float(2 * k.a / pi);
+  k.kterm = float(p.kterm());
+  k.expma2 = float(std::exp(-a2));
+  k.expm2a2 = float(std::exp(-2*a2));
+  for (int n = 1; n <= NTERM_F; ++n) {
+    const double e = std::exp(-a2*(n*n));
+    k.expa2n2[n-1] = e < FLT_MIN ? 0.0f : float(e);
+  }
+  for (int j = 0; j < tables::ERFCX_ROWS; ++j)
+    for (int i = 0; i < STRIDE_F; ++i)
+      k.erfcx_cheb[j][i] = i < ERFCX_NCOEF_F ? float(tables::erfcx_cheb[j][i]) : 0.0f;
+  for (int j = 0; j < tables::W_IM_ROWS; ++j)
+    for (int i = 0; i < STRIDE_F; ++i)
+      k.w_im_cheb[j][i] = i < W_IM_NCOEF_F ? float(tables::w_im_cheb[j][i]) : 0.0f;
+  return k;
+}
+
+const float_consts &consts()
+{
+  static const float_consts k = make_float_consts();
+  return k;
+}
+
+/////////////////////////////////////////////////////////////////////////
+// Float has 7 digits, so exp(t) loses x^2 * 6e-8 when t = -x^2 is rounded,
+// ~6e-6 at x = 10, and sin(t) loses as much when t = xy is.  Where
+// that matters the product is formed with its rounding error lo, exact
+// where there is an fma (and 0 without one), and lo is applied afterwards
+// as exp(t) (1 + lo) or as a rotation by lo.  Nothing here relies on
+// a - b being rounded separately from a product feeding it, which the
+// compiler may fuse.
+
+// a*b = hi + lo
+inline vfloat mul_lo(vfloat a, vfloat b, vfloat &lo)
+{
+  const vfloat hi = a*b;
+  lo = fma(a, b, -hi);
+  return hi;
+}
+
+// a + b = hi + lo, exact when the sum is rounded on its own
+inline vfloat add_lo(vfloat a, vfloat b, vfloat &lo)
+{
+  const vfloat hi = a + b, bb = hi - a;
+  lo = (a - (hi - bb)) + (b - bb);
+  return hi;
+}
+
+// sin(t + lo) and cos(t + lo) for |lo| <= ulp(t)
+inline void sincos_lo(vfloat t, vfloat lo, vfloat &s, vfloat &c)
+{
+  vfloat s0, c0;
+  sincos(t, s0, c0);
+  s = fma(c0, lo, s0);
+  c = fma(-s0, lo, c0);
+}
+
+/////////////////////////////////////////////////////////////////////////
+// Real arguments, as erfcx_pos, erfcx_real and w_im_real in
+// Faddeeva_Batch.cc
+
+inline vfloat cheb_row(vfloat y100, int rows, int *idx)
+{
+  const vfloat j = min(floor(y100), set1f(float(rows - 1)));
+  store_int(idx, j * float(STRIDE_F));
+  return 2.0f*y100 - (2.0f*j + 1.0f);
+}
+
+template <int NCOEF>
+inline vfloat cheb_sum(const float *c, const int *idx, vfloat t)
+{
+  vfloat p = gather(c + (NCOEF-1), idx);
+  for (int i = NCOEF-2; i >= 0; --i)
+    p = fma(p, t, gather(c + i, idx));
+  return p;
+}
+
+// erfcx(x) for x >= 0 or NaN
+inline vfloat erfcx_pos_f(vfloat x)
+{
+  const float ispi = 0.56418958354775628694807945156f; // 1 / sqrt(pi)
+  const vfloat y100 = select(x <= 50.0f, 400.0f / (x + 4.0f), set1f(0.5f));
+  int idx[fwidth];
+  const vfloat t = cheb_row(y100, tables::ERFCX_ROWS, idx);
+  vfloat f = cheb_sum<ERFCX_NCOEF_F>(&consts().erfcx_cheb[0][0], idx, t);
+  f = select(y100 >= 100.0f, set1f(1.0f), f);
+
+  // continued fraction for x > 50, 1 term for x > 1e7 to avoid overflow
+  const vfloat x2 = x*x;
+  const vfloat cf = select(x > 1e7f, ispi / x,
+                           ispi*(x2*(x2 + 4.5f) + 2.0f) / (x*(x2*(x2 + 5.0f) + 3.75f)));
+  f = select(x > 50.0f, cf, f);
+  return select(x == x, f, x);
+}
+
+// erfcx(x) for real x
+inline vfloat erfcx_real_f(vfloat x)
+{
+  const vfloat f = erfcx_pos_f(abs(x));
+  vfloat lo;
+  const vfloat x2 = mul_lo(x, x, lo);
+  const vfloat e2 = 2.0f*exp(x2)*(1.0f + lo);
+  vfloat g = select(x < -4.0f, e2, e2 - f);
+  g = select(x < -9.4f, set1f(HUGE_VALF), g);
+  return select(x < set1f(0.0f), g, f);
+}
+
+// w_im(x) = 2 Dawson(x)/sqrt(pi), odd in x
+inline vfloat w_im_real_f(vfloat x)
+{
+  const float ispi = 0.56418958354775628694807945156f; // 1 / sqrt(pi)
+  const vfloat xa = abs(x);
+  const vfloat y100 = select(xa <= 45.0f, 100.0f / (xa + 1.0f), set1f(0.5f));
+  int idx[fwidth];
+  const vfloat t = cheb_row(y100, tables::W_IM_ROWS, idx);
+  vfloat f = cheb_sum<W_IM_NCOEF_F>(&consts().w_im_cheb[0][0], idx, t);
+
+  // Taylor expansion for |x| < 0.3, the rows y100 > 77, where t loses
+  // relative accuracy in x to the rounding of y100 (2e-6 at x = 0.03)
+  //  (2/sqrt(pi)) * (x - 2/3 x^3  + 4/15 x^5  - 8/105 x^7 + 16/945 x^9)
+  const vfloat x2 = xa*xa;
+  const vfloat taylor =
+    xa * (1.1283791670955125739f
+          - x2 * (0.75225277806367504925f
+                  - x2 * (0.30090111122547001970f
+                          - x2 * (0.085971746064420005629f
+                                  - x2 * 0.016931216931216931217f))));
+  f = select(xa < 0.3f, taylor, f);
+
+  // continued fraction for |x| > 45, 1 term for |x| > 1e7 to avoid overflow
+  const vfloat cf = select(xa > 1e7f, ispi / xa,
+                           ispi*(x2*(x2 - 4.5f) + 2.0f) / (xa*(x2*(x2 - 5.0f) + 3.75f)));
+  f = select(xa > 45.0f, cf, f);
+  f = select(x < set1f(0.0f), -f, f);
+  return select(x == x, f, x);
+}
+
+template <class Kernel, class Scalar>
+void for_blocks_real_f(int n, const float *x, float *f, const Kernel &kernel,
+                       const Scalar &scalar)
+{
+  if (fwidth == 1) {
+    for (int i = 0; i < n; ++i)
+      f[i] = scalar(x[i]);
+    return;
+  }
+
+  int i = 0;
+  for (; i + fwidth <= n; i += fwidth)
+    store(f + i, kernel(load(x + i)));
+
+  if (i < n) {
+    float bx[fwidth], bf[fwidth];
+    for (int k = 0; k < fwidth; ++k)
+      bx[k] = i + k < n ? x[i + k] : 1.0f;
+    store(bf, kernel(load(bx)));
+    for (int k = 0; i + k < n; ++k)
+      f[i + k] = bf[k];
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////
+// Regions, see the comment at the top; lanes in neither mask are left to
+// the scalar routine
+
+inline void classify_f(vfloat re, vfloat im, vfmask &mcf, vfmask &msum)
+{
+  const vfloat x = abs(re), ya = abs(im);
+  const vfmask ok = (x < 1e18f) & (ya < 1e18f); // NaN fails both
+  const vfmask cf = (x >= 5.0f) | (ya >= 3.0f);
+  const vfloat e = (ya - x)*(x + ya);
+  const vfmask badrefl = (im < set1f(0.0f)) & ((e > 80.0f) | ((2.0f*x*ya >= 8192.0f) & (e > -103.0f)));
+  mcf = ok & cf & !badrefl;
+  msum = ok & !cf;
+}
+
+// Largest v over the lanes in m, 0 if there are none, for v >= 0; the
+// reduction is branch-free, as the lanes are in no particular order
+inline int lane_max(vfloat v, vfmask m)
+{
+  float fv[fwidth];
+  store(fv, select(m, v, set1f(0.0f)));
+  float r = 0;
+  for (int k = 0; k < fwidth; ++k)
+    r = std::max(r, fv[k]);
+  return int(r);
+}
+
+/////////////////////////////////////////////////////////////////////////
+// Continued fraction.  The number of terms nu is the fit
+//      nu = floor(2.6 + 17 / (0.5 x + 0.48 |y|)),
+// checked against the nu that reaches 1e-7 in both Re w and Im w (with
+// the exp(-z^2) term below) over x in [0, 60], |y| in [1e-8, 60] of the
+// region; it overestimates by 0.4 terms on average.
+
+inline vfloat cf_terms_f(vfloat x, vfloat ya)
+{
+  return floor(2.6f + 17.0f / (0.5f*x + 0.48f*ya));
+}
+
+// w for NV vectors of points of the region, nu terms; the vectors go
+// through the recurrence together, which is otherwise bound by the
+// latency of its division.  With E = exp(-z^2) for the upper half-plane
+// point xs + i|y|, w = i/sqrt(pi) / f + E for |y| < 1 (E vanishes in
+// float for x >= 10), and for y < 0 the reflection
+// w(z) = 2 exp(-z^2) - w(-z) = 2E - w(-z), exp(-z^2) being the same E.
+template <int NV>
+inline void w_cf_f(const vfloat *re, const vfloat *im, int nu, vfloat *wr, vfloat *wi)
+{
+  const float ispi = 0.56418958354775628694807945156f; // 1 / sqrt(pi)
+  const vfloat zero = set1f(0.0f);
+  vfloat xs[NV], ya[NV], fr[NV], fi[NV];
+  for (int v = 0; v < NV; ++v) {
+    ya[v] = abs(im[v]);
+    xs[v] = select(im[v] < zero, -re[v], re[v]);
+    fr[v] = xs[v];
+    fi[v] = ya[v];
+  }
+  for (float nuk = 0.5f*(nu - 1); nuk > 0.4f; nuk -= 0.5f) {
+    for (int v = 0; v < NV; ++v) {
+      const vfloat denom = nuk / (fr[v]*fr[v] + fi[v]*fi[v]);
+      fr[v] = xs[v] - fr[v]*denom;
+      fi[v] = ya[v] + fi[v]*denom;
+    }
+  }
+
+  for (int v = 0; v < NV; ++v) {
+    const vfloat denom = ispi / (fr[v]*fr[v] + fi[v]*fi[v]);
+    wr[v] = denom*fi[v];
+    wi[v] = denom*fr[v];
+
+    const vfmask yneg = im[v] < zero, near = ya[v] < 1.0f;
+    if (!any(near | yneg))
+      continue;
+    // E = exp(y^2 - x^2) (cos(2xy) - i sin(2xy)); near the axis, where E
+    // is most of Re w, the squares keep their rounding errors, elsewhere
+    // the exponent (y - x)(x + y) does, and so does the phase everywhere
+    vfloat lx, ly, lp, ld, ls, le;
+    const vfloat x2 = mul_lo(xs[v], xs[v], lx), y2 = mul_lo(ya[v], ya[v], ly);
+    const vfloat p = mul_lo(xs[v], ya[v], lp);
+    const vfloat d = add_lo(ya[v], -xs[v], ld), s = add_lo(xs[v], ya[v], ls);
+    const vfloat e = mul_lo(d, s, le);
+    le = le + (d*ls + s*ld);
+    vfloat sn, cs;
+    sincos_lo(2.0f*p, 2.0f*lp, sn, cs);
+    // E below FLT_MIN is taken as 0, subnormals being slow
+    const vfloat emin = set1f(-87.0f);
+    vfloat mod = select(near, (exp(max(-x2, emin))*(1.0f - lx)) * (exp(y2)*(1.0f + ly)), exp(max(e, emin))*(1.0f + le));
+    mod = select(select(near, -x2, e) < emin, zero, mod);
+    const vfloat er = mod*cs, ei = -(mod*sn);
+    const vfloat kr = select(near, set1f(1.0f), zero);
+    const vfloat kneg = select(near, set1f(1.0f), set1f(2.0f));
+    wr[v] = select(yneg, kneg*er - wr[v], wr[v] + kr*er);
+    wi[v] = select(yneg, kneg*ei - wi[v], wi[v] + kr*ei);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////
+// Algorithm 916 sums, x < 5, |y| < 3, in the form of FADDEEVA(w) in
+// Faddeeva.cc but with the factors that overflow in float regrouped:
+//
+//    term3_n = exp(-a2 n^2 - x^2 + 2anx) / (a2 n^2 + y^2) = g_n / den_n
+//    term2_n = term3_n V_n,  V_n = exp(-4anx)
+//
+// with g_n = exp(-(an - x)^2) <= 1 built up by g_n = g_{n-1} h_{n-1},
+// h_n = exp(2ax - a2 (2n+1)), rather than from powers of exp(2ax), which
+// overflow for x near 5.  sum5 - sum4 = sum of a n term3_n (1 - V_n) is
+// summed directly, with 1 - V_n = D_n = D_{n-1} + V_{n-1} D_1 built from
+// D_1 = -expm1(-4ax), so that small x loses nothing to cancellation.
+
+inline void w_sums_f(vfloat re, vfloat im, int nterm, vfloat &wr, vfloat &wi)
+{
+  const float_consts &k = consts();
+  const float a = k.a, a2 = k.a2, c = k.c;
+  const vfloat zero = set1f(0.0f), one = set1f(1.0f);
+
+  const vfloat x = abs(re), y = im, y2 = y*y;
+  vfloat lo;
+  const vfloat x2 = mul_lo(x, x, lo);
+  const vfloat expx2 = exp(-x2)*(1.0f - lo);
+  const vfloat u = (4.0f*a)*x, V1 = exp(-u);
+  //   -expm1(-u) = u (1 - u/2 (1 - u/3 (1 - ...))), to u^9 for u < 0.5
+  vfloat d1 = 1.0f - u*(1.0f/9.0f);
+  for (int i = 8; i >= 2; --i)
+    d1 = 1.0f - (u*(1.0f/i))*d1;
+  const vfloat D1 = select(u < 0.5f, u*d1, one - V1);
+
+  // the error of h is raised to the power n in g_n
+  const vfloat ax2 = mul_lo(set1f(2.0f*a), x, lo);
+  vfloat g = expx2, h = exp(ax2)*(k.expma2*(1.0f + lo));
+  vfloat V = one, D = zero;
+  vfloat sum1 = zero, sum23 = zero, sum45 = zero;
+  for (int n = 1; n <= nterm; ++n) {
+    g = g*h;
+    g = select(g < 1e-30f, zero, g); // past the peak of g_n, and no subnormals
+    h = h*k.expm2a2;
+    const vfloat rden = one / (set1f(a2*float(n*n)) + y2);
+    const vfloat t3 = g*rden;
+    D = fma(V, D1, D);
+    V = V*V1;
+    V = select(V < 1e-30f, zero, V);
+    sum1 = fma(set1f(k.expa2n2[n-1]), rden, sum1);
+    sum23 = sum23 + fma(t3, V, t3);
+    sum45 = fma(t3*(a*float(n)), D, sum45);
+  }
+  sum1 = sum1*expx2;
+
+  const vfloat expx2erfcxy = expx2 * erfcx_real_f(y);
+  vfloat sinxy, cosxy, sin2xy, cos2xy;
+  const vfloat xy = mul_lo(re, y, lo);
+  sincos_lo(xy, lo, sinxy, cosxy);
+  sincos_lo(xy + xy, lo + lo, sin2xy, cos2xy);
+  const vfloat sincxy = select(abs(xy) < 1e-3f, one - (1.0f/6.0f)*(xy*xy), sinxy / xy);
+  const vfloat sinc2xy = select(abs(xy) < 0.5e-3f, one - (2.0f/3.0f)*(xy*xy), sin2xy / (xy + xy));
+  const vfloat coef1 = expx2erfcxy - c*y*sum1;
+  const vfloat coef2 = c*re*expx2;
+  const vfloat rr = coef1 * cos2xy + coef2 * sinxy * sincxy;
+  const vfloat ri = coef2 * sinc2xy - coef1 * sin2xy;
+
+  wr = rr + (0.5f*c)*y*sum23;
+  wi = ri + (0.5f*c)*copysign(sum45, re);
+}
+
+/////////////////////////////////////////////////////////////////////////
+
+const int NV = 2; // vectors per block, see w_cf_f
+const int BLOCK_F = NV*fwidth;
+
+// BLOCK_F points, each region's kernel run for the vectors that have lanes in it
+inline void w_block_f(const float *re, const float *im, float *wre, float *wim)
+{
+  const float_consts &k = consts();
+  vfloat vre[NV], vim[NV], wr[NV], wi[NV];
+  vfmask mcf[NV], msum[NV];
+  int nu = 0;
+  for (int v = 0; v < NV; ++v) {
+    vre[v] = load(re + v*fwidth);
+    vim[v] = load(im + v*fwidth);
+    classify_f(vre[v], vim[v], mcf[v], msum[v]);
+    nu = std::max(nu, lane_max(cf_terms_f(abs(vre[v]), abs(vim[v])), mcf[v]));
+    wr[v] = wi[v] = set1f(0.0f);
+  }
+
+  if (nu > 0) {
+    // the other lanes get a harmless z
+    vfloat cre[NV], cim[NV], tr[NV], ti[NV];
+    for (int v = 0; v < NV; ++v) {
+      cre[v] = select(mcf[v], vre[v], set1f(5.0f));
+      cim[v] = select(mcf[v], vim[v], set1f(5.0f));
+    }
+    w_cf_f<NV>(cre, cim, nu, tr, ti);
+    for (int v = 0; v < NV; ++v) {
+      wr[v] = select(mcf[v], tr[v], wr[v]);
+      wi[v] = select(mcf[v], ti[v], wi[v]);
+    }
+  }
+  for (int v = 0; v < NV; ++v) {
+    if (any(msum[v])) {
+      const int nterm = lane_max(floor((abs(vre[v]) + k.kterm) * (1.0f / k.a)) + 1.0f, msum[v]);
+      vfloat tr, ti;
+      w_sums_f(select(msum[v], vre[v], set1f(1.0f)), select(msum[v], vim[v], set1f(1.0f)),
+               std::min(nterm, NTERM_F), tr, ti);
+      wr[v] = select(msum[v], tr, wr[v]);
+      wi[v] = select(msum[v], ti, wi[v]);
+    }
+    store(wre + v*fwidth, wr[v]);
+    store(wim + v*fwidth, wi[v]);
+  }
+
+  for (int v = 0; v < NV; ++v) {
+    const int sb = bits(!(mcf[v] | msum[v]));
+    for (int j = 0; sb && j < fwidth; ++j) {
+      if ((sb >> j) & 1) {
+        const int q = v*fwidth + j;
+        std::complex<double> wq = Faddeeva::w(std::complex<double>(re[q], im[q]), float_context());
+        wre[q] = float(std::real(wq));
+        wim[q] = float(std::imag(wq));
+      }
+    }
+  }
+}
+
+// Consecutive blocks of BLOCK_F points, the last one padded with z = 1 + i
+void w_blocks_f(int n, const float *re, const float *im, float *wre, float *wim)
+{
+  int i = 0;
+  for (; i + BLOCK_F <= n; i += BLOCK_F)
+    w_block_f(re + i, im + i, wre + i, wim + i);
+
+  if (i < n) {
+    float bre[BLOCK_F], bim[BLOCK_F], bwr[BLOCK_F], bwi[BLOCK_F];
+    for (int k = 0; k < BLOCK_F; ++k) {
+      bre[k] = i + k < n ? re[i + k] : 1.0f;
+      bim[k] = i + k < n ? im[i + k] : 1.0f;
+    }
+    w_block_f(bre, bim, bwr, bwi);
+    for (int k = 0; i + k < n; ++k) {
+      wre[i + k] = bwr[k];
+      wim[i + k] = bwi[k];
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////
+// A block holding points of both regions runs both kernels.  With the
+// regions interleaved at random that is most blocks, so the points of a
+// chunk are then split into the Algorithm 916 points and the rest, each
+// part is run through w_blocks_f, and the results are scattered back:
+// the same idea as w_sorted in Faddeeva_Batch.cc with two keys instead
+// of one per trip count, which is enough with the short float trip counts.
+
+const int CHUNK_F = 4096;
+const int SPLIT_MIN_F = 256; // shorter arrays go straight to w_blocks_f
+
+// 1 for the Algorithm 916 region, without branches: with random input a
+// branch on it is mispredicted about as often as it is taken
+inline int in_sums_f(float re, float im)
+{
+  return int(std::fabs(re) < 5.0f) & int(std::fabs(im) < 3.0f);
+}
+
+void w_split_f(int n, const float *re, const float *im, float *wre, float *wim)
+{
+  const int nbuf = std::min(n, CHUNK_F);
+  std::vector<int> perm(nbuf);
+  std::vector<float> sre(nbuf), sim(nbuf), swr(nbuf), swi(nbuf);
+
+  for (int i0 = 0; i0 < n; i0 += CHUNK_F) {
+    const int m = std::min(CHUNK_F, n - i0);
+    const float *cre = re + i0, *cim = im + i0;
+
+    // count the mixed blocks; ordered input has few and is left as it is
+    int nmixed = 0, nsum = 0;
+    for (int j = 0; j < m; j += BLOCK_F) {
+      int k = 0;
+      for (int q = j; q < j + BLOCK_F && q < m; ++q)
+        k += in_sums_f(cre[q], cim[q]);
+      nsum += k;
+      if (k != 0 && k != std::min(BLOCK_F, m - j)) ++nmixed;
+    }
+    if (8*nmixed*BLOCK_F <= m) {
+      w_blocks_f(m, cre, cim, wre + i0, wim + i0);
+      continue;
+    }
+
+    int qs = 0, qo = nsum;
+    for (int j = 0; j < m; ++j) {
+      const int f = in_sums_f(cre[j], cim[j]);
+      const int q = f ? qs : qo;
+      qs += f;
+      qo += 1 - f;
+      perm[q] = j;
+      sre[q] = cre[j];
+      sim[q] = cim[j];
+    }
+    w_blocks_f(nsum, &sre[0], &sim[0], &swr[0], &swi[0]);
+    w_blocks_f(m - nsum, &sre[nsum], &sim[nsum], &swr[nsum], &swi[nsum]);
+    for (int q = 0; q < m; ++q) {
+      wre[i0 + perm[q]] = swr[q];
+      wim[i0 + perm[q]] = swi[q];
+    }
+  }
+}
+
+} // anonymous namespace
+
+/////////////////////////////////////////////////////////////////////////
+
+std::complex<float> Faddeeva::w(std::complex<float> z)
+{
+  const std::complex<double> r = w(std::complex<double>(z), float_context());
+  return std::complex<float>(float(std::real(r)), float(std::imag(r)));
+}
+
+void Faddeeva::w(int n, const float *re, const float *im, float *wre, float *wim)
+{
+  if (fwidth == 1) {
+    for (int i = 0; i < n; ++i) {
+      std::complex<float> wi = w(std::complex<float>(re[i], im[i]));
+      wre[i] = std::real(wi);
+      wim[i] = std::imag(wi);
+    }
+    return;
+  }
+
+  if (n < SPLIT_MIN_F)
+    w_blocks_f(n, re, im, wre, wim);
+  else
+    w_split_f(n, re, im, wre, wim);
+}
+
+float Faddeeva::erfcx(float x)
+{
+  return float(erfcx(double(x)));
+}
+
+void Faddeeva::erfcx(int n, const float *x, float *f)
+{
+  for_blocks_real_f(n, x, f, [](vfloat v) { return erfcx_real_f(v); },
+                    [](float v) { return Faddeeva::erfcx(v); });
+}
+
+float Faddeeva::Dawson(float x)
+{
+  return float(Dawson(double(x)));
+}
+
+void Faddeeva::Dawson(int n, const float *x, float *f)
+{
+  const float spi2 = 0.8862269254527580136490837416705725913990f; // sqrt(pi)/2
+  for_blocks_real_f(n, x, f, [spi2](vfloat v) { return spi2 * w_im_real_f(v); },
+                    [](float v) { return Faddeeva::Dawson(v); });
+}
@@ -0,0 +1,511 @@
+//  -*- mode:c++; tab-width:2; indent-tabs-mode:nil;  -*-
+
+/* Minimal fixed-width vector layer used by the array versions of the
+   Faddeeva functions in Faddeeva_Batch.cc and Faddeeva_Float.cc.  It is
+   not part of the public interface.
+
+   The instruction set is chosen at compile time:
+
+      __AVX512F__  8 doubles per vector (e.g. g++ -mavx512f, MSVC /arch:AVX512)
+      __AVX2__     4 doubles per vector (e.g. g++ -mavx2 -mfma, MSVC /arch:AVX2)
+      otherwise    1 double per "vector", plain scalar code
+
+   Each set also has a single-precision vector, vfloat, with fwidth =
+   2*width lanes (1 in the scalar case), used by Faddeeva_Float.cc.
+
+   On top of the primitive operations it provides exp and sincos,
+   vectorized versions of the Cephes routines (S. L. Moshier), which
+   are accurate to a couple of ulp over the argument ranges used
+   here (|x| < 1e5 for sincos, |x| < 8192 in single precision). */
+
+#ifndef FADDEEVA_SIMD_HH
+#define FADDEEVA_SIMD_HH 1
+
+#include <cmath>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#  include <immintrin.h>
+#endif
+
+namespace Faddeeva {
+namespace simd {
+
+#if defined(__AVX512F__)
+
+static const int width = 8;
+static const char isa[] = "AVX-512";
+
+struct vdouble { __m512d v; };
+struct vmask { __mmask8 m; };
+
+// GCC 12 expands the unmasked forms of several AVX-512 intrinsics with an
+// _mm512_undefined_* source and then warns (-Wuninitialized) wherever they
+// are inlined; the maskz forms with every lane set, and the mask gathers
+// with an explicit zero source, compile to the same instructions
+static const __mmask8 ALL8 = 0xFF;
+static const __mmask16 ALL16 = 0xFFFF;
+
+static inline vdouble mk(__m512d v) { vdouble r; r.v = v; return r; }
+static inline vmask mkm(__mmask8 m) { vmask r; r.m = m; return r; }
+
+static inline vdouble set1(double a) { return mk(_mm512_set1_pd(a)); }
+static inline vdouble load(const double *p) { return mk(_mm512_loadu_pd(p)); }
+static inline void store(double *p, vdouble a) { _mm512_storeu_pd(p, a.v); }
+// truncate to int and store width ints
+static inline void store_int(int *p, vdouble a) { _mm256_storeu_si256((__m256i *) p, _mm512_maskz_cvttpd_epi32(ALL8, a.v)); }
+// base[idx[k]] into lane k, for width ints idx
+static inline vdouble gather(const double *base, const int *idx) { return mk(_mm512_mask_i32gather_pd(_mm512_setzero_pd(), ALL8, _mm256_loadu_si256((const __m256i *) idx), base, 8)); }
+
+static inline vdouble operator+(vdouble a, vdouble b) { return mk(_mm512_add_pd(a.v, b.v)); }
+static inline vdouble operator-(vdouble a, vdouble b) { return mk(_mm512_sub_pd(a.v, b.v)); }
+static inline vdouble operator*(vdouble a, vdouble b) { return mk(_mm512_mul_pd(a.v, b.v)); }
+static inline vdouble operator/(vdouble a, vdouble b) { return mk(_mm512_div_pd(a.v, b.v)); }
+static inline vdouble operator-(vdouble a) { return mk(_mm512_sub_pd(_mm512_setzero_pd(), a.v)); }
+// a*b + c, fused
+static inline vdouble fma(vdouble a, vdouble b, vdouble c) { return mk(_mm512_fmadd_pd(a.v, b.v, c.v)); }
+
+static inline vdouble sqrt(vdouble a) { return mk(_mm512_sqrt_pd(a.v)); }
+static inline vdouble min(vdouble a, vdouble b) { return mk(_mm512_maskz_min_pd(ALL8, a.v, b.v)); }
+static inline vdouble max(vdouble a, vdouble b) { return mk(_mm512_maskz_max_pd(ALL8, a.v, b.v)); }
+static inline vdouble floor(vdouble a) {
+  return mk(_mm512_maskz_roundscale_pd(ALL8, a.v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC));
+}
+static inline vdouble round(vdouble a) { // to nearest
+  return mk(_mm512_maskz_roundscale_pd(ALL8, a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+}
+static inline vdouble abs(vdouble a) {
+  return mk(_mm512_castsi512_pd(_mm512_and_epi64(_mm512_castpd_si512(a.v), _mm512_set1_epi64(0x7fffffffffffffffLL))));
+}
+// magnitude of a with the sign of b
+static inline vdouble copysign(vdouble a, vdouble b) {
+  const __m512i sgn = _mm512_set1_epi64((long long) 0x8000000000000000ULL);
+  return mk(_mm512_castsi512_pd(_mm512_or_epi64(_mm512_maskz_andnot_epi64(ALL8, sgn, _mm512_castpd_si512(a.v)),
+                                                _mm512_and_epi64(sgn, _mm512_castpd_si512(b.v)))));
+}
+// 2^n for integer-valued n in [-1022, 1023]
+static inline vdouble pow2n(vdouble n) {
+  __m512d t = _mm512_add_pd(n.v, _mm512_set1_pd(4503599627371519.0)); // 2^52 + 1023
+  return mk(_mm512_castsi512_pd(_mm512_maskz_slli_epi64(ALL8, _mm512_castpd_si512(t), 52)));
+}
+
+static inline vmask operator<(vdouble a, vdouble b) { return mkm(_mm512_cmp_pd_mask(a.v, b.v, _CMP_LT_OQ)); }
+static inline vmask operator<=(vdouble a, vdouble b) { return mkm(_mm512_cmp_pd_mask(a.v, b.v, _CMP_LE_OQ)); }
+static inline vmask operator>(vdouble a, vdouble b) { return mkm(_mm512_cmp_pd_mask(a.v, b.v, _CMP_GT_OQ)); }
+static inline vmask operator>=(vdouble a, vdouble b) { return mkm(_mm512_cmp_pd_mask(a.v, b.v, _CMP_GE_OQ)); }
+static inline vmask operator==(vdouble a, vdouble b) { return mkm(_mm512_cmp_pd_mask(a.v, b.v, _CMP_EQ_OQ)); }
+
+static inline vmask operator&(vmask a, vmask b) { return mkm(a.m & b.m); }
+static inline vmask operator|(vmask a, vmask b) { return mkm(a.m | b.m); }
+static inline vmask operator!(vmask a) { return mkm((__mmask8) ~a.m); }
+static inline vmask none_set() { return mkm(0); }
+static inline bool any(vmask a) { return a.m != 0; }
+static inline int bits(vmask a) { return (int) a.m; } // bit k set <=> lane k set
+
+// a where m is set, b elsewhere
+static inline vdouble select(vmask m, vdouble a, vdouble b) { return mk(_mm512_mask_blend_pd(m.m, b.v, a.v)); }
+
+// single precision, twice as many lanes
+static const int fwidth = 16;
+
+struct vfloat { __m512 v; };
+struct vfmask { __mmask16 m; };
+
+static inline vfloat mkf(__m512 v) { vfloat r; r.v = v; return r; }
+static inline vfmask mkfm(__mmask16 m) { vfmask r; r.m = m; return r; }
+
+static inline vfloat set1f(float a) { return mkf(_mm512_set1_ps(a)); }
+static inline vfloat load(const float *p) { return mkf(_mm512_loadu_ps(p)); }
+static inline void store(float *p, vfloat a) { _mm512_storeu_ps(p, a.v); }
+static inline void store_int(int *p, vfloat a) { _mm512_storeu_si512((void *) p, _mm512_maskz_cvttps_epi32(ALL16, a.v)); }
+static inline vfloat gather(const float *base, const int *idx) { return mkf(_mm512_mask_i32gather_ps(_mm512_setzero_ps(), ALL16, _mm512_loadu_si512((const void *) idx), base, 4)); }
+
+static inline vfloat operator+(vfloat a, vfloat b) { return mkf(_mm512_add_ps(a.v, b.v)); }
+static inline vfloat operator-(vfloat a, vfloat b) { return mkf(_mm512_sub_ps(a.v, b.v)); }
+static inline vfloat operator*(vfloat a, vfloat b) { return mkf(_mm512_mul_ps(a.v, b.v)); }
+static inline vfloat operator/(vfloat a, vfloat b) { return mkf(_mm512_div_ps(a.v, b.v)); }
+static inline vfloat operator-(vfloat a) { return mkf(_mm512_sub_ps(_mm512_setzero_ps(), a.v)); }
+static inline vfloat fma(vfloat a, vfloat b, vfloat c) { return mkf(_mm512_fmadd_ps(a.v, b.v, c.v)); }
+
+static inline vfloat min(vfloat a, vfloat b) { return mkf(_mm512_maskz_min_ps(ALL16, a.v, b.v)); }
+static inline vfloat max(vfloat a, vfloat b) { return mkf(_mm512_maskz_max_ps(ALL16, a.v, b.v)); }
+static inline vfloat floor(vfloat a) {
+  return mkf(_mm512_maskz_roundscale_ps(ALL16, a.v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC));
+}
+static inline vfloat round(vfloat a) {
+  return mkf(_mm512_maskz_roundscale_ps(ALL16, a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+}
+static inline vfloat abs(vfloat a) {
+  return mkf(_mm512_castsi512_ps(_mm512_and_epi32(_mm512_castps_si512(a.v), _mm512_set1_epi32(0x7fffffff))));
+}
+static inline vfloat copysign(vfloat a, vfloat b) {
+  const __m512i sgn = _mm512_set1_epi32((int) 0x80000000U);
+  return mkf(_mm512_castsi512_ps(_mm512_or_epi32(_mm512_maskz_andnot_epi32(ALL16, sgn, _mm512_castps_si512(a.v)),
+                                                 _mm512_and_epi32(sgn, _mm512_castps_si512(b.v)))));
+}
+// 2^n for integer-valued n in [-126, 127]
+static inline vfloat pow2n(vfloat n) {
+  __m512 t = _mm512_add_ps(n.v, _mm512_set1_ps(8388735.0f)); // 2^23 + 127
+  return mkf(_mm512_castsi512_ps(_mm512_maskz_slli_epi32(ALL16, _mm512_castps_si512(t), 23)));
+}
+
+static inline vfmask operator<(vfloat a, vfloat b) { return mkfm(_mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ)); }
+static inline vfmask operator<=(vfloat a, vfloat b) { return mkfm(_mm512_cmp_ps_mask(a.v, b.v, _CMP_LE_OQ)); }
+static inline vfmask operator>(vfloat a, vfloat b) { return mkfm(_mm512_cmp_ps_mask(a.v, b.v, _CMP_GT_OQ)); }
+static inline vfmask operator>=(vfloat a, vfloat b) { return mkfm(_mm512_cmp_ps_mask(a.v, b.v, _CMP_GE_OQ)); }
+static inline vfmask operator==(vfloat a, vfloat b) { return mkfm(_mm512_cmp_ps_mask(a.v, b.v, _CMP_EQ_OQ)); }
+
+static inline vfmask operator&(vfmask a, vfmask b) { return mkfm(a.m & b.m); }
+static inline vfmask operator|(vfmask a, vfmask b) { return mkfm(a.m | b.m); }
+static inline vfmask operator!(vfmask a) { return mkfm((__mmask16) ~a.m); }
+static inline bool any(vfmask a) { return a.m != 0; }
+static inline int bits(vfmask a) { return (int) a.m; }
+
+static inline vfloat select(vfmask m, vfloat a, vfloat b) { return mkf(_mm512_mask_blend_ps(m.m, b.v, a.v)); }
+
+#elif defined(__AVX2__)
+
+static const int width = 4;
+static const char isa[] = "AVX2";
+
+struct vdouble { __m256d v; };
+struct vmask { __m256d m; };
+
+static inline vdouble mk(__m256d v) { vdouble r; r.v = v; return r; }
+static inline vmask mkm(__m256d m) { vmask r; r.m = m; return r; }
+
+static inline vdouble set1(double a) { return mk(_mm256_set1_pd(a)); }
+static inline vdouble load(const double *p) { return mk(_mm256_loadu_pd(p)); }
+static inline void store(double *p, vdouble a) { _mm256_storeu_pd(p, a.v); }
+static inline void store_int(int *p, vdouble a) { _mm_storeu_si128((__m128i *) p, _mm256_cvttpd_epi32(a.v)); }
+// the mask gather with a zero source and every lane set: the plain form has an
+// undefined source that GCC 12 warns about where it is inlined
+static inline vdouble gather(const double *base, const int *idx) { return mk(_mm256_mask_i32gather_pd(_mm256_setzero_pd(), base, _mm_loadu_si128((const __m128i *) idx), _mm256_castsi256_pd(_mm256_set1_epi64x(-1)), 8)); }
+
+static inline vdouble operator+(vdouble a, vdouble b) { return mk(_mm256_add_pd(a.v, b.v)); }
+static inline vdouble operator-(vdouble a, vdouble b) { return mk(_mm256_sub_pd(a.v, b.v)); }
+static inline vdouble operator*(vdouble a, vdouble b) { return mk(_mm256_mul_pd(a.v, b.v)); }
+static inline vdouble operator/(vdouble a, vdouble b) { return mk(_mm256_div_pd(a.v, b.v)); }
+static inline vdouble operator-(vdouble a) { return mk(_mm256_sub_pd(_mm256_setzero_pd(), a.v)); }
+#  if defined(__FMA__)
+static inline vdouble fma(vdouble a, vdouble b, vdouble c) { return mk(_mm256_fmadd_pd(a.v, b.v, c.v)); }
+#  else
+static inline vdouble fma(vdouble a, vdouble b, vdouble c) { return mk(_mm256_add_pd(_mm256_mul_pd(a.v, b.v), c.v)); }
+#  endif
+
+static inline vdouble sqrt(vdouble a) { return mk(_mm256_sqrt_pd(a.v)); }
+static inline vdouble min(vdouble a, vdouble b) { return mk(_mm256_min_pd(a.v, b.v)); }
+static inline vdouble max(vdouble a, vdouble b) { return mk(_mm256_max_pd(a.v, b.v)); }
+static inline vdouble floor(vdouble a) { return mk(_mm256_floor_pd(a.v)); }
+static inline vdouble round(vdouble a) {
+  return mk(_mm256_round_pd(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+}
+static inline vdouble abs(vdouble a) { return mk(_mm256_andnot_pd(_mm256_set1_pd(-0.0), a.v)); }
+static inline vdouble copysign(vdouble a, vdouble b) {
+  const __m256d sgn = _mm256_set1_pd(-0.0);
+  return mk(_mm256_or_pd(_mm256_andnot_pd(sgn, a.v), _mm256_and_pd(sgn, b.v)));
+}
+static inline vdouble pow2n(vdouble n) {
+  __m256d t = _mm256_add_pd(n.v, _mm256_set1_pd(4503599627371519.0)); // 2^52 + 1023
+  return mk(_mm256_castsi256_pd(_mm256_slli_epi64(_mm256_castpd_si256(t), 52)));
+}
+
+static inline vmask operator<(vdouble a, vdouble b) { return mkm(_mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ)); }
+static inline vmask operator<=(vdouble a, vdouble b) { return mkm(_mm256_cmp_pd(a.v, b.v, _CMP_LE_OQ)); }
+static inline vmask operator>(vdouble a, vdouble b) { return mkm(_mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ)); }
+static inline vmask operator>=(vdouble a, vdouble b) { return mkm(_mm256_cmp_pd(a.v, b.v, _CMP_GE_OQ)); }
+static inline vmask operator==(vdouble a, vdouble b) { return mkm(_mm256_cmp_pd(a.v, b.v, _CMP_EQ_OQ)); }
+
+static inline vmask operator&(vmask a, vmask b) { return mkm(_mm256_and_pd(a.m, b.m)); }
+static inline vmask operator|(vmask a, vmask b) { return mkm(_mm256_or_pd(a.m, b.m)); }
+static inline vmask operator!(vmask a) {
+  return mkm(_mm256_xor_pd(a.m, _mm256_castsi256_pd(_mm256_set1_epi64x(-1))));
+}
+static inline vmask none_set() { return mkm(_mm256_setzero_pd()); }
+static inline bool any(vmask a) { return _mm256_movemask_pd(a.m) != 0; }
+static inline int bits(vmask a) { return _mm256_movemask_pd(a.m); }
+
+static inline vdouble select(vmask m, vdouble a, vdouble b) { return mk(_mm256_blendv_pd(b.v, a.v, m.m)); }
+
+// single precision, twice as many lanes
+static const int fwidth = 8;
+
+struct vfloat { __m256 v; };
+struct vfmask { __m256 m; };
+
+static inline vfloat mkf(__m256 v) { vfloat r; r.v = v; return r; }
+static inline vfmask mkfm(__m256 m) { vfmask r; r.m = m; return r; }
+
+static inline vfloat set1f(float a) { return mkf(_mm256_set1_ps(a)); }
+static inline vfloat load(const float *p) { return mkf(_mm256_loadu_ps(p)); }
+static inline void store(float *p, vfloat a) { _mm256_storeu_ps(p, a.v); }
+static inline void store_int(int *p, vfloat a) { _mm256_storeu_si256((__m256i *) p, _mm256_cvttps_epi32(a.v)); }
+static inline vfloat gather(const float *base, const int *idx) { return mkf(_mm256_mask_i32gather_ps(_mm256_setzero_ps(), base, _mm256_loadu_si256((const __m256i *) idx), _mm256_castsi256_ps(_mm256_set1_epi32(-1)), 4)); }
+
+static inline vfloat operator+(vfloat a, vfloat b) { return mkf(_mm256_add_ps(a.v, b.v)); }
+static inline vfloat operator-(vfloat a, vfloat b) { return mkf(_mm256_sub_ps(a.v, b.v)); }
+static inline vfloat operator*(vfloat a, vfloat b) { return mkf(_mm256_mul_ps(a.v, b.v)); }
+static inline vfloat operator/(vfloat a, vfloat b) { return mkf(_mm256_div_ps(a.v, b.v)); }
+static inline vfloat operator-(vfloat a) { return mkf(_mm256_sub_ps(_mm256_setzero_ps(), a.v)); }
+#  if defined(__FMA__)
+static inline vfloat fma(vfloat a, vfloat b, vfloat c) { return mkf(_mm256_fmadd_ps(a.v, b.v, c.v)); }
+#  else
+static inline vfloat fma(vfloat a, vfloat b, vfloat c) { return mkf(_mm256_add_ps(_mm256_mul_ps(a.v, b.v), c.v)); }
+#  endif
+
+static inline vfloat min(vfloat a, vfloat b) { return mkf(_mm256_min_ps(a.v, b.v)); }
+static inline vfloat max(vfloat a, vfloat b) { return mkf(_mm256_max_ps(a.v, b.v)); }
+static inline vfloat floor(vfloat a) { return mkf(_mm256_floor_ps(a.v)); }
+static inline vfloat round(vfloat a) {
+  return mkf(_mm256_round_ps(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+}
+static inline vfloat abs(vfloat a) { return mkf(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v)); }
+static inline vfloat copysign(vfloat a, vfloat b) {
+  const __m256 sgn = _mm256_set1_ps(-0.0f);
+  return mkf(_mm256_or_ps(_mm256_andnot_ps(sgn, a.v), _mm256_and_ps(sgn, b.v)));
+}
+static inline vfloat pow2n(vfloat n) {
+  __m256 t = _mm256_add_ps(n.v, _mm256_set1_ps(8388735.0f)); // 2^23 + 127
+  return mkf(_mm256_castsi256_ps(_mm256_slli_epi32(_mm256_castps_si256(t), 23)));
+}
+
+static inline vfmask operator<(vfloat a, vfloat b) { return mkfm(_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)); }
+static inline vfmask operator<=(vfloat a, vfloat b) { return mkfm(_mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ)); }
+static inline vfmask operator>(vfloat a, vfloat b) { return mkfm(_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)); }
+static inline vfmask operator>=(vfloat a, vfloat b) { return mkfm(_mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ)); }
+static inline vfmask operator==(vfloat a, vfloat b) { return mkfm(_mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ)); }
+
+static inline vfmask operator&(vfmask a, vfmask b) { return mkfm(_mm256_and_ps(a.m, b.m)); }
+static inline vfmask operator|(vfmask a, vfmask b) { return mkfm(_mm256_or_ps(a.m, b.m)); }
+static inline vfmask operator!(vfmask a) {
+  return mkfm(_mm256_xor_ps(a.m, _mm256_castsi256_ps(_mm256_set1_epi32(-1))));
+}
+static inline bool any(vfmask a) { return _mm256_movemask_ps(a.m) != 0; }
+static inline int bits(vfmask a) { return _mm256_movemask_ps(a.m); }
+
+static inline vfloat select(vfmask m, vfloat a, vfloat b) { return mkf(_mm256_blendv_ps(b.v, a.v, m.m)); }
+
+#else // scalar fallback
+
+static const int width = 1;
+static const char isa[] = "scalar";
+
+struct vdouble { double v; };
+struct vmask { bool m; };
+
+static inline vdouble mk(double v) { vdouble r; r.v = v; return r; }
+static inline vmask mkm(bool m) { vmask r; r.m = m; return r; }
+
+static inline vdouble set1(double a) { return mk(a); }
+static inline vdouble load(const double *p) { return mk(*p); }
+static inline void store(double *p, vdouble a) { *p = a.v; }
+static inline void store_int(int *p, vdouble a) { *p = (int) a.v; }
+static inline vdouble gather(const double *base, const int *idx) { return mk(base[*idx]); }
+
+static inline vdouble operator+(vdouble a, vdouble b) { return mk(a.v + b.v); }
+static inline vdouble operator-(vdouble a, vdouble b) { return mk(a.v - b.v); }
+static inline vdouble operator*(vdouble a, vdouble b) { return mk(a.v * b.v); }
+static inline vdouble operator/(vdouble a, vdouble b) { return mk(a.v / b.v); }
+static inline vdouble operator-(vdouble a) { return mk(-a.v); }
+static inline vdouble fma(vdouble a, vdouble b, vdouble c) { return mk(a.v * b.v + c.v); }
+
+static inline vdouble sqrt(vdouble a) { return mk(std::sqrt(a.v)); }
+static inline vdouble min(vdouble a, vdouble b) { return mk(a.v < b.v ? a.v : b.v); }
+static inline vdouble max(vdouble a, vdouble b) { return mk(a.v > b.v ? a.v : b.v); }
+static inline vdouble floor(vdouble a) { return mk(std::floor(a.v)); }
+static inline vdouble round(vdouble a) { return mk(std::floor(a.v + 0.5)); }
+static inline vdouble abs(vdouble a) { return mk(std::fabs(a.v)); }
+static inline vdouble copysign(vdouble a, vdouble b) { return mk(b.v < 0 || (b.v == 0 && 1 / b.v < 0) ? -std::fabs(a.v) : std::fabs(a.v)); }
+static inline vdouble pow2n(vdouble n) { return mk(std::ldexp(1.0, (int) n.v)); }
+
+static inline vmask operator<(vdouble a, vdouble b) { return mkm(a.v < b.v); }
+static inline vmask operator<=(vdouble a, vdouble b) { return mkm(a.v <= b.v); }
+static inline vmask operator>(vdouble a, vdouble b) { return mkm(a.v > b.v); }
+static inline vmask operator>=(vdouble a, vdouble b) { return mkm(a.v >= b.v); }
+static inline vmask operator==(vdouble a, vdouble b) { return mkm(a.v == b.v); }
+
+static inline vmask operator&(vmask a, vmask b) { return mkm(a.m && b.m); }
+static inline vmask operator|(vmask a, vmask b) { return mkm(a.m || b.m); }
+static inline vmask operator!(vmask a) { return mkm(!a.m); }
+static inline vmask none_set() { return mkm(false); }
+static inline bool any(vmask a) { return a.m; }
+static inline int bits(vmask a) { return a.m ? 1 : 0; }
+
+static inline vdouble select(vmask m, vdouble a, vdouble b) { return m.m ? a : b; }
+
+static const int fwidth = 1;
+
+struct vfloat { float v; };
+struct vfmask { bool m; };
+
+static inline vfloat mkf(float v) { vfloat r; r.v = v; return r; }
+static inline vfmask mkfm(bool m) { vfmask r; r.m = m; return r; }
+
+static inline vfloat set1f(float a) { return mkf(a); }
+static inline vfloat load(const float *p) { return mkf(*p); }
+static inline void store(float *p, vfloat a) { *p = a.v; }
+static inline void store_int(int *p, vfloat a) { *p = (int) a.v; }
+static inline vfloat gather(const float *base, const int *idx) { return mkf(base[*idx]); }
+
+static inline vfloat operator+(vfloat a, vfloat b) { return mkf(a.v + b.v); }
+static inline vfloat operator-(vfloat a, vfloat b) { return mkf(a.v - b.v); }
+static inline vfloat operator*(vfloat a, vfloat b) { return mkf(a.v * b.v); }
+static inline vfloat operator/(vfloat a, vfloat b) { return mkf(a.v / b.v); }
+static inline vfloat operator-(vfloat a) { return mkf(-a.v); }
+static inline vfloat fma(vfloat a, vfloat b, vfloat c) { return mkf(a.v * b.v + c.v); }
+
+static inline vfloat min(vfloat a, vfloat b) { return mkf(a.v < b.v ? a.v : b.v); }
+static inline vfloat max(vfloat a, vfloat b) { return mkf(a.v > b.v ? a.v : b.v); }
+static inline vfloat floor(vfloat a) { return mkf(std::floor(a.v)); }
+static inline vfloat round(vfloat a) { return mkf(std::floor(a.v + 0.5f)); }
+static inline vfloat abs(vfloat a) { return mkf(std::fabs(a.v)); }
+static inline vfloat copysign(vfloat a, vfloat b) { return mkf(b.v < 0 || (b.v == 0 && 1 / b.v < 0) ? -std::fabs(a.v) : std::fabs(a.v)); }
+static inline vfloat pow2n(vfloat n) { return mkf(std::ldexp(1.0f, (int) n.v)); }
+
+static inline vfmask operator<(vfloat a, vfloat b) { return mkfm(a.v < b.v); }
+static inline vfmask operator<=(vfloat a, vfloat b) { return mkfm(a.v <= b.v); }
+static inline vfmask operator>(vfloat a, vfloat b) { return mkfm(a.v > b.v); }
+static inline vfmask operator>=(vfloat a, vfloat b) { return mkfm(a.v >= b.v); }
+static inline vfmask operator==(vfloat a, vfloat b) { return mkfm(a.v == b.v); }
+
+static inline vfmask operator&(vfmask a, vfmask b) { return mkfm(a.m && b.m); }
+static inline vfmask operator|(vfmask a, vfmask b) { return mkfm(a.m || b.m); }
+static inline vfmask operator!(vfmask a) { return mkfm(!a.m); }
+static inline bool any(vfmask a) { return a.m; }
+static inline int bits(vfmask a) { return a.m ? 1 : 0; }
+
+static inline vfloat select(vfmask m, vfloat a, vfloat b) { return m.m ? a : b; }
+
+#endif
+
+/////////////////////////////////////////////////////////////////////////
+// ISA-independent functions built on the primitives above
+
+static inline vdouble operator+(vdouble a, double b) { return a + set1(b); }
+static inline vdouble operator-(vdouble a, double b) { return a - set1(b); }
+static inline vdouble operator*(vdouble a, double b) { return a * set1(b); }
+static inline vdouble operator+(double a, vdouble b) { return set1(a) + b; }
+static inline vdouble operator-(double a, vdouble b) { return set1(a) - b; }
+static inline vdouble operator*(double a, vdouble b) { return set1(a) * b; }
+static inline vdouble operator/(double a, vdouble b) { return set1(a) / b; }
+static inline vmask operator<(vdouble a, double b) { return a < set1(b); }
+static inline vmask operator<=(vdouble a, double b) { return a <= set1(b); }
+static inline vmask operator>(vdouble a, double b) { return a > set1(b); }
+static inline vmask operator>=(vdouble a, double b) { return a >= set1(b); }
+
+static inline vfloat operator+(vfloat a, float b) { return a + set1f(b); }
+static inline vfloat operator-(vfloat a, float b) { return a - set1f(b); }
+static inline vfloat operator*(vfloat a, float b) { return a * set1f(b); }
+static inline vfloat operator+(float a, vfloat b) { return set1f(a) + b; }
+static inline vfloat operator-(float a, vfloat b) { return set1f(a) - b; }
+static inline vfloat operator*(float a, vfloat b) { return set1f(a) * b; }
+static inline vfloat operator/(float a, vfloat b) { return set1f(a) / b; }
+static inline vfmask operator<(vfloat a, float b) { return a < set1f(b); }
+static inline vfmask operator<=(vfloat a, float b) { return a <= set1f(b); }
+static inline vfmask operator>(vfloat a, float b) { return a > set1f(b); }
+static inline vfmask operator>=(vfloat a, float b) { return a >= set1f(b); }
+
+// exp(x), Cephes exp: x = n*ln2 + r with |r| <= ln2/2, exp(r) from a
+// rational form, and 2^n applied in two halves so that results in the
+// subnormal range (x down to -745) come out right
+static inline vdouble exp(vdouble x)
+{
+  const double LOG2E = 1.4426950408889634073599;
+  const double C1 = 6.93145751953125E-1, C2 = 1.42860682030941723212E-6;
+  x = max(min(x, set1(709.79)), set1(-745.2));
+  vdouble n = round(x * LOG2E);
+  x = x - n * C1;
+  x = x - n * C2;
+  vdouble xx = x * x;
+  vdouble px = x * fma(fma(set1(1.26177193074810590878E-4), xx, set1(3.02994407707441961300E-2)), xx,
+                       set1(9.99999999999999999910E-1));
+  vdouble qx = fma(fma(fma(set1(3.00198505138664455042E-6), xx, set1(2.52448340349684104192E-3)), xx,
+                       set1(2.27265548208155028766E-1)), xx, set1(2.00000000000000000009E0));
+  vdouble r = set1(1.0) + 2.0 * (px / (qx - px));
+  vdouble n1 = floor(n * 0.5);
+  return (r * pow2n(n1)) * pow2n(n - n1);
+}
+
+// sin(x) and cos(x) together, Cephes sin/cos with the octant reduction
+// done in floating point; x - j*pi/4 is formed in three parts, which is
+// exact for the |x| < 1e5 used here
+static inline void sincos(vdouble x, vdouble &s, vdouble &c)
+{
+  const double FOPI = 1.27323954473516268615; // 4/pi
+  const double DP1 = 7.85398125648498535156E-1, DP2 = 3.77489470793079817668E-8, DP3 = 2.69515142907905952645E-15;
+  vdouble ax = abs(x);
+  vdouble j = floor(ax * FOPI);
+  j = j + select(j - 2.0 * floor(j * 0.5) > 0.5, set1(1.0), set1(0.0)); // make j even
+  vdouble r = ((ax - j * DP1) - j * DP2) - j * DP3;
+  j = j - 8.0 * floor(j * 0.125); // octant, one of 0, 2, 4, 6
+  vmask hi = j > 3.0;
+  j = select(hi, j - 4.0, j);
+  vmask swap = j > 1.0; // polynomials swap roles in octants 2 and 6
+  vdouble zz = r * r;
+  vdouble ps = fma(fma(fma(fma(fma(set1(1.58962301576546568060E-10), zz, set1(-2.50507477628578072866E-8)), zz,
+                                 set1(2.75573136213857245213E-6)), zz, set1(-1.98412698295895385996E-4)), zz,
+                       set1(8.33333333332211858878E-3)), zz, set1(-1.66666666666666307295E-1));
+  ps = fma(r * zz, ps, r);
+  vdouble pc = fma(fma(fma(fma(fma(set1(-1.13585365213876817300E-11), zz, set1(2.08757008419747316778E-9)), zz,
+                                 set1(-2.75573141792967388112E-7)), zz, set1(2.48015872888517045348E-5)), zz,
+                       set1(-1.38888888888730564116E-3)), zz, set1(4.16666666666665929218E-2));
+  pc = fma(zz * zz, pc, set1(1.0) - 0.5 * zz);
+  vdouble sv = select(swap, pc, ps), cv = select(swap, ps, pc);
+  // sin changes sign in octants 4, 6 and for x < 0, cos in octants 2, 4
+  vmask neg = x < 0.0;
+  s = select((hi & !neg) | (neg & !hi), -sv, sv);
+  vmask cneg = (hi & !swap) | (swap & !hi);
+  c = select(cneg, -cv, cv);
+}
+
+// exp(x) in single precision, Cephes expf: the same reduction as above
+// with a degree-5 polynomial for exp(r) - 1 - r; results in the subnormal
+// range (x down to -103.9) come out right
+static inline vfloat exp(vfloat x)
+{
+  const float LOG2E = 1.44269504088896341f;
+  const float C1 = 0.693359375f, C2 = -2.12194440e-4f;
+  x = max(min(x, set1f(88.72f)), set1f(-103.9f));
+  vfloat n = round(x * LOG2E);
+  x = x - n * C1;
+  x = x - n * C2;
+  vfloat xx = x * x;
+  vfloat p = fma(fma(fma(fma(fma(set1f(1.9875691500E-4f), x, set1f(1.3981999507E-3f)), x,
+                             set1f(8.3334519073E-3f)), x, set1f(4.1665795894E-2f)), x,
+                     set1f(1.6666665459E-1f)), x, set1f(5.0000001201E-1f));
+  vfloat r = fma(p, xx, x) + 1.0f;
+  vfloat n1 = floor(n * 0.5f);
+  return (r * pow2n(n1)) * pow2n(n - n1);
+}
+
+// sin(x) and cos(x) together in single precision, Cephes sinf/cosf with
+// the same octant logic as the double version; the three-part reduction
+// is accurate for the |x| < 8192 used here
+static inline void sincos(vfloat x, vfloat &s, vfloat &c)
+{
+  const float FOPI = 1.27323954473516f; // 4/pi
+  const float DP1 = 0.78515625f, DP2 = 2.4187564849853515625e-4f, DP3 = 3.77489497744594108e-8f;
+  vfloat ax = abs(x);
+  vfloat j = floor(ax * FOPI);
+  j = j + select(j - 2.0f * floor(j * 0.5f) > 0.5f, set1f(1.0f), set1f(0.0f)); // make j even
+  vfloat r = ((ax - j * DP1) - j * DP2) - j * DP3;
+  j = j - 8.0f * floor(j * 0.125f);
+  vfmask hi = j > 3.0f;
+  j = select(hi, j - 4.0f, j);
+  vfmask swap = j > 1.0f;
+  vfloat zz = r * r;
+  vfloat ps = fma(fma(set1f(-1.9515295891E-4f), zz, set1f(8.3321608736E-3f)), zz, set1f(-1.6666654611E-1f));
+  ps = fma(r * zz, ps, r);
+  vfloat pc = fma(fma(set1f(2.443315711809948E-5f), zz, set1f(-1.388731625493765E-3f)), zz,
+                  set1f(4.166664568298827E-2f));
+  pc = fma(zz * zz, pc, 1.0f - 0.5f * zz);
+  vfloat sv = select(swap, pc, ps), cv = select(swap, ps, pc);
+  vfmask neg = x < set1f(0.0f);
+  s = select((hi & !neg) | (neg & !hi), -sv, sv);
+  vfmask cneg = (hi & !swap) | (swap & !hi);
+  c = select(cneg, -cv, cv);
+}
+
+} // namespace simd
+} // namespace Faddeeva
+
+#endif // FADDEEVA_SIMD_HH
@@ -0,0 +1,28 @@
+//  -*- mode:c++; tab-width:2; indent-tabs-mode:nil;  -*-
+
+/* Private header shared by Faddeeva.cc and Faddeeva_Batch.cc, not part of
+   the Faddeeva.hh interface: the Chebyshev coefficient tables behind
+   erfcx(x) and w_im(x) for real x, defined in Faddeeva.cc.
+
+   Row j of each table is the polynomial for y100 in [j, j+1], with
+   y100 = 400/(4+x) for erfcx and 100/(1+x) for w_im (x >= 0), in the
+   variable t = 2*y100 - (2j+1) and lowest degree first.  The scalar
+   routines index them directly and the array routines gather one row
+   per lane. */
+
+#ifndef FADDEEVA_TABLES_HH
+#define FADDEEVA_TABLES_HH 1
+
+namespace Faddeeva {
+namespace tables {
+
+const int ERFCX_ROWS = 100, ERFCX_STRIDE = 8; // degree 6, padded to a cache line
+const int W_IM_ROWS = 97, W_IM_STRIDE = 9;    // degree <= 8, zero padded
+
+extern const double erfcx_cheb[ERFCX_ROWS][ERFCX_STRIDE];
+extern const double w_im_cheb[W_IM_ROWS][W_IM_STRIDE];
+
+} // namespace tables
+} // namespace Faddeeva
+
+#endif // FADDEEVA_TABLES_HH
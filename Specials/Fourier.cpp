@@ -0,0 +1,276 @@
+#ifndef ATTACH_H
+#include "Attach.h"
+#endif
+
+// Definition of the discrete Fourier transforms declared in the namespace fourier
+
+int fourier::next_pow2(int n)
+{
+	// Smallest power of two >= n
+
+	int m = 1; 
+
+	while(m < n) m <<= 1; 
+
+	return m; 
+}
+
+fourier::FFT::FFT()
+{
+	// Default constructor
+	pn = 0; 
+}
+
+fourier::FFT::FFT(int n)
+{
+	// Primary constructor
+	set_size(n); 
+}
+
+void fourier::FFT::set_size(int n)
+{
+	// Tabulate the bit-reversal permutation and the twiddle factors for transforms of length n
+	// The twiddle factors are computed directly rather than by the recurrence of NRinC four1, so that each has full accuracy
+
+	try{
+		if( n > 0 && (n & (n - 1)) == 0 ){
+
+			int j, k, bits; 
+
+			pn = n; 
+
+			for(bits=0; (1 << bits) < n; bits++); 
+
+			rev.resize(n); 
+			for(j=0; j<n; j++){
+				rev[j] = 0; 
+				for(k=0; k<bits; k++){
+					if(j & (1 << k)) rev[j] |= 1 << (bits - 1 - k); 
+				}
+			}
+
+			// the twiddle factors of the butterflies of length len are stored together from tw[len/2 - 1]
+			tw.resize(std::max(n - 1, 1)); 
+			for(int len=2; len<=n; len<<=1){
+				for(k=0; k<len/2; k++) tw[len/2 - 1 + k] = std::complex<double>(cos(Two_PI * k / len), -sin(Two_PI * k / len)); 
+			}
+		}
+		else{
+			std::string reason = "Error: void fourier::FFT::set_size(int n)\n"; 
+			reason += "n = " + template_funcs::toString(n) + " is not a power of two\n"; 
+			throw std::invalid_argument(reason); 
+		}
+	}
+	catch(std::invalid_argument &e){
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
+	}
+}
+
+namespace {
+
+	static const int FFT_BLOCK = 8192; // points whose butterflies of length <= FFT_BLOCK are all done while they are in cache
+
+	void butterflies(std::complex<double> *a, int n, int len, const std::complex<double> *w, double sgn)
+	{
+		// All butterflies of length len in a[0..n-1], w[k] = exp(-2 pi i k / len), sgn = -1 conjugates w for the inverse transform
+		// The complex products are written out in real arithmetic, std::complex multiplication checks for Inf and NaN on every call
+
+		int j, k, half; 
+		double wr, wi, tr, ti; 
+
+		half = len >> 1; 
+
+		for(j=0; j<n; j+=len){
+			for(k=0; k<half; k++){
+				wr = real(w[k]); 
+				wi = sgn * imag(w[k]); 
+
+				std::complex<double> &u = a[j + k], &v = a[j + k + half]; 
+
+				tr = wr * real(v) - wi * imag(v); 
+				ti = wr * imag(v) + wi * real(v); 
+
+				v = std::complex<double>(real(u) - tr, imag(u) - ti); 
+				u = std::complex<double>(real(u) + tr, imag(u) + ti); 
+			}
+		}
+	}
+}
+
+void fourier::FFT::transform(std::complex<double> *a, bool inverse) const
+{
+	// Decimation in time after the bit-reversal permutation
+	// Butterflies of length len <= FFT_BLOCK only combine points within the same block of FFT_BLOCK, so every such stage is
+	// done block by block while the block is in cache, the remaining log2(n / FFT_BLOCK) stages each pass over the whole array
+
+	int j, len, blk; 
+	double sgn; 
+
+	for(j=0; j<pn; j++){
+		if(j < rev[j]) std::swap(a[j], a[rev[j]]); 
+	}
+
+	sgn = inverse ? -1.0 : 1.0; 
+	blk = std::min(pn, FFT_BLOCK); 
+
+	for(j=0; j<pn; j+=blk){
+		for(len=2; len<=blk; len<<=1) butterflies(a + j, blk, len, &tw[len/2 - 1], sgn); 
+	}
+
+	for(len=2*blk; len<=pn; len<<=1) butterflies(a, pn, len, &tw[len/2 - 1], sgn); 
+}
+
+void fourier::FFT::convolve(const double *a, const double *b, double *c) const
+{
+	// With z_j = a_j + i b_j, the transforms of a and b are A_k = (Z_k + conj(Z_{n-k})) / 2 and B_k = (Z_k - conj(Z_{n-k})) / (2i)
+	// The product A_k B_k is transformed back and the real part, divided by n, is the convolution
+
+	int j, k; 
+	std::complex<double> A, B; 
+	std::vector< std::complex<double> > z(pn), p(pn); 
+
+	for(j=0; j<pn; j++) z[j] = std::complex<double>(a[j], b[j]); 
+
+	transform(z.data()); 
+
+	for(k=0; k<pn; k++){
+		j = (pn - k) & (pn - 1); 
+
+		A = 0.5 * (z[k] + conj(z[j])); 
+		B = std::complex<double>(0.0, -0.5) * (z[k] - conj(z[j])); 
+
+		p[k] = A * B; 
+	}
+
+	transform(p.data(), true); 
+
+	for(j=0; j<pn; j++) c[j] = real(p[j]) / pn; 
+}
+
+namespace {
+
+	static const int DCT_DIRECT = 64; // shortest DCT done by FFT
+}
+
+fourier::DCT::DCT()
+{
+	// Default constructor
+	pn = 0; 
+}
+
+fourier::DCT::DCT(int n)
+{
+	// Primary constructor
+	set_size(n); 
+}
+
+void fourier::DCT::set_size(int n)
+{
+	// Tabulate the factors for cosine transforms of length n
+	// The chirp angles pi k^2 / n are reduced modulo 2 pi in integer arithmetic, k^2 mod 2n, so that they keep full accuracy for large k
+
+	try{
+		if(n > 0){
+
+			int j, k, m; 
+			long long r; 
+
+			pn = n; 
+
+			ctab.clear(); shift.clear(); chirp.clear(); filter.clear(); 
+
+			if(n < DCT_DIRECT){
+				ctab.resize(4 * n); 
+				for(j=0; j<4*n; j++) ctab[j] = cos(PI * j / (2.0 * n)); 
+				return; 
+			}
+
+			shift.resize(n); 
+			for(j=0; j<n; j++) shift[j] = std::complex<double>(cos(PI * j / (2.0 * n)), -sin(PI * j / (2.0 * n))); 
+
+			if( (n & (n - 1)) == 0 ){
+				fft.set_size(n); 
+				return; 
+			}
+
+			m = next_pow2(2 * n - 1); 
+			fft.set_size(m); 
+
+			chirp.resize(n); 
+			for(k=0; k<n; k++){
+				r = (static_cast<long long>(k) * k) % (2 * n); 
+				chirp[k] = std::complex<double>(cos(PI * r / n), -sin(PI * r / n)); 
+			}
+
+			// b_k = conj(chirp_{|k|}) for -n < k < n, wrapped onto 0, .., m-1, its transform is scaled by 1 / m for the inverse
+			filter.assign(m, std::complex<double>(0.0, 0.0)); 
+			filter[0] = conj(chirp[0]); 
+			for(k=1; k<n; k++) filter[k] = filter[m - k] = conj(chirp[k]); 
+
+			fft.transform(filter.data()); 
+
+			for(k=0; k<m; k++) filter[k] /= static_cast<double>(m); 
+		}
+		else{
+			std::string reason = "Error: void fourier::DCT::set_size(int n)\n"; 
+			reason += "n = " + template_funcs::toString(n) + " is not positive\n"; 
+			throw std::invalid_argument(reason); 
+		}
+	}
+	catch(std::invalid_argument &e){
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
+	}
+}
+
+void fourier::DCT::transform(const double *x, double *X) const
+{
+	// X_j = sum_{k} x_k cos(pi j (k + 1/2) / n)
+	// By FFT, v_k = x_{2k} and v_{n-1-k} = x_{2k+1} turn the sum into Re[ exp(-i pi j / 2n) sum_{k} v_k exp(-2 pi i j k / n) ]
+	// and when n is not a power of two the DFT of v is chirp_j sum_{k} (v_k chirp_k) conj(chirp_{j-k}), a circular convolution of length m
+
+	int j, k, m; 
+
+	if(pn < DCT_DIRECT){
+		// cos(pi j (2k + 1) / 2n) = ctab[j (2k + 1) mod 4n]
+		int n4 = 4 * pn; 
+
+		for(j=0; j<pn; j++){
+			double sum = 0.0; 
+			int step = (2 * j) % n4, idx = j % n4; 
+
+			for(k=0; k<pn; k++){
+				sum += x[k] * ctab[idx]; 
+				idx += step; 
+				if(idx >= n4) idx -= n4; 
+			}
+			X[j] = sum; 
+		}
+		return; 
+	}
+
+	m = fft.size(); 
+
+	std::vector< std::complex<double> > v(m, std::complex<double>(0.0, 0.0)); 
+
+	for(k=0; 2*k<pn; k++) v[k] = x[2 * k]; 
+	for(k=0; 2*k+1<pn; k++) v[pn - 1 - k] = x[2 * k + 1]; 
+
+	if(m == pn){
+		fft.transform(v.data()); 
+	}
+	else{
+		for(k=0; k<pn; k++) v[k] *= chirp[k]; 
+
+		fft.transform(v.data()); 
+
+		for(k=0; k<m; k++) v[k] *= filter[k]; 
+
+		fft.transform(v.data(), true); 
+
+		for(j=0; j<pn; j++) v[j] *= chirp[j]; 
+	}
+
+	for(j=0; j<pn; j++) X[j] = real(shift[j]) * real(v[j]) - imag(shift[j]) * imag(v[j]); 
+}
\ No newline at end of file
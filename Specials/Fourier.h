@@ -0,0 +1,63 @@
+#ifndef FOURIER_H
+#define FOURIER_H
+
+// Declaration of a namespace for discrete Fourier transforms
+// FFT is an iterative radix-2 transform whose twiddle factors and bit-reversal permutation are computed once for its size
+// and reused by every transform of that size, see NRinC, sect. 12.2
+// The first log2(8192) stages are done block by block in cache, so that large transforms are not limited by memory bandwidth
+// DCT computes the cosine transform used for the coefficients of Chebyshev expansions from an FFT of the same or twice the length
+
+namespace fourier{
+
+	int next_pow2(int n); // smallest power of two >= n
+
+	class FFT{
+	public:
+		FFT(); 
+		FFT(int n); 
+
+		void set_size(int n); // n must be a power of two
+
+		int size() const { return pn; }
+
+		// In place transform a_k = sum_{j} a_j exp(-2 pi i j k / n), or exp(+2 pi i j k / n) when inverse = true
+		// The inverse transform is not divided by n
+		void transform(std::complex<double> *a, bool inverse = false) const; 
+
+		// Circular convolution c_j = sum_{m} a_m b_{(j - m) mod n} of the real arrays a and b, both of length n
+		// a and b are packed as the real and imaginary parts of one complex array, so it costs two complex transforms
+		void convolve(const double *a, const double *b, double *c) const; 
+
+	private:
+		int pn; 
+		std::vector<int> rev; // bit-reversal permutation
+		std::vector< std::complex<double> > tw; // exp(-2 pi i k / len), k = 0, .., len/2 - 1, for len = 2, 4, .., n
+	}; 
+
+	// Discrete cosine transform X_j = sum_{k=0}^{n-1} x_k cos(pi j (k + 1/2) / n), j = 0, .., n-1, the DCT-II, for any n > 0
+	// The x_k are reordered into v = (x_0, x_2, x_4, .., x_5, x_3, x_1) and X_j = Re[ exp(-i pi j / 2n) V_j ], V the DFT of v
+	// see Makhoul, IEEE Trans. ASSP 28, 27 (1980), the DFT is done by FFT when n is a power of two and otherwise as a convolution
+	// with the chirp exp(i pi k^2 / n) by FFTs of length next_pow2(2n - 1), Bluestein's algorithm, both in O(n log n)
+	// Below 64 points the sums are done directly, with the cosines taken from a table of cos(pi m / 2n), m = 0, .., 4n-1
+	class DCT{
+	public:
+		DCT(); 
+		DCT(int n); 
+
+		void set_size(int n); 
+
+		int size() const { return pn; }
+
+		void transform(const double *x, double *X) const; 
+
+	private:
+		int pn; 
+		FFT fft; // of length n, or of the Bluestein convolution
+		std::vector<double> ctab; // cos(pi m / 2n) for the direct sums
+		std::vector< std::complex<double> > shift; // exp(-i pi j / 2n)
+		std::vector< std::complex<double> > chirp; // exp(-i pi k^2 / n), k = 0, .., n-1
+		std::vector< std::complex<double> > filter; // transform of the conjugate chirp wrapped onto the convolution length
+	}; 
+}
+
+#endif
\ No newline at end of file
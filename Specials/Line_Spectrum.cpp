@@ -0,0 +1,319 @@
+#ifndef ATTACH_H
+#include "Attach.h"
+#endif
+
+// Definition of the line-by-line spectrum synthesis declared in the namespace line_spectrum
+
+namespace {
+
+	static const int LINE_CHUNK = 256; // lines handed to a thread at a time
+	static const int GRID_BIN = 1024; // grid points per bin when the lines are sorted by position
+	static const int W_BLOCK = 256; // points per call to the array version of Faddeeva::w_re
+	static const int FFT_MIN_LINES = 16; // smallest group of lines with the same widths that synthesize_uniform convolves by FFT
+
+	void add_line(const line_spectrum::Line &L, int n, const double *x, double *k, double half, double rcore, Faddeeva::Method method)
+	{
+		// Add the line L to k at the grid points with |x - x0| < half
+		// The points with |x - x0| < rcore * sigma are evaluated through w(z), the rest by line_spectrum::lorentz_wing
+
+		int i, j, i0, i1, c0, c1, nb; 
+		double core, scl, nrm, zr[W_BLOCK], zi[W_BLOCK], wr[W_BLOCK], wi[W_BLOCK]; 
+
+		i0 = static_cast<int>(std::lower_bound(x, x + n, L.x0 - half) - x); 
+		i1 = static_cast<int>(std::lower_bound(x + i0, x + n, L.x0 + half) - x); 
+
+		if(i0 >= i1) return; 
+
+		core = L.sigma > 0.0 ? std::min(rcore * L.sigma, half) : 0.0; 
+
+		c0 = static_cast<int>(std::lower_bound(x + i0, x + i1, L.x0 - core) - x); 
+		c1 = static_cast<int>(std::lower_bound(x + c0, x + i1, L.x0 + core) - x); 
+
+		for(i=i0; i<c0; i++) k[i] += L.S * line_spectrum::lorentz_wing(x[i] - L.x0, L.sigma, L.gamma); 
+
+		for(i=c1; i<i1; i++) k[i] += L.S * line_spectrum::lorentz_wing(x[i] - L.x0, L.sigma, L.gamma); 
+
+		if(c0 < c1){
+			scl = 1.0 / (L.sigma * sqrt(2.0)); 
+			nrm = L.S * scl / sqrt(PI); 
+
+			for(j=0; j<W_BLOCK; j++) zi[j] = L.gamma * scl; 
+
+			for(i=c0; i<c1; i+=W_BLOCK){
+				nb = std::min(W_BLOCK, c1 - i); 
+
+				for(j=0; j<nb; j++) zr[j] = (x[i + j] - L.x0) * scl; 
+
+				if(method == Faddeeva::ADAPTIVE) Faddeeva::w_re(nb, zr, zi, wr); 
+				else Faddeeva::w(nb, zr, zi, wr, wi, method); 
+
+				for(j=0; j<nb; j++) k[i + j] += nrm * wr[j]; 
+			}
+		}
+	}
+}
+
+line_spectrum::Options::Options()
+{
+	// Default options
+	// A Lorentzian cut at 1000 HWHM loses 2 / (1000 pi), about 0.06%, of its area
+	cutoff = HUGE_VAL; 
+	cutoff_widths = 1000.0; 
+	wing_tol = 1.0e-8; 
+	nthreads = 0; 
+	stencil = 6; 
+	method = Faddeeva::ADAPTIVE; 
+}
+
+double line_spectrum::lorentz_wing(double dx, double sigma, double gamma)
+{
+	// Asymptotic form of the Voigt line shape for |x - x0| >> sigma, from w(z) ~ (i / sqrt(pi)) sum_{k} (2k-1)!! / (2^k z^{2k+1})
+	// with z = zeta / (sigma sqrt(2)), written in zeta = dx + i gamma so that sigma = 0 gives the Lorentzian gamma / (pi |zeta|^2)
+	// The complex arithmetic is written out in real and imaginary parts, one division per point
+
+	double d, tr, ti, qr, qi, pre, pim, t; 
+
+	// t = 1 / zeta
+	d = 1.0 / (dx * dx + gamma * gamma); 
+	tr = dx * d; ti = -gamma * d; 
+
+	// q = sigma^2 / zeta^2
+	qr = sigma * sigma * (tr * tr - ti * ti); 
+	qi = sigma * sigma * 2.0 * tr * ti; 
+
+	// P = 1 + q (1 + q (3 + 15 q))
+	pre = 3.0 + 15.0 * qr; pim = 15.0 * qi; 
+	t = qr * pre - qi * pim; pim = qr * pim + qi * pre; pre = t; 
+	pre += 1.0; 
+	t = qr * pre - qi * pim; pim = qr * pim + qi * pre; pre = t; 
+	pre += 1.0; 
+
+	// Re[i t P] / pi = -Im[t P] / pi
+	return ( -(tr * pim + ti * pre) / PI ); 
+}
+
+void line_spectrum::synthesize(int nlines, const Line *lines, int n, const double *x, double *k, const Options &opt)
+{
+	// Sum the lines on the sorted grid x[0..n-1]
+	// The lines are ordered by the bin of GRID_BIN grid points that holds their centre, by a counting sort, so that consecutive lines
+	// touch nearby parts of the grid, and are then handed out in chunks of LINE_CHUNK through an atomic counter
+	// The first thread accumulates straight into k, the others into buffers of their own that are added to k at the end
+
+	try{
+		int i, nbin, nthreads; 
+
+		if(n <= 0) return; 
+
+		for(i=1; i<n; i++){
+			if( !(x[i] >= x[i-1]) ) throw std::invalid_argument("line_spectrum::synthesize: the grid x must be sorted in increasing order\n"); 
+		}
+
+		for(i=0; i<nlines; i++){
+			if( !( lines[i].sigma >= 0.0 && lines[i].gamma >= 0.0 && lines[i].sigma + lines[i].gamma > 0.0 ) ){
+				throw std::invalid_argument("line_spectrum::synthesize: line widths must be non-negative and not both zero\n"); 
+			}
+		}
+
+		if( !(opt.cutoff > 0.0 && opt.cutoff_widths > 0.0) ) throw std::invalid_argument("line_spectrum::synthesize: cutoffs must be positive\n"); 
+
+		double rcore = opt.wing_tol > 0.0 ? pow(1000.0 / opt.wing_tol, 0.125) : HUGE_VAL; 
+
+		// counting sort of the lines by grid bin
+		nbin = (n + GRID_BIN - 1) / GRID_BIN; 
+
+		std::vector<int> bin(nlines), start(nbin + 1, 0), order(nlines); 
+
+		for(i=0; i<nlines; i++){
+			bin[i] = std::min(static_cast<int>(std::lower_bound(x, x + n, lines[i].x0) - x), n - 1) / GRID_BIN; 
+			start[bin[i] + 1]++; 
+		}
+
+		for(i=0; i<nbin; i++) start[i + 1] += start[i]; 
+
+		for(i=0; i<nlines; i++) order[start[bin[i]]++] = i; 
+
+		nthreads = opt.nthreads > 0 ? opt.nthreads : std::max(1, static_cast<int>(std::thread::hardware_concurrency())); 
+		nthreads = std::max(1, std::min(nthreads, (nlines + LINE_CHUNK - 1) / LINE_CHUNK)); 
+
+		std::fill(k, k + n, 0.0); 
+
+		std::atomic<int> next(0); 
+
+		auto worker = [&](double *buf){
+			int c, j, m; 
+			double half; 
+
+			while( (c = next.fetch_add(LINE_CHUNK)) < nlines ){
+				m = std::min(c + LINE_CHUNK, nlines); 
+
+				for(j=c; j<m; j++){
+					const Line &L = lines[order[j]]; 
+
+					half = std::min(opt.cutoff, opt.cutoff_widths * special::Voigt_hwhm(L.sigma, L.gamma)); 
+
+					add_line(L, n, x, buf, half, rcore, opt.method); 
+				}
+			}
+		}; 
+
+		if(nthreads == 1){
+			worker(k); 
+		}
+		else{
+			std::vector< std::vector<double> > bufs(nthreads - 1, std::vector<double>(n, 0.0)); 
+			std::vector<std::thread> pool; 
+
+			for(i=0; i<nthreads-1; i++) pool.push_back(std::thread(worker, bufs[i].data())); 
+
+			worker(k); 
+
+			for(i=0; i<nthreads-1; i++){
+				pool[i].join(); 
+
+				const double *b = bufs[i].data(); 
+				for(int j=0; j<n; j++) k[j] += b[j]; 
+			}
+		}
+	}
+	catch(std::invalid_argument &e){
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
+	}
+}
+
+void line_spectrum::synthesize(const std::vector<Line> &lines, const std::vector<double> &x, std::vector<double> &k, const Options &opt)
+{
+	// Sum the lines on the sorted grid x, k is resized to the length of x
+
+	k.resize(x.size()); 
+
+	synthesize(static_cast<int>(lines.size()), lines.data(), static_cast<int>(x.size()), x.data(), k.data(), opt); 
+}
+
+void line_spectrum::synthesize_uniform(int nlines, const Line *lines, double xmin, double dx, int n, double *k, const Options &opt)
+{
+	// The grid is padded by pad = stencil / 2 points at each end, to span = n + 2 pad points, so that lines up to pad points outside it
+	// can still be spread; the line shape is sampled at the offsets 0, dx, .., (span - 1) dx, which cover every distance from a stick
+	// to a grid point, and stored with its mirror image in an array of length P >= 2 span, so the circular convolution never wraps
+	// The sampled line shape has neither the frequency aliasing of the analytic transform exp(-2 pi^2 sigma^2 f^2 - 2 pi gamma |f|)
+	// truncated at the Nyquist frequency, which decays slowly for Lorentzian lines, nor the periodic images of its wings
+
+	try{
+		if( !(dx > 0.0) ) throw std::invalid_argument("line_spectrum::synthesize_uniform: dx must be positive\n"); 
+
+		if( !(opt.stencil == 4 || opt.stencil == 6 || opt.stencil == 8) ) throw std::invalid_argument("line_spectrum::synthesize_uniform: stencil must be 4, 6 or 8\n"); 
+
+		for(int i=0; i<nlines; i++){
+			if( !( lines[i].sigma >= 0.0 && lines[i].gamma >= 0.0 && lines[i].sigma + lines[i].gamma > 0.0 ) ){
+				throw std::invalid_argument("line_spectrum::synthesize_uniform: line widths must be non-negative and not both zero\n"); 
+			}
+		}
+
+		if(n <= 0) return; 
+
+		int i, j, m, g, g0, g1, i0, pad, span, P, ns; 
+		double rcore, t, u, wt; 
+		std::vector<int> order(nlines); 
+		std::vector<double> x(n); 
+
+		rcore = opt.wing_tol > 0.0 ? pow(1000.0 / opt.wing_tol, 0.125) : HUGE_VAL; 
+
+		pad = opt.stencil / 2; 
+		span = n + 2 * pad; 
+		P = fourier::next_pow2(2 * span); 
+
+		for(i=0; i<n; i++) x[i] = xmin + i * dx; 
+
+		std::fill(k, k + n, 0.0); 
+
+		// group the lines by (sigma, gamma)
+		for(i=0; i<nlines; i++) order[i] = i; 
+
+		std::sort(order.begin(), order.end(), [lines](int a, int b){
+			return lines[a].sigma < lines[b].sigma || ( lines[a].sigma == lines[b].sigma && lines[a].gamma < lines[b].gamma ); 
+		}); 
+
+		fourier::FFT fft; 
+		std::vector<double> sticks, kern, conv, offs; 
+		std::vector<int> direct; 
+
+		for(g0=0; g0<nlines; g0=g1){
+			const Line &L0 = lines[order[g0]]; 
+
+			for(g1=g0+1; g1<nlines && lines[order[g1]].sigma == L0.sigma && lines[order[g1]].gamma == L0.gamma; g1++); 
+
+			direct.clear(); 
+
+			if(g1 - g0 < FFT_MIN_LINES){
+				for(g=g0; g<g1; g++) direct.push_back(order[g]); 
+			}
+			else{
+				if(fft.size() != P){
+					fft.set_size(P); 
+					sticks.resize(P); kern.resize(P); conv.resize(P); 
+
+					offs.resize(span); 
+					for(j=0; j<span; j++) offs[j] = j * dx; 
+				}
+
+				// spread the lines onto the padded grid, sticks[j] is at xmin + (j - pad) dx
+				std::fill(sticks.begin(), sticks.end(), 0.0); 
+				ns = 0; 
+
+				for(g=g0; g<g1; g++){
+					const Line &L = lines[order[g]]; 
+
+					t = (L.x0 - xmin) / dx + pad; 
+					i0 = static_cast<int>(floor(t)) - pad + 1; 
+
+					if( !(t >= 0.0) || i0 < 0 || i0 + opt.stencil > span ){
+						direct.push_back(order[g]); 
+						continue; 
+					}
+
+					u = t - i0; 
+
+					for(m=0; m<opt.stencil; m++){
+						wt = L.S; 
+						for(j=0; j<opt.stencil; j++){
+							if(j != m) wt *= (u - j) / (m - j); 
+						}
+						sticks[i0 + m] += wt; 
+					}
+					ns++; 
+				}
+
+				if(ns > 0){
+					// line shape at the offsets 0, dx, .., (span - 1) dx and their negatives
+					Line unit; 
+					unit.x0 = 0.0; unit.S = 1.0; unit.sigma = L0.sigma; unit.gamma = L0.gamma; 
+
+					std::fill(kern.begin(), kern.end(), 0.0); 
+
+					add_line(unit, span, offs.data(), kern.data(), HUGE_VAL, rcore, opt.method); 
+
+					for(j=1; j<span; j++) kern[P - j] = kern[j]; 
+
+					fft.convolve(sticks.data(), kern.data(), conv.data()); 
+
+					for(i=0; i<n; i++) k[i] += conv[i + pad]; 
+				}
+			}
+
+			for(j=0; j<static_cast<int>(direct.size()); j++) add_line(lines[direct[j]], n, x.data(), k, HUGE_VAL, rcore, opt.method); 
+		}
+	}
+	catch(std::invalid_argument &e){
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
+	}
+}
+
+void line_spectrum::synthesize_uniform(const std::vector<Line> &lines, double xmin, double dx, int n, std::vector<double> &k, const Options &opt)
+{
+	// Sum the lines on the uniform grid x_i = xmin + i dx, i = 0, .., n-1, k is resized to n
+
+	k.resize(std::max(n, 0)); 
+
+	synthesize_uniform(static_cast<int>(lines.size()), lines.data(), xmin, dx, n, k.data(), opt); 
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#ifndef LINE_SPECTRUM_H
+#define LINE_SPECTRUM_H
+
+// Declaration of a namespace for line-by-line synthesis of spectra, sums of many Voigt lines on a common grid
+// k(x) = sum_{j} S_j special::Voigt_profile(x, x0_j, sigma_j, gamma_j)
+// Each line is evaluated only on the grid points inside its wing cutoff, which are found by binary search on the sorted grid,
+// near its centre by the array version of Faddeeva::w and in its far wings by the Lorentzian asymptotic form of the Voigt line shape
+// The lines are binned by grid position and shared out among threads in chunks, each thread accumulating into its own buffer
+// so that no two threads write to the same memory, the buffers are summed at the end
+
+namespace line_spectrum{
+
+	struct Line{
+		double x0; // line centre
+		double S; // line intensity, the area under the line
+		double sigma; // Gaussian standard deviation, e.g. from Doppler broadening
+		double gamma; // Lorentzian HWHM, e.g. from pressure broadening
+	}; 
+
+	struct Options{
+		Options(); 
+
+		double cutoff; // lines are truncated at |x - x0| >= cutoff, in the units of x
+		double cutoff_widths; // and at |x - x0| >= cutoff_widths * special::Voigt_hwhm(sigma, gamma), whichever is nearer
+		double wing_tol; // relative error allowed in the far-wing Lorentzian form, which is used for |x - x0| >= (1000 / wing_tol)^{1/8} sigma
+		int nthreads; // number of threads, <= 0 uses std::thread::hardware_concurrency()
+		int stencil; // grid points over which synthesize_uniform spreads each line centre, 4, 6 or 8
+		Faddeeva::Method method; // algorithm for w(z) near the line centres, see Faddeeva.hh
+	}; 
+
+	// k[i] = sum of the lines at the n points x[i], x must be sorted in increasing order
+	void synthesize(int nlines, const Line *lines, int n, const double *x, double *k, const Options &opt = Options()); 
+
+	void synthesize(const std::vector<Line> &lines, const std::vector<double> &x, std::vector<double> &k, const Options &opt = Options()); 
+
+	// k[i] = sum of the lines at the n points x_i = xmin + i dx of a uniform grid, by FFT convolution
+	// The lines of each group with the same (sigma, gamma) are spread onto the grid as sticks, with the weights of Lagrange
+	// interpolation over opt.stencil points, and the sum of the sticks is convolved with the line shape sampled once on the grid
+	// at a cost of O(n log n) per group, the error is O((dx / width)^stencil) and zero for lines centred on grid points,
+	// apart from FFT rounding of about 1e-16 of the largest value, which dominates the relative error far out in the wings
+	// Lines near or beyond the edges of the grid, whose stencil does not fit, and groups too small to gain from the FFT
+	// are evaluated directly as in synthesize, opt.cutoff and opt.cutoff_widths are not applied
+	void synthesize_uniform(int nlines, const Line *lines, double xmin, double dx, int n, double *k, const Options &opt = Options()); 
+
+	void synthesize_uniform(const std::vector<Line> &lines, double xmin, double dx, int n, std::vector<double> &k, const Options &opt = Options()); 
+
+	// Far-wing form of the Voigt line shape, its Lorentzian with the first three Gaussian corrections
+	// V = Re[ (i / (pi zeta)) (1 + sigma^2/zeta^2 + 3 sigma^4/zeta^4 + 15 sigma^6/zeta^6) ], zeta = x - x0 + i gamma
+	// Relative error below 1000 (sigma / |x - x0|)^8, exact for sigma = 0
+	double lorentz_wing(double dx, double sigma, double gamma); 
+}
+
+#endif
\ No newline at end of file
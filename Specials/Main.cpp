@@ -6,6 +6,11 @@ void Struve_Test();
 void Airy_Test(); 
 void Gamm_Test(); 
 void Voigt_Test(); 
+void Hypergeometric_Test(); 
+void Confluent_Test(); 
+void Acceleration_Test(); 
+void Pseudo_Voigt_Test(); 
+void Chebyshev_Fit_Test(); 
 
 int main(int argc, char *argv[])
 {
@@ -13,6 +18,16 @@ int main(int argc, char *argv[])
 
 	//Airy_Test(); 
 
+	//Hypergeometric_Test(); 
+
+	//Confluent_Test(); 
+
+	//Acceleration_Test(); 
+
+	//Pseudo_Voigt_Test(); 
+
+	//Chebyshev_Fit_Test(); 
+
 	Voigt_Test(); 
 
 	std::cout<<"Press enter to close\n"; 
@@ -259,4 +274,206 @@ void Voigt_Test()
 
 		write.close();
 	}
+}
+
+void Hypergeometric_Test()
+{
+	// Values of 2F1(a, b; c; x) over the real line
+	// Compare with K(k) = (pi/2) 2F1(1/2, 1/2; 1; k) and 2F1(1, 1; 2; x) = -ln(1-x)/x, A&S 15.1.3
+	// For x > 1 the real part is returned, Re[-ln(1-x)/x] = -ln(x-1)/x
+
+	double x, F, dF; 
+
+	x = -10.0; 
+
+	while(x < 10.05){
+		special::two_F_one(1.0, 1.0, 2.0, x, F, dF); 
+		std::cout << x << " , " << F << " , " << ( x == 0.0 ? 1.0 : ( x == 1.0 ? HUGE_VAL : -log(fabs(1.0 - x))/x ) ) << " , " << dF << "\n"; 
+		x += 0.5; 
+	}
+
+	std::cout << "\n"; 
+	std::cout << "K(0.999999) = " << std::setprecision(15) << special::Ell_K(0.999999) << "\n"; 
+	std::cout << "E(0.999999) = " << std::setprecision(15) << special::Ell_E(0.999999) << "\n"; 
+}
+
+void Confluent_Test()
+{
+	// Values of M(a, b, x) and U(a, b, x) on a grid of x at fixed (a, b)
+	// Compare with M(1, 2, x) = (e^{x} - 1) / x and U(a, a+1, x) = x^{-a}, A&S 13.6.14 and 13.6.28
+
+	const int n = 21; 
+	double x[n], M[n], U[n]; 
+
+	for(int i=0; i<n; i++) x[i] = -10.0 + i; 
+
+	special::ConfluentHypergeometric Mfun(1.0, 2.0); 
+	Mfun.M(n, x, M); 
+
+	for(int i=0; i<n; i++){
+		std::cout << x[i] << " , " << M[i] << " , " << ( x[i] == 0.0 ? 1.0 : expm1(x[i])/x[i] ) << "\n"; 
+	}
+
+	std::cout << "\n"; 
+
+	for(int i=0; i<n; i++) x[i] = 0.5*(i+1); 
+
+	special::ConfluentHypergeometric Ufun(2.5, 3.5); 
+	Ufun.U(n, x, U); 
+
+	for(int i=0; i<n; i++){
+		std::cout << x[i] << " , " << U[i] << " , " << pow(x[i], -2.5) << "\n"; 
+	}
+
+	std::cout << "\n"; 
+
+	// Points where U has b >> a and where the series for M cancels, against mpmath at 30 digits
+	const int nref = 4; 
+	const bool isU[nref] = {true, true, true, false}; 
+	const double ra[nref] = {5.0, 6.0, 4.0, 30.0}; 
+	const double rb[nref] = {21.37, 24.1, 18.5, 6.0}; 
+	const double rx[nref] = {1.566, 0.2, 0.8, -68.0}; 
+	const double ref[nref] = {5.6306552980072818e12, 2.0904792443121299e35, 1.3593304114015299e15, -7.8477126273220641e-23}; 
+
+	for(int i=0; i<nref; i++){
+		double val = ( isU[i] ? special::tricomi_U(ra[i], rb[i], rx[i]) : special::one_F_one(ra[i], rb[i], rx[i]) ); 
+		std::cout << ( isU[i] ? "U(" : "M(" ) << ra[i] << ", " << rb[i] << ", " << rx[i] << ") = " << std::setprecision(17) << val << " , " << ref[i] << " , " << std::setprecision(3) << fabs(val/ref[i] - 1.0) << std::setprecision(6) << "\n"; 
+	}
+}
+
+void Acceleration_Test()
+{
+	// Iteration counts of the routines whose slow regions are extrapolated by the transformations in series_accel
+	// Each count is printed next to the count of the same routine with accelerate = false, the plain method
+	// Q(a, x) is computed near the switch x = a + 1, where its continued fraction converges most slowly, I_x(a, b) near its mean
+
+	int n, n0; 
+	double a, x, q, q0, gln, F, F0, s, c, s0, c0; 
+
+	a = 10.0; 
+	while(a < 1.0e6 + 1.0){
+		x = a + 1.0; 
+		probability::gcf(&q, a, x, &gln, &n); 
+		probability::gcf(&q0, a, x, &gln, &n0, false); 
+		std::cout << "Q(" << a << ", " << x << ") = " << q << ", iterations = " << n << ", unaccelerated " << q0 << ", iterations = " << n0 << "\n"; 
+		a *= 10.0; 
+	}
+
+	std::cout << "\n"; 
+	a = 10.0; 
+	while(a < 1.0e5 + 1.0){
+		q = probability::betacf(a, a, 0.5, &n); 
+		q0 = probability::betacf(a, a, 0.5, &n0, false); 
+		std::cout << "betacf(" << a << ", " << a << ", 0.5) = " << q << ", iterations = " << n << ", unaccelerated " << q0 << ", iterations = " << n0 << "\n"; 
+		a *= 10.0; 
+	}
+
+	std::cout << "\n"; 
+	x = 0.05; 
+	while(x < 2.0){
+		q = probability::probks(x, &n); 
+		q0 = probability::probks(x, &n0, false); 
+		std::cout << "Q_KS(" << x << ") = " << q << ", terms = " << n << ", alternating series " << q0 << ", terms = " << n0 << "\n"; 
+		x *= 2.0; 
+	}
+
+	std::cout << "\n"; 
+	x = 1.51; 
+	while(x < 2.5){
+		special::fresnel(x, &s, &c, &n); 
+		special::fresnel(x, &s0, &c0, &n0, false); 
+		std::cout << "S(" << x << ") = " << s << ", C(" << x << ") = " << c << ", iterations = " << n << ", unaccelerated " << s0 << ", " << c0 << ", iterations = " << n0 << "\n"; 
+		x += 0.25; 
+	}
+
+	std::cout << "\n"; 
+	F = special::two_F_one_series(11.0, 20.4, 6.9, -0.4, n); 
+	F0 = special::two_F_one_series(11.0, 20.4, 6.9, -0.4, n0, false); 
+	std::cout << "2F1(11, 20.4; 6.9; -0.4) = " << F << ", terms = " << n << ", unaccelerated " << F0 << ", terms = " << n0 << "\n"; 
+}
+
+void Pseudo_Voigt_Test()
+{
+	// Speed and accuracy of the pseudo-Voigt against the exact Voigt line shape, for gamma / sigma = 10^{-3}, .., 10^{3}
+	// The deviation is the largest |pV(x) - V(x)| over |x - x0| <= 50 HWHM, relative to the peak value V(x0)
+	// The exact line shape is timed both point by point and through its array version, which uses the SIMD Faddeeva::w
+
+	const int n = 1 << 16; 
+	const int nrep = 20; 
+
+	int i, r; 
+	double sigma, gamma, hw, dev, peak, t_scalar, t_exact, t_pseudo; 
+	std::vector<double> x(n), V(n), pV(n); 
+
+	sigma = 1.0; 
+
+	std::cout << "gamma / sigma , max deviation / peak , exact ns / point , exact array ns / point , pseudo-Voigt array ns / point\n"; 
+
+	for(double lg = -3.0; lg < 3.05; lg += 0.5){
+		gamma = sigma * pow(10.0, lg); 
+		hw = special::Voigt_hwhm(sigma, gamma); 
+
+		for(i=0; i<n; i++) x[i] = -50.0 * hw + 100.0 * hw * i / (n - 1); 
+
+		auto t0 = std::chrono::steady_clock::now(); 
+		for(i=0; i<n; i++) V[i] = special::Voigt_profile(x[i], 0.0, sigma, gamma); 
+		auto t1 = std::chrono::steady_clock::now(); 
+		for(r=0; r<nrep; r++) special::Voigt_profile(n, x.data(), 0.0, sigma, gamma, V.data()); 
+		auto t2 = std::chrono::steady_clock::now(); 
+		for(r=0; r<nrep; r++) special::pseudo_Voigt_profile(n, x.data(), 0.0, sigma, gamma, pV.data()); 
+		auto t3 = std::chrono::steady_clock::now(); 
+
+		t_scalar = std::chrono::duration<double, std::nano>(t1 - t0).count() / n; 
+		t_exact = std::chrono::duration<double, std::nano>(t2 - t1).count() / (static_cast<double>(n) * nrep); 
+		t_pseudo = std::chrono::duration<double, std::nano>(t3 - t2).count() / (static_cast<double>(n) * nrep); 
+
+		peak = special::Voigt_profile(0.0, 0.0, sigma, gamma); 
+
+		dev = 0.0; 
+		for(i=0; i<n; i++) dev = std::max(dev, fabs(pV[i] - V[i])); 
+
+		std::cout << gamma / sigma << " , " << dev / peak << " , " << t_scalar << " , " << t_exact << " , " << t_pseudo << "\n"; 
+	}
+}
+
+void Chebyshev_Fit_Test()
+{
+	// Speed and accuracy of cheb_appr::chebft, which sums the coefficients by fourier::DCT, against the direct O(n^2) sums
+	// of cos(pi j (k + 1/2) / n) that it used before, for f(x) = exp(x) sin(3x) + 1 / (1.5 + x) on [-1, 1]
+	// The difference is the largest |c_j| difference relative to max |c_j|, most of it the error of the direct sums,
+	// whose cosine arguments lose accuracy as j (k + 1/2) grows
+
+	int ns[] = {30, 50, 100, 500, 1000, 1024, 3000, 4096, 10000}; 
+
+	std::cout << "n , direct us , DCT us , speedup , max difference\n"; 
+
+	for(int n : ns){
+		int j, k; 
+		double diff, cmax, t_direct, t_dct; 
+		std::vector<double> f(n), c_direct(n), c_dct(n); 
+
+		auto func = [](double x){ return exp(x) * sin(3.0 * x) + 1.0 / (1.5 + x); }; 
+
+		auto t0 = std::chrono::steady_clock::now(); 
+		for(k=0; k<n; k++) f[k] = func(cos(PI * (k + 0.5) / n)); 
+		for(j=0; j<n; j++){
+			double sum = 0.0; 
+			for(k=0; k<n; k++) sum += f[k] * cos(PI * j * (k + 0.5) / n); 
+			c_direct[j] = 2.0 * sum / n; 
+		}
+		auto t1 = std::chrono::steady_clock::now(); 
+		cheb_appr::chebft(-1.0, 1.0, c_dct.data(), n, func); 
+		auto t2 = std::chrono::steady_clock::now(); 
+
+		t_direct = std::chrono::duration<double, std::micro>(t1 - t0).count(); 
+		t_dct = std::chrono::duration<double, std::micro>(t2 - t1).count(); 
+
+		diff = cmax = 0.0; 
+		for(j=0; j<n; j++){
+			diff = std::max(diff, fabs(c_dct[j] - c_direct[j])); 
+			cmax = std::max(cmax, fabs(c_direct[j])); 
+		}
+
+		std::cout << n << " , " << t_direct << " , " << t_dct << " , " << t_direct / t_dct << " , " << diff / cmax << "\n"; 
+	}
 }
\ No newline at end of file
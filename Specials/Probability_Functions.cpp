@@ -8,22 +8,29 @@
 double probability::gammln(double xx)
 {
 	// Return the value of ln[gamma(xx)] for xx>0
+	// Lanczos approximation with g = 607/128 and 14 coefficients, see NRinC 3rd ed., sect. 6.1
+	// Relative error is close to double precision, the 6 term approximation used previously was only good to about 2e-10
+	// which limited the accuracy of every function that is normalised through a ratio of gamma functions
 
 	try{
 		if(xx > 0.0){
-			double x,tmp,ser;
-			static double cof[6]={76.18009173,-86.50532033,24.01409822,-1.231739516,0.120858003e-2,-0.536382e-5};
 			int j;
-
-			x=xx-1.0;
-			tmp=x+5.5;
-			tmp-=(x+0.5)*log(tmp);
-			ser=1.0;
-			for (j=0;j<=5;j++){
-				x+=1.0;
-				ser+=(cof[j]/x);
+			double x,tmp,y,ser;
+			static const double cof[14]={57.1562356658629235,-59.5979603554754912,
+				14.1360979747417471,-0.491913816097620199,0.339946499848118887e-4,
+				0.465236289270485756e-4,-0.983744753048795646e-4,0.158088703224912494e-3,
+				-0.210264441724104883e-3,0.217439618115212643e-3,-0.164318106536763890e-3,
+				0.844182239838527433e-4,-0.261908384015814087e-4,0.368991826595316234e-5};
+
+			y=x=xx;
+			tmp=x+5.24218750000000000;
+			tmp=(x+0.5)*log(tmp)-tmp;
+			ser=0.999999999999997092;
+			for (j=0;j<14;j++){
+				y+=1.0;
+				ser+=(cof[j]/y);
 			}
-			return -tmp+log(2.50662827465*ser);		
+			return tmp+log(2.5066282746310005*ser/x);		
 		}
 		else{
 			std::string reason; 
@@ -38,6 +45,112 @@ double probability::gammln(double xx)
 	}
 }
 
+double probability::gammf(double x)
+{
+	// Return the value of gamma(x) for all real x that are not non-positive integers
+	// For x >= 1/2 the Lanczos approximation with g = 607/128 and 14 coefficients is used, see NRinC 3rd ed., sect. 6.1
+	// this gives close to full double precision, which is needed by the analytic continuation formulae of the hypergeometric functions
+	// For x < 1/2 the reflection formula gamma(x) gamma(1-x) = pi / sin(pi x) is used
+	// gamma(x) overflows for x > 171.6
+
+	try{
+		if( !(x <= 0.0 && useful_funcs::is_integer(x)) ){
+			if(x < 0.5){
+				return PI / ( useful_funcs::sinpi(x) * gammf(1.0 - x) ); 
+			}
+			else{
+				static const double cof[14]={57.1562356658629235,-59.5979603554754912,
+					14.1360979747417471,-0.491913816097620199,0.339946499848118887e-4,
+					0.465236289270485756e-4,-0.983744753048795646e-4,0.158088703224912494e-3,
+					-0.210264441724104883e-3,0.217439618115212643e-3,-0.164318106536763890e-3,
+					0.844182239838527433e-4,-0.261908384015814087e-4,0.368991826595316234e-5};
+				int j;
+				double y,tmp,ser;
+
+				y=x;
+				tmp=x+5.24218750000000000; // g + 1/2
+				ser=0.999999999999997092;
+				for (j=0;j<14;j++){
+					y+=1.0;
+					ser+=(cof[j]/y);
+				}
+				// gamma(x) = (x+g+1/2)^{x+1/2} exp(-(x+g+1/2)) sqrt(2 pi) ser / x
+				// the power is split in two to postpone overflow
+				tmp = pow(tmp, 0.5*(x+0.5)); 
+				return ( tmp * ( tmp * exp(-(x+5.24218750000000000)) ) ) * (2.5066282746310005*ser/x); 
+			}
+		}
+		else{
+			std::string reason; 
+			reason = "Error: double probability::gammf(double x)\n"; 
+			reason += "gamma(x) has a pole at x = " + template_funcs::toString(x, 2) + "\n"; 
+			throw std::invalid_argument(reason); 
+		}
+	}
+	catch(std::invalid_argument &e){
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
+	}
+}
+
+double probability::rgamma(double x)
+{
+	// Return the value of 1/gamma(x) for all real x
+	// 1/gamma(x) is entire, it is zero at x = 0, -1, -2, ...
+	// this is the form in which gamma(x) appears in the denominators of the hypergeometric connection formulae
+
+	if(x <= 0.0 && useful_funcs::is_integer(x)){
+		return 0.0; 
+	}
+	else if(x > 171.0){
+		return exp(-gammln(x)); // gamma(x) overflows but its reciprocal does not
+	}
+	else{
+		return 1.0 / gammf(x); 
+	}
+}
+
+double probability::digamma(double x)
+{
+	// Return the value of the digamma function psi(x) = gamma'(x) / gamma(x) for all real x that are not non-positive integers
+	// For x < 0 the reflection formula psi(1-x) - psi(x) = pi cot(pi x) is used
+	// For 0 < x < 10 the recurrence psi(x+1) = psi(x) + 1/x is used to shift the argument up to x >= 10
+	// For x >= 10 the asymptotic expansion psi(x) = ln(x) - 1/(2x) - sum_{k} B_{2k} / (2k x^{2k}) is used, see Abramowitz and Stegun, 6.3.18
+
+	try{
+		if( !(x <= 0.0 && useful_funcs::is_integer(x)) ){
+			if(x < 0.0){
+				return digamma(1.0 - x) - PI * useful_funcs::cospi(x) / useful_funcs::sinpi(x); 
+			}
+			else{
+				double sum = 0.0, xi, xi2; 
+
+				while(x < 10.0){
+					sum -= 1.0/x; 
+					x += 1.0; 
+				}
+
+				xi = 1.0/x; xi2 = xi*xi; 
+
+				// Bernoulli number coefficients B_{2k}/(2k) for k = 1, ..., 7
+				sum += log(x) - 0.5*xi - xi2*(1.0/12.0 - xi2*(1.0/120.0 - xi2*(1.0/252.0 - xi2*(1.0/240.0 - xi2*(1.0/132.0 - xi2*(691.0/32760.0 - xi2/12.0)))))); 
+
+				return sum; 
+			}
+		}
+		else{
+			std::string reason; 
+			reason = "Error: double probability::digamma(double x)\n"; 
+			reason += "psi(x) has a pole at x = " + template_funcs::toString(x, 2) + "\n"; 
+			throw std::invalid_argument(reason); 
+		}
+	}
+	catch(std::invalid_argument &e){
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
+	}
+}
+
 double probability::gammp(double a,double x)
 {
 	// Computes the incomplete gamma function P(a,x) from the functions gser and gcf
@@ -149,45 +262,54 @@ void probability::gser(double *gamser,double a,double x,double *gln)
 	}
 }
 
-void probability::gcf(double *gammcf, double a, double x, double *gln)
+void probability::gcf(double *gammcf, double a, double x, double *gln, int *nits, bool accelerate)
 {
 	// This function returns the incomplete gamma function Q(a,x), calculated by its continued fraction representation
 	// Also returns ln[gamma(a)] as gln
+	// The continued fraction is evaluated by the modified Lentz method, NRinC sect. 6.2
+	// Convergence is slow for large a near the switch at x = a + 1, there the convergents are extrapolated by Wynn's epsilon algorithm
+	// The number of iterations used is returned in nits, accelerate = false runs the plain Lentz method for comparison
 
 	try{
 		if(x > 0.0 && a > 0.0){
-			int n;
-			double gold=0.0,g,fac=1.0,b1=1.0;
-			double b0=0.0,anf,ana,an,a1,a0=1.0;
+			int i;
+			double an,b,c,d,del,h,val;
 
-			static const int ITMAX=(100);
+			static const int ITMAX=(1000);
+			static const int NACC=(10); // the epsilon algorithm is started after NACC iterations
 			static const double EPS=(3.0e-7);
 
+			series_accel::EpsilonAlgorithm<double> acc(EPS);
+
 			*gln=gammln(a);
-			a1=x;
-			for(n=1;n<=ITMAX;n++){
-				an=static_cast<double>(n);
-				ana=an-a;
-				a0=(a1+a0*ana)*fac;
-				b0=(b1+b0*ana)*fac;
-				anf=an*fac;
-				a1=x*a0+anf*a1;
-				b1=x*b0+anf*b1;
-				if(a1){
-					fac=1.0/a1;
-					g=b1*fac;
-					if(fabs((g-gold)/g)<EPS){
-						*gammcf=exp(-x+a*log(x)-(*gln))*g;
-						return;
-					}
-					gold=g;
+			b=x+1.0-a;
+			c=1.0/FPMIN;
+			d=1.0/b;
+			h=val=d;
+			for(i=1;i<=ITMAX;i++){
+				an = -i*(i-a);
+				b += 2.0;
+				d=an*d+b;
+				if(fabs(d)<FPMIN) d=FPMIN;
+				c=b+an/c;
+				if(fabs(c)<FPMIN) c=FPMIN;
+				d=1.0/d;
+				del=d*c;
+				h *= del;
+				val=h;
+				if(fabs(del-1.0)<EPS) break;
+				if(accelerate && i>=NACC){
+					val=acc.next(h);
+					if(acc.converged()) break;
 				}
 			}
-			std::cerr<<"a too large, ITMAX too small in routine GCF"<<"\n";
+			if(i>ITMAX) std::cerr<<"a too large, ITMAX too small in routine GCF"<<"\n";
+			if(nits != nullptr) *nits = std::min(i, ITMAX);
+			*gammcf=exp(-x+a*log(x)-(*gln))*val;
 		}
 		else{
 			std::string reason; 
-			reason = "Error: void probability::gcf(double *gammcf, double a, double x, double *gln)\n"; 
+			reason = "Error: void probability::gcf(double *gammcf, double a, double x, double *gln, int *nits, bool accelerate)\n"; 
 			if(x < 0.0) reason += "x input with value = " + template_funcs::toString(x, 2) + "\n"; 
 			if(a <= 0.0) reason += "a input with value = " + template_funcs::toString(a, 2) + "\n"; 
 			throw std::invalid_argument(reason); 
@@ -298,17 +420,23 @@ double probability::bico(int n, int k)
 	}
 }
 
-double probability::betacf(double a, double b, double x)
+double probability::betacf(double a, double b, double x, int *nits, bool accelerate)
 {
 	// Evaluation of continued fraction expansion for incomplete beta function
 	// NRinC equation 6.4.5, 6.4.6
+	// For large a and b the number of iterations grows like sqrt(max(a, b)), after NACC iterations the convergents
+	// are extrapolated by Wynn's epsilon algorithm
+	// The number of iterations used is returned in nits, accelerate = false runs the plain Lentz method for comparison
 
 	try{
 		int m,m2;
-		int MAXIT = 100; 
+		int MAXIT = 1000; 
+		static const int NACC = 10; 
 		double EPS1 = 3.0E-7; 
 		static const double FPMIN=(1.0e-30);
-		double aa,c,d,del,h,qab,qam,qap;
+		double aa,c,d,del,h,qab,qam,qap,val;
+
+		series_accel::EpsilonAlgorithm<double> acc(EPS1); 
 
 		qab=a+b;
 		qap=a+1.0;
@@ -317,7 +445,7 @@ double probability::betacf(double a, double b, double x)
 		d=1.0-qab*x/qap;
 		if (fabs(d) < FPMIN) d=FPMIN;
 		d=1.0/d;
-		h=d;
+		h=val=d;
 		for (m=1;m<=MAXIT;m++) {
 			m2=2*m;
 			aa=m*(b-m)*x/((qam+m2)*(a+m2));
@@ -335,14 +463,20 @@ double probability::betacf(double a, double b, double x)
 			d=1.0/d;
 			del=d*c;
 			h *= del;
+			val=h;
 			if (fabs(del-1.0) < EPS1) break;
+			if (accelerate && m >= NACC){
+				val=acc.next(h);
+				if (acc.converged()) break;
+			}
 		}
+		if(nits != nullptr) *nits = std::min(m, MAXIT); 
 		if (m > MAXIT){
 			std::string reason; 
 			reason = "Error: probability::betacf()\na or b too big, or MAXIT too small in betacf\n"; 
 			throw std::runtime_error(reason); 
 		}
-		return h;
+		return val;
 	}
 	catch(std::runtime_error &e){
 		std::cerr<<e.what(); 
@@ -386,33 +520,59 @@ double probability::betai(double a, double b, double x)
 	}
 }
 
-double probability::probks(double alam)
+double probability::probks(double alam, int *nterms, bool accelerate)
 {
 	// Kolmorgorov-Smirnov Probability Function
+	// Q_{KS}(alam) = 2 \sum_{j=1}^{\infty} (-1)^{j-1} exp(-2 j^{2} alam^{2}), NRinC eq. 14.3.7
+	// The alternating series needs O(1/alam) terms as alam -> 0, where it also suffers from cancellation as Q_{KS} -> 1
+	// For alam < 1.18 it is replaced by its Jacobi theta function transformation, NRinC 3rd ed. eq. 6.14.56
+	// Q_{KS}(alam) = 1 - ( sqrt(2 pi) / alam ) \sum_{j=1}^{\infty} exp( -(2j-1)^{2} pi^{2} / (8 alam^{2}) )
+	// Either series then reaches full precision in at most four terms
+	// The number of terms used is returned in nterms, accelerate = false sums the alternating series at every alam for comparison
 
 	try{
 
 		if(alam < 0.0){
 			std::string reason; 
-			reason = "Error: double probability::probks(double alam)\n"; 
+			reason = "Error: double probability::probks(double alam, int *nterms, bool accelerate)\n"; 
 			reason += "alam = " + template_funcs::toString(alam) + " < 0\n"; 
 			throw std::invalid_argument(reason); 
 		}
 		else{
-			int j;
-			static const double EPS1 = 0.001; 
-			static const double EPS2 = 1.0e-8; 
-			double a2,fac=2.0,sum=0.0,term,termbf=0.0;
-
-			a2 = -2.0*alam*alam;
-			for (j=1;j<=100;j++) {
-				term=fac*exp(a2*j*j);
-				sum += term;
-				if (fabs(term) <= EPS1*termbf || fabs(term) <= EPS2*sum) return sum;
-				fac = -fac;
-				termbf=fabs(term);
+			int j, nmax; 
+			static const int NMAX = 10; 
+			static const int NMAX_ALT = 100; // terms of the alternating series allowed when it is summed below ALAM_SWITCH
+			static const double ALAM_SWITCH = 1.18; 
+			static const double SQRT_2PI = 2.50662827463100050242; 
+			double sum=0.0,term,y;
+
+			nmax = NMAX; 
+			if(alam == 0.0){
+				j = 0; 
+				sum = 1.0; 
 			}
-			return 1.0;
+			else if(accelerate && alam < ALAM_SWITCH){
+				y = -PI*PI/(8.0*alam*alam); 
+				for (j=1;j<=NMAX;j++) {
+					term=exp(y*(2*j-1)*(2*j-1));
+					sum += term;
+					if (term <= EPS*sum) break;
+				}
+				sum = 1.0 - (SQRT_2PI/alam)*sum; 
+			}
+			else{
+				double fac = 2.0; 
+				y = -2.0*alam*alam; 
+				nmax = ( alam < ALAM_SWITCH ? NMAX_ALT : NMAX ); 
+				for (j=1;j<=nmax;j++) {
+					term=fac*exp(y*j*j);
+					sum += term;
+					if (fabs(term) <= EPS*sum) break;
+					fac = -fac;
+				}
+			}
+			if(nterms != nullptr) *nterms = std::min(j, nmax); 
+			return sum;
 		}	
 	}
 	catch(std::invalid_argument &e){
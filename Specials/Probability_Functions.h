@@ -8,13 +8,16 @@ namespace probability{
 
 	// Gamma Function
 	double gammln(double x); // Computes the value of ln[gamma(xx)] for xx>0
+	double gammf(double x); // Computes gamma(x) for all real x that are not non-positive integers
+	double rgamma(double x); // Computes 1/gamma(x) for all real x, equal to zero at the poles of gamma(x)
+	double digamma(double x); // Computes psi(x) = d ln[gamma(x)] / dx for all real x that are not non-positive integers
 
 	// Incomplete Gamma Function
 	double gammp(double a, double x); // Computes the incomplete gamma function P(a,x) from the functions gser and gcf
 	double gammq(double a, double x); // Computes the incomplete gamma function Q(a,x)=1-P(a,x) from the functions gser and gcf
 
 	void gser(double *gamser,double a,double x,double *gln); // Computes the incomplete gamma function P(a,x), calculated by its series representation
-	void gcf(double *gammcf,double a,double x,double *gln); // Computes the incomplete gamma function Q(a,x), calculated by its continued fraction representation
+	void gcf(double *gammcf,double a,double x,double *gln, int *nits = nullptr, bool accelerate = true); // Computes the incomplete gamma function Q(a,x), calculated by its continued fraction representation, accelerate = false for comparison
 	
 	// Error Function
 	double erff(double x); // erf(x)
@@ -28,11 +31,11 @@ namespace probability{
 	double bico(int n, int m);
 
 	// Incomplete Beta Function
-	double betacf(double a, double b, double x);
+	double betacf(double a, double b, double x, int *nits = nullptr, bool accelerate = true); // nits returns the number of iterations used, accelerate = false for comparison
 	double betai(double a, double b, double x); 
 
 	// Kolmorgorov Smirnov Probability Function
-	double probks(double alam);
+	double probks(double alam, int *nterms = nullptr, bool accelerate = true); // nterms returns the number of terms summed, accelerate = false for comparison
 
 	// Bernoulli Numbers
 	double berno(int n);
@@ -0,0 +1,167 @@
+#ifndef SERIES_ACCELERATION_H
+#define SERIES_ACCELERATION_H
+
+// Declaration of a namespace for sequence transformations that accelerate the convergence of series and continued fractions
+// Each transformation is fed the terms, partial sums or convergents of a sequence one at a time through next() and returns
+// its current estimate of the limit, converged() is set once successive estimates agree to within tol
+// The transformations are templates so that they can be used with double or std::complex<double>
+// See NRinC 3rd ed., sect. 5.3 and Weniger, Comput. Phys. Rep., 10, 189, 1989
+
+namespace series_accel{
+
+	// Wynn's epsilon algorithm, next() is passed the partial sums s_{n}
+	// Sums geometrically converging or alternating series and the convergents of continued fractions
+	template <class T> class EpsilonAlgorithm{
+	public:
+		EpsilonAlgorithm(double tol = 10.0*EPS); 
+
+		void reset(); 
+
+		T next(T sum); 
+
+		bool converged() const { return cnvgd; }
+		int terms() const { return n; } // number of partial sums consumed
+		double error() const { return lasteps; } // difference between the last two estimates
+
+	private:
+		int n, ncv; 
+		bool cnvgd; 
+		double eps, lasteps; 
+		T lastval; 
+		std::vector<T> e; 
+	}; 
+
+	// Levin's transformation, next() is passed the partial sum s_{n} and the remainder estimate omega_{n}
+	// omega_{n} = (beta + n) a_{n} gives the u transformation, omega_{n} = a_{n} the t transformation, a_{n} being the last term in s_{n}
+	// The u transformation is the best general purpose choice for alternating series, it is exact for geometric series
+	template <class T> class LevinTransform{
+	public:
+		LevinTransform(double tol = 10.0*EPS, double beta = 1.0); 
+
+		void reset(); 
+
+		T next(T sum, T omega); 
+
+		bool converged() const { return cnvgd; }
+		int terms() const { return n; }
+		double error() const { return lasteps; }
+
+	private:
+		int n, ncv; 
+		bool cnvgd; 
+		double eps, lasteps, bet; 
+		T lastval; 
+		std::vector<T> numer, denom; 
+	}; 
+
+	// Definitions
+
+	template <class T> EpsilonAlgorithm<T>::EpsilonAlgorithm(double tol)
+	{
+		eps = tol; 
+		reset(); 
+	}
+
+	template <class T> void EpsilonAlgorithm<T>::reset()
+	{
+		n = ncv = 0; 
+		cnvgd = false; 
+		lasteps = 0.0; 
+		lastval = T(0); 
+		e.clear(); 
+	}
+
+	template <class T> T EpsilonAlgorithm<T>::next(T sum)
+	{
+		// The table e_{k}^{(n)} is stored as its last ascending diagonal, e[j] = e_{n-j}^{(j)}
+		// e_{k+1}^{(n)} = e_{k-1}^{(n+1)} + 1 / ( e_{k}^{(n+1)} - e_{k}^{(n)} ), the even columns approximate the limit
+		// A vanishing difference means the sequence has already converged, the entry is set to a large value so that its
+		// reciprocal drops out of the next column
+
+		static const double BIG = 1.0e300; 
+
+		T diff, temp1, temp2, val; 
+
+		e.push_back(sum); 
+		temp2 = T(0); 
+		for(int j=n; j>0; j--){
+			temp1 = temp2; 
+			temp2 = e[j-1]; 
+			diff = e[j] - temp2; 
+			if(std::abs(diff) <= FPMIN){
+				e[j-1] = T(BIG); 
+			}
+			else{
+				e[j-1] = temp1 + T(1) / diff; 
+			}
+		}
+		n++; 
+
+		val = ( n & 1 ? e[0] : e[1] ); 
+		if(std::abs(val) > 0.01*BIG) val = lastval; 
+
+		lasteps = std::abs(val - lastval); 
+		if(lasteps > eps*std::abs(val)){
+			ncv = 0; 
+		}
+		else{
+			ncv++; 
+		}
+		if(ncv >= 3) cnvgd = true; 
+
+		return ( lastval = val ); 
+	}
+
+	template <class T> LevinTransform<T>::LevinTransform(double tol, double beta)
+	{
+		eps = tol; bet = beta; 
+		reset(); 
+	}
+
+	template <class T> void LevinTransform<T>::reset()
+	{
+		n = ncv = 0; 
+		cnvgd = false; 
+		lasteps = 0.0; 
+		lastval = T(0); 
+		numer.clear(); denom.clear(); 
+	}
+
+	template <class T> T LevinTransform<T>::next(T sum, T omega)
+	{
+		// Numerator and denominator of the Levin transformation are built up by the recurrence of Fessler, Ford and Smith
+		// NRinC 3rd ed. eq. 5.3.17, the estimate is numer[0] / denom[0]
+
+		double fact, ratio, term; 
+		T val; 
+
+		term = 1.0 / ( bet + n ); 
+		denom.push_back( T(1) / omega ); 
+		numer.push_back( sum * denom[n] ); 
+		if(n > 0){
+			ratio = ( bet + n - 1 ) * term; 
+			for(int j=1; j<=n; j++){
+				fact = ( n - j + bet ) * term; 
+				numer[n-j] = numer[n-j+1] - fact*numer[n-j]; 
+				denom[n-j] = denom[n-j+1] - fact*denom[n-j]; 
+				term *= ratio; 
+			}
+		}
+		n++; 
+
+		val = ( std::abs(denom[0]) < FPMIN ? lastval : numer[0] / denom[0] ); 
+
+		lasteps = std::abs(val - lastval); 
+		if(lasteps > eps*std::abs(val)){
+			ncv = 0; 
+		}
+		else{
+			ncv++; 
+		}
+		if(ncv >= 2) cnvgd = true; 
+
+		return ( lastval = val ); 
+	}
+}
+
+#endif
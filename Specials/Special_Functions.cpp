@@ -8,7 +8,7 @@
 void special::two_F_one(double a, double b, double c, double x, double &F, double &dF)
 {
 	// Implementation of the hypergeometric function, {2}_F_{1}(a, b, c; z)
-	// This series is valid for |x| < 1, with rapid convergence when |x| <= 1/2
+	// The power series is valid for |x| < 1, with rapid convergence when |x| <= 1/2
 	// Series is divergent when (c - a - b) <= -1
 	// Series is absolutely convergent when (c - a - b) > 0
 	// Series is conditionally convergent when -1 < (c - a - b) < 0 and x = 1 is excluded
@@ -19,431 +19,1963 @@ void special::two_F_one(double a, double b, double c, double x, double &F, doubl
 	// An implementation involving std::complex arguments is also possible
 	// R. Sheehan 15 - 4 - 2014
 
-	if(fabs(x) < 1.0){
+	// For |x| > 1/2 the series is replaced by one of the linear transformations x -> 1 - x, x -> 1 / x, x -> x / (x - 1)
+	// so that every series that is summed has argument of modulus <= 1/2 (<= 2/3 in one doubly degenerate case)
+	// The derivative uses dF/dx = (a b / c) 2F1(a+1, b+1; c+1; x)
+	// For x > 1 the function is evaluated on its branch cut, F(x + i0) and F(x - i0) are complex conjugates
+	// so the real part returned here is the same on either side of the cut
 
-		int i, nterms; 
-		double fac, temp, aa, bb, cc;
+	try{
+		bool c_pole = ( c <= 0.0 && useful_funcs::is_integer(c) ); 
+		bool a_term = ( a <= 0.0 && useful_funcs::is_integer(a) && a > c ); // series terminates before the pole in c
+		bool b_term = ( b <= 0.0 && useful_funcs::is_integer(b) && b > c ); 
 
-		F = dF = 0.0; 
-		fac = 1.0; temp = fac;
-		aa = a; bb = b; cc = c; 
+		if( !c_pole || a_term || b_term ){
 
-		nterms = 1000; // compute the partial sum out to nterms
+			if(fabs(x) <= 0.5){
 
-		for(i=1; i<=nterms; i++){
+				// sum F and dF together
+				int i, nterms; 
+				double fac, aa, bb, cc;
+		
+				F = 1.0; dF = 0.0; 
+				fac = 1.0; 
+				aa = a; bb = b; cc = c; 
+		
+				nterms = 1000; 
+		
+				for(i=1; i<=nterms; i++){
 		
-			fac *= ((aa*bb)/cc); 
+					fac *= ((aa*bb)/cc); 
 		
-			dF += fac; 
+					dF += fac; 
 		
-			fac *= ( ( 1.0 / ( static_cast<double>(i) ) )*x);
+					fac *= ( ( 1.0 / ( static_cast<double>(i) ) )*x);
 		
-			F = temp + fac; 
+					F += fac; 
 		
-			if(F == temp){
-				return; 
+					if( fabs(fac) <= EPS*fabs(F) ){
+						break; 
+					}
+
+					aa += 1.0; bb += 1.0; cc += 1.0; 
+				}
 			}
+			else{
+				F = two_F_one(a, b, c, x); 
 		
-			temp = F; 
+				dF = ( a == 0.0 || b == 0.0 ? 0.0 : ((a*b)/c) * two_F_one(a + 1.0, b + 1.0, c + 1.0, x) ); 
+			}
+		}
+		else{
+			std::string reason; 
+
+			reason = "Error in special::two_F_one(double a, double b, double c, double x, double &F, double &dF)\n"; 
+			reason += "c = " + template_funcs::toString(c, 3) + " is a non-positive integer\n"; 
 
-			aa += 1.0; bb += 1.0; cc += 1.0; 
+			throw std::invalid_argument(reason); 
 		}
+	}
+	catch(std::invalid_argument &e){		
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
+	}
+}
 
+double special::two_F_one(double a, double b, double c, double x)
+{
+	// Value of the hypergeometric function {2}_F_{1}(a, b, c; x) for all real x
+	// The region is selected so that the series actually summed converges quickly
+	// |x| <= 1/2 : power series about x = 0
+	// -2 < x < -1/2 : Pfaff transformation x -> x / (x - 1), A&S 15.3.4, which maps x into (1/3, 2/3)
+	// 1/2 < x < 2 : transformation x -> 1 - x, A&S 15.3.6, and its degenerate forms when c - a - b is an integer
+	// |x| >= 2 : transformation x -> 1 / x, A&S 15.3.7, and its degenerate forms when b - a is an integer
+	// When both c - a - b and b - a are integers the 1 - x form is used up to x = 3/2 and the 1 / x form beyond that
+	// Terminating cases, where a, b, c - a or c - b is a non-positive integer, are summed directly as polynomials
+	// For x > 1 the real part of the analytic continuation is returned
+	// x = 1 is computed using Gauss' theorem, A&S 15.1.20, the series diverges at x = 1 when c - a - b <= 0
+
+	// Integer parameter combinations are detected to within DEGEN
+	// Non-degenerate connection formulae lose about -log10(DEGEN) digits when they are used within DEGEN of an integer
+	// so such parameters are treated as exactly integer, with a relative error of order DEGEN
+	static const double DEGEN = 1.0e-8; 
+
+	int nterms; 
+
+	if(x == 0.0){
+		return 1.0; 
+	}
+	else if( useful_funcs::is_integer(a, DEGEN) && floor(a + 0.5) <= 0.0 ){
+		// terminating series
+		return two_F_one_series(floor(a + 0.5), b, c, x, nterms); 
+	}
+	else if( useful_funcs::is_integer(b, DEGEN) && floor(b + 0.5) <= 0.0 ){
+		return two_F_one_series(a, floor(b + 0.5), c, x, nterms); 
+	}
+	else if( useful_funcs::is_integer(c - a, DEGEN) && floor(c - a + 0.5) <= 0.0 ){
+		// Euler's transformation, A&S 15.3.3, gives (1-x)^{c-a-b} times a polynomial
+		return ( x == 1.0 ? ( c - a - b > 0.0 ? 0.0 : HUGE_VAL ) : 
+			( x < 1.0 ? pow(1.0 - x, c - a - b) : useful_funcs::cospi(c - a - b) * pow(x - 1.0, c - a - b) ) * two_F_one_series(floor(c - a + 0.5), c - b, c, x, nterms) ); 
+	}
+	else if( useful_funcs::is_integer(c - b, DEGEN) && floor(c - b + 0.5) <= 0.0 ){
+		return ( x == 1.0 ? ( c - a - b > 0.0 ? 0.0 : HUGE_VAL ) : 
+			( x < 1.0 ? pow(1.0 - x, c - a - b) : useful_funcs::cospi(c - a - b) * pow(x - 1.0, c - a - b) ) * two_F_one_series(c - a, floor(c - b + 0.5), c, x, nterms) ); 
+	}
+	else if(x == 1.0){
+		// Gauss' theorem
+		return ( c - a - b > 0.0 ? probability::gammf(c) * probability::gammf(c - a - b) * probability::rgamma(c - a) * probability::rgamma(c - b) : HUGE_VAL ); 
+	}
+	else if(fabs(x) <= 0.5){
+		return two_F_one_series(a, b, c, x, nterms); 
+	}
+	else if(x > -2.0 && x < -0.5){
+		// Pfaff's transformation
+		return pow(1.0 - x, -a) * two_F_one(a, c - b, c, x / (x - 1.0)); 
+	}
+	else if( x > 0.5 && x < 2.0 && ( x <= 1.5 || !useful_funcs::is_integer(c - a - b, DEGEN) ) ){
+		return two_F_one_one_minus_x(a, b, c, x); 
 	}
 	else{
-		
-		F = dF = 0.0; 
-
+		return two_F_one_one_over_x(a, b, c, x); 
 	}
 }
 
-double special::bessj0(double x)
+double special::two_F_one_series(double a, double b, double c, double x, int &nterms, bool accelerate)
 {
-	//Return the Bessel Function J0(x) for all real x
-	double z,ax,xx,y,ans,ans1,ans2;
+	// Power series for {2}_F_{1}(a, b, c; x) about x = 0, A&S 15.1.1
+	// Summation stops when the terms fall below EPS relative to the sum, or when the series terminates
+	// The number of terms used is returned in nterms
+	// two_F_one only calls this with |x| <= 1/2 or for terminating series
+	// When x < 0 the terms eventually alternate, series that have not converged after NACC terms, large parameters or x close to -1/2,
+	// then have their partial sums extrapolated by the Levin u transformation
+	// For x > 0 the extrapolation gains little and loses up to two digits, so the series is summed directly
+	// accelerate = false sums every series directly, for comparison
 
-	if((ax=fabs(x))<8.0){
-		y=template_funcs::DSQR(x);
-		ans1=57568490574.0+y*(-13362590354.0+y*(651619640.7+
-			y*(-11214424.18+y*(77392.33017+y*(-184.9052456)))));
-		ans2=57568490411.0+y*(1029533985.0+y*(9494680.718+
-			y*(59272.64853+y*(267.8532712+y))));
-		ans=ans1/ans2;
-	}
-	else{
-		z=8.0/ax;
-		y=template_funcs::DSQR(z);
-		xx=ax-0.785398164;
-		ans1=1.0+y*(-0.1098628627e-2+y*(0.2734510407e-4+
-			y*(-0.2073370639e-5+y*0.2093887211e-6)));
-		ans2=-0.1562499995e-1+y*(0.1430488765e-3+
-			y*(-0.6911147651e-5+y*(0.7621095161e-6-y*0.934945152e-7)));
-		ans=sqrt(0.636619772/ax)*(cos(xx)*ans1-z*sin(xx)*ans2);
+	static const int MAXIT = 1000; 
+	static const int NACC = 20; 
+	static const double LEVIN_BETA = NACC; // the first partial sum passed to the transformation is s_{NACC}, its index starts there
+
+	double sum, term, val; 
+
+	series_accel::LevinTransform<double> lev(4.0*EPS, LEVIN_BETA); 
+
+	sum = term = 1.0; 
+
+	for(nterms=1; nterms<=MAXIT; nterms++){
+
+		term *= ( ( (a + nterms - 1) * (b + nterms - 1) ) / ( (c + nterms - 1) * nterms ) ) * x; 
+
+		sum += term; 
+
+		if( fabs(term) <= EPS*fabs(sum) ) break; 
+
+		if(accelerate && x < 0.0 && nterms >= NACC){
+			val = lev.next(sum, nterms*term); 
+			if(lev.converged()) return val; 
+		}
 	}
-	return ans;
+
+	if(nterms > MAXIT) std::cerr<<"two_F_one_series failed to converge\n"; 
+
+	return sum; 
 }
 
-double special::bessj1(double x)
+double special::two_F_one_one_minus_x(double a, double b, double c, double x)
 {
-	//Returns the Bessel function J1(x) for all real x
-	double ax,z,xx,y,ans,ans1,ans2;
+	// Evaluate {2}_F_{1}(a, b, c; x) through its representation in terms of functions of 1 - x, valid for 0 < x < 2
+	// Non-degenerate case, A&S 15.3.6
+	// F(a,b;c;x) = A F(a, b; a+b-c+1; 1-x) + B (1-x)^{c-a-b} F(c-a, c-b; c-a-b+1; 1-x)
+	// When m = c - a - b is an integer the two terms are individually infinite and their limit is taken analytically
+	// m > 0 : DLMF 15.8.10, m = 0 : A&S 15.3.10, m < 0 : Euler's transformation reduces it to the case -m > 0
+	// For 1 < x < 2 the real part is returned, (1-x)^{s} -> cos(pi s) |1-x|^{s} and ln(1-x) -> ln|1-x|
 
-	if((ax=fabs(x))<8.0){
-		y=template_funcs::DSQR(x);
-		ans1=x*(72362614232.0+y*(-7895059235.0+y*(242396853.1
-			+y*(-2972611.439+y*(15704.48260+y*(-30.16036606))))));
-		ans2=144725228442.0+y*(2300535178.0+y*(18583304.74
-			+y*(99447.43394+y*(376.9991397+y))));
-		ans=ans1/ans2;
+	static const double DEGEN = 1.0e-8; 
+	static const int MAXIT = 1000; 
+	static const double EULER_GAMMA = 0.57721566490153286061; 
+
+	double s = c - a - b; 
+	double t = 1.0 - x; 
+
+	if( !useful_funcs::is_integer(s, DEGEN) ){
+
+		double A, B, pw; 
+
+		A = probability::gammf(c) * probability::gammf(s) * probability::rgamma(c - a) * probability::rgamma(c - b); 
+		B = probability::gammf(c) * probability::gammf(-s) * probability::rgamma(a) * probability::rgamma(b); 
+		pw = ( t > 0.0 ? pow(t, s) : useful_funcs::cospi(s) * pow(-t, s) ); 
+
+		return ( A * two_F_one(a, b, 1.0 - s, t) + B * pw * two_F_one(c - a, c - b, 1.0 + s, t) ); 
 	}
 	else{
-		z=8.0/ax;
-		y=template_funcs::DSQR(z);
-		xx=ax-2.356194491;
-		ans1=1.0+y*(0.183105e-2+y*(-0.3516396496e-4
-			+y*(0.245752017e-5+y*(-0.240337019e-6))));
-		ans2=0.04687499995+y*(-0.2002690873e-3
-			+y*(0.8449199096e-5+y*(-0.88228987e-6
-			+y*0.105787412e-6)));
-		ans=sqrt(0.636619772/ax)*(cos(xx)*ans1-z*sin(xx)*ans2);
-		if(x<0.0) ans=-ans;
+		
+		int m = static_cast<int>( floor(s + 0.5) ); 
+
+		if(m < 0){
+			// Euler's transformation F(a,b;c;x) = (1-x)^{c-a-b} F(c-a,c-b;c;x), where c - (c-a) - (c-b) = -m
+			return pow(t, m) * two_F_one_one_minus_x(c - a, c - b, c, x); 
+		}
+		else{
+			int k; 
+			double fsum, lsum, term, coef, lnt, psi1, psim, psia, psib; 
+
+			// finite sum rgamma(a+m) rgamma(b+m) sum_{k=0}^{m-1} (a)_k (b)_k (m-k-1)! / k! (x-1)^k
+			fsum = 0.0; 
+			if(m > 0){
+				term = probability::factorial(m - 1); 
+				for(k=0; k<m; k++){
+					fsum += term; 
+					if(k < m - 1) term *= ( ( (a + k) * (b + k) ) / ( (k + 1.0) * (m - k - 1.0) ) ) * (-t); 
+				}
+				fsum *= probability::rgamma(a + m) * probability::rgamma(b + m); 
+			}
+
+			// logarithmic series sum_{k} (a+m)_k (b+m)_k / (k! (k+m)!) (1-x)^k [ln(1-x) - psi(k+1) - psi(k+m+1) + psi(a+k+m) + psi(b+k+m)]
+			lnt = log(fabs(t)); 
+			psi1 = -EULER_GAMMA; // psi(k+1)
+			psim = -EULER_GAMMA; // psi(k+m+1)
+			for(k=1; k<=m; k++) psim += 1.0/k; 
+			psia = probability::digamma(a + m); // psi(a+k+m)
+			psib = probability::digamma(b + m); // psi(b+k+m)
+			coef = 1.0 / probability::factorial(m); 
+			lsum = 0.0; 
+
+			for(k=0; k<=MAXIT; k++){
+
+				term = coef * ( lnt - psi1 - psim + psia + psib ); 
+
+				lsum += term; 
+
+				if( k > 0 && fabs(term) <= EPS*fabs(lsum) ) break; 
+
+				coef *= ( ( (a + m + k) * (b + m + k) ) / ( (k + 1.0) * (k + m + 1.0) ) ) * t; 
+				psi1 += 1.0 / (k + 1.0); 
+				psim += 1.0 / (k + m + 1.0); 
+				psia += 1.0 / (a + m + k); 
+				psib += 1.0 / (b + m + k); 
+			}
+
+			if(k > MAXIT) std::cerr<<"two_F_one_one_minus_x failed to converge\n"; 
+
+			lsum *= ( m == 0 ? 1.0 : pow(-t, m) ) * probability::rgamma(a) * probability::rgamma(b); 
+
+			return probability::gammf(c) * ( fsum - lsum ); 
+		}
 	}
-	return ans;
 }
 
-double special::bessj(int n,double x)
+double special::two_F_one_one_over_x(double a, double b, double c, double x)
 {
-	//Returns te Bessel function Jn(x) for all real x and n >= 2
-	int j,jsum,m;
-	double ax,bj,bjm,bjp,sum,tox,ans;
+	// Evaluate {2}_F_{1}(a, b, c; x) through its representation in terms of functions of 1 / x, valid for |x| > 1
+	// Non-degenerate case, A&S 15.3.7
+	// F(a,b;c;x) = A1 (-x)^{-a} F(a, 1-c+a; 1-b+a; 1/x) + A2 (-x)^{-b} F(b, 1-c+b; 1-a+b; 1/x)
+	// When m = b - a is an integer the two terms are individually infinite and their limit is taken analytically, DLMF 15.8.8
+	// F is symmetric in a and b so the case m < 0 is handled by exchanging a and b
+	// For x > 1 the real part is returned, (-x)^{-a} -> cos(pi a) x^{-a} and (-x)^{-a} ln(-x) -> x^{-a} (cos(pi a) ln(x) + pi sin(pi a))
 
-	static const double ACC=40.0;
-	static const double BIGNO=1e10;
-	static const double BIGNI=1.0e-10;
+	static const double DEGEN = 1.0e-8; 
+	static const int MAXIT = 1000; 
+	static const double EULER_GAMMA = 0.57721566490153286061; 
 
-	if(n<2){
-		std::cerr<<"Index n less than 2 in bessj\n";	
-	}
-	ax=fabs(x);
-	if(ax==0.0){
-		return 0.0;	
+	double X = fabs(x); 
+	double w = 1.0 / x; 
+
+	if( !useful_funcs::is_integer(b - a, DEGEN) ){
+
+		double A1, A2, ca, cb; 
+
+		A1 = probability::gammf(c) * probability::gammf(b - a) * probability::rgamma(b) * probability::rgamma(c - a); 
+		A2 = probability::gammf(c) * probability::gammf(a - b) * probability::rgamma(a) * probability::rgamma(c - b); 
+		ca = ( x > 0.0 ? useful_funcs::cospi(a) : 1.0 ); 
+		cb = ( x > 0.0 ? useful_funcs::cospi(b) : 1.0 ); 
+
+		return ( A1 * ca * pow(X, -a) * two_F_one(a, 1.0 - c + a, 1.0 - b + a, w) + A2 * cb * pow(X, -b) * two_F_one(b, 1.0 - c + b, 1.0 - a + b, w) ); 
 	}
-	else if(ax>static_cast<double>(n)){
-		//Upwards recurrence from J0 and J1
-		tox=2.0/ax;
-		bjm=bessj0(ax);
-		bj=bessj1(ax);
-		for(j=1;j<n;j++){
-			bjp=j*tox*bj-bjm;
-			bjm=bj;
-			bj=bjp;
-		}
-		ans=bj;
+	else if(b < a){
+		return two_F_one_one_over_x(b, a, c, x); 
 	}
 	else{
-		//Downwards recurrence from an even m here computed
-		tox=2.0/ax;
-		m=2*((n+static_cast<int>(sqrt(ACC*n)))/2);
-		jsum=0;
-		bjp=ans=sum=0.0;
-		bj=1.0;
-		for(j=m;j>0;j--){
-			bjm=j*tox*bj-bjp;
-			bjp=bj;
-			bj=bjm;
-			if(fabs(bj)>BIGNO){
-				bj*=BIGNI;
-				bjp*=BIGNI;
-				ans*=BIGNI;
-				sum*=BIGNI;
+		int k, n; 
+		double fsum, lsum, term, coef, ca, sa, lnX, Xa, R, psi1, psim, psiam, y, rg, psirg; 
+
+		int m = static_cast<int>( floor(b - a + 0.5) ); 
+
+		ca = ( x > 0.0 ? useful_funcs::cospi(a) : 1.0 ); 
+		sa = ( x > 0.0 ? useful_funcs::sinpi(a) : 0.0 ); 
+		lnX = log(X); 
+		Xa = pow(X, -a); 
+
+		// finite sum rgamma(a+m) sum_{k=0}^{m-1} (a)_k (m-k-1)! / k! rgamma(c-a-k) x^{-k}
+		fsum = 0.0; 
+		if(m > 0){
+			term = probability::factorial(m - 1); 
+			for(k=0; k<m; k++){
+				fsum += term * probability::rgamma(c - a - k); 
+				if(k < m - 1) term *= ( (a + k) / ( (k + 1.0) * (m - k - 1.0) ) ) * w; 
 			}
-			if(jsum) sum+=bj;
-			jsum=!jsum;
-			if(j==n) ans=bjp;
+			fsum *= ca * Xa * probability::rgamma(a + m); 
 		}
-		sum=2.0*sum-bj;
-		ans/=sum;
+
+		// logarithmic series
+		// sum_{k} (a+m)_k / (k! (k+m)!) (-1)^k x^{-k-m} [ (ln(-x) + psi(1+m+k) + psi(1+k) - psi(a+m+k)) rgamma(c-a-m-k) - psi(c-a-m-k) rgamma(c-a-m-k) ]
+		// psi(y) rgamma(y) and rgamma(y) at y = c-a-m-k are generated by downward recurrence in y, which is free of division at the poles
+		// psi(y-1) rgamma(y-1) = (y-1) psi(y) rgamma(y) - rgamma(y), rgamma(y-1) = (y-1) rgamma(y)
+		y = c - a - m; 
+		rg = probability::rgamma(y); 
+		if(y <= 0.0 && useful_funcs::is_integer(y, DEGEN)){
+			// limit of psi(-n) / gamma(-n) = (-1)^{n+1} n!
+			n = static_cast<int>( floor(-y + 0.5) ); 
+			psirg = ( n % 2 == 0 ? -1.0 : 1.0 ) * probability::factorial(n); 
+		}
+		else{
+			psirg = probability::digamma(y) * rg; 
+		}
+
+		psi1 = -EULER_GAMMA; // psi(1+k)
+		psim = -EULER_GAMMA; // psi(1+m+k)
+		for(k=1; k<=m; k++) psim += 1.0/k; 
+		psiam = probability::digamma(a + m); // psi(a+m+k)
+		coef = pow(w, m) / probability::factorial(m); 
+		lsum = 0.0; 
+
+		for(k=0; k<=MAXIT; k++){
+
+			R = psim + psi1 - psiam; 
+
+			term = coef * ( ( ca * (lnX + R) + PI * sa ) * rg - ca * psirg ); 
+
+			lsum += term; 
+
+			if( k > 0 && fabs(term) <= EPS*fabs(lsum) ) break; 
+
+			coef *= -( (a + m + k) / ( (k + 1.0) * (k + m + 1.0) ) ) * w; 
+			psi1 += 1.0 / (k + 1.0); 
+			psim += 1.0 / (k + m + 1.0); 
+			psiam += 1.0 / (a + m + k); 
+			psirg = (y - 1.0) * psirg - rg; 
+			rg *= (y - 1.0); 
+			y -= 1.0; 
+		}
+
+		if(k > MAXIT) std::cerr<<"two_F_one_one_over_x failed to converge\n"; 
+
+		lsum *= Xa * probability::rgamma(a); 
+
+		return probability::gammf(c) * ( fsum + lsum ); 
 	}
-	return x<0.0 && (n&1) ? -ans:ans; 
 }
 
-double special::bessel_J(int n,double x)
+special::HypergeometricSeries::HypergeometricSeries()
 {
-	if(n==0){
-		return bessj0(x);	
-	}
-	else if(n==1){
-		return bessj1(x);	
+	// Default constructor, the trivial series 2F1(0, 0; 1; x) = 1
+	pa = pb = 0.0; pc = 1.0; pxmax = 0.5; 
+
+	coef.assign(1, 1.0); 
+	dcoef.assign(1, 0.0); 
+}
+
+special::HypergeometricSeries::HypergeometricSeries(double a, double b, double c, double xmax, double tol)
+{
+	// Primary constructor
+	set_params(a, b, c, xmax, tol); 
+}
+
+void special::HypergeometricSeries::set_params(double a, double b, double c, double xmax, double tol)
+{
+	// Tabulate the power series coefficients of 2F1(a, b; c; x) once for the parameters (a, b, c)
+	// The series is truncated at the smallest degree N for which the tail on |x| <= xmax is bounded by
+	// tol * sum_{k=0}^{N} |coef[k]| xmax^{k}
+	// Once the term ratio rho_k = |(a+k)(b+k) / ((c+k)(k+1))| xmax is < 1, the tail is bounded by the geometric series
+	// |t_{k}| r / (1 - r), with r = max(rho_k, xmax) since rho_k -> xmax as k -> infinity
+	// The truncated polynomial is then evaluated with a fixed number of operations for every x
+
+	try{
+		bool c1 = ( xmax > 0.0 && xmax < 1.0 ); 
+		bool c2 = ( tol > 0.0 ); 
+		bool c3 = !( c <= 0.0 && useful_funcs::is_integer(c) ) || ( a <= 0.0 && useful_funcs::is_integer(a) && a > c ) || ( b <= 0.0 && useful_funcs::is_integer(b) && b > c ); 
+
+		if(c1 && c2 && c3){
+
+			static const int MAXDEG = 2000; 
+
+			int k; 
+			double t, tabs, xpow, abs_sum, rho; 
+
+			pa = a; pb = b; pc = c; pxmax = xmax; 
+
+			coef.clear(); dcoef.clear(); 
+
+			coef.push_back(1.0); 
+			t = 1.0; xpow = 1.0; abs_sum = 1.0; 
+
+			for(k=0; k<MAXDEG; k++){
+
+				t *= ( (a + k) * (b + k) ) / ( (c + k) * (k + 1.0) ); 
+
+				if(t == 0.0) break; // terminating series
+
+				coef.push_back(t); 
+
+				xpow *= xmax; 
+				tabs = fabs(t) * xpow; 
+				abs_sum += tabs; 
+
+				rho = std::max( fabs( ( (a + k + 1.0) * (b + k + 1.0) ) / ( (c + k + 1.0) * (k + 2.0) ) ) * xmax, xmax ); 
+
+				if( rho < 1.0 && tabs * rho / (1.0 - rho) <= tol * abs_sum ) break; 
+			}
+
+			if(k == MAXDEG) std::cerr<<"HypergeometricSeries: tolerance not reached with "<<MAXDEG<<" terms\n"; 
+
+			for(k=1; k<static_cast<int>(coef.size()); k++){
+				dcoef.push_back( k * coef[k] ); 
+			}
+			if(dcoef.empty()) dcoef.push_back(0.0); 
+		}
+		else{
+			std::string reason = "Error: void special::HypergeometricSeries::set_params(double a, double b, double c, double xmax, double tol)\n"; 
+			if(!c1) reason += "xmax = " + template_funcs::toString(xmax, 3) + " must lie in (0, 1)\n"; 
+			if(!c2) reason += "tol = " + template_funcs::toString(tol) + " must be positive\n"; 
+			if(!c3) reason += "c = " + template_funcs::toString(c, 3) + " is a non-positive integer\n"; 
+			throw std::invalid_argument(reason); 
+		}
 	}
-	else{
-		return bessj(n,x);	
+	catch(std::invalid_argument &e){
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
 	}
 }
 
-double special::bessy0(double x)
+double special::HypergeometricSeries::value(double x) const
 {
-	//Returns the Bessel Function Y0(x) for real positive values of x
-	double z,xx,y,ans,ans1,ans2;
+	// Evaluate the truncated series at a single point
+	// The polynomial is split into even and odd parts, p(x) = E(x^2) + x O(x^2), so that two independent Horner
+	// recurrences run side by side, halving the length of the dependency chain
 
-	if(x<8.0){
-		y=template_funcs::DSQR(x);
-		ans1=-2957821389.0+y*(7062834065.0+y*(-512359803.6+
-			y*(10879881.29+y*(-86327.92757+y*228.4622733))));
-		ans2=40076544269.0+y*(745249964.8+y*(7189466.438+
-			y*(47447.26470+y*(226.1030244+y))));
-		ans=(ans1/ans2)+0.636619772*bessj0(x)*log(x);
+	if(fabs(x) <= pxmax){
+
+		int k, N = degree(); 
+		double x2 = x*x, pe = 0.0, po = 0.0; 
+
+		for(k = ( N % 2 == 0 ? N : N - 1 ); k >= 0; k -= 2){
+			pe = pe*x2 + coef[k]; 
+			if(k + 1 <= N) po = po*x2 + coef[k + 1]; 
+		}
+
+		return pe + x*po; 
 	}
 	else{
-		z=8.0/x;
-		y=template_funcs::DSQR(z);
-		xx=x-0.785398164;
-		ans1=1.0+y*(-0.1098628627e-2+y*(0.2734510407e-4+
-			y*(-0.2073370639e-5+y*0.2093887211e-6)));
-		ans2=-0.1562499995e-1+y*(0.1430488765e-3+
-			y*(-0.6911147651e-5+y*(0.7621095161e-6+y*(-0.934945152e-7))));
-		ans=sqrt(0.636619772/x)*(sin(xx)*ans1+z*cos(xx)*ans2);
+		return two_F_one(pa, pb, pc, x); 
 	}
-	return ans;
 }
 
-double special::bessy1(double x)
+void special::HypergeometricSeries::value(double x, double &F, double &dF) const
 {
-	//Returns the Bessel Function Y1(x) for real positive x
-	double z,xx,y,ans,ans1,ans2;
+	// Evaluate the truncated series and its derivative at a single point
 
-	if(x<8.0){
-		y=template_funcs::DSQR(x);
-		ans1=x*(-0.4900604943e13+y*(0.1275274390e13
-			+y*(-0.5153438139e11+y*(0.7349264551e9
-			+y*(-0.4237922726e7+y*0.8511937935e4)))));
-		ans2=0.2499580570e14+y*(0.424441966e12
-			+y*(0.3733650367e10+y*(0.2245904002e8
-			+y*(0.1020426050e6+y*(0.3549632885e3+y)))));
-		ans=(ans1/ans2)+0.636619772*(bessj1(x)*log(x)-1.0/x);
+	if(fabs(x) <= pxmax){
+
+		int k, N = degree(); 
+
+		F = coef[N]; 
+		dF = dcoef[ std::max(N - 1, 0) ]; 
+
+		for(k=N-1; k>=0; k--){
+			F = F*x + coef[k]; 
+			if(k < N - 1) dF = dF*x + dcoef[k]; 
+		}
+		if(N == 0) dF = 0.0; 
 	}
 	else{
-		z=8.0/x;
-		y=template_funcs::DSQR(z);
-		xx=x-2.356194491;
-		ans1=1.0+y*(0.183105e-2+y*(-0.3516396496e-4
-			+y*(0.245752017e-5+y*(-0.240337019e-6))));
-		ans2=0.04687499995+y*(-0.2002690873e-3
-			+y*(0.8449199096e-5+y*(-0.88228987e-6
-			+y*0.105787412e-6)));
-		ans=sqrt(0.636619772/x)*(sin(xx)*ans1+z*cos(xx)*ans2);
+		two_F_one(pa, pb, pc, x, F, dF); 
 	}
-	return ans;
 }
 
-double special::bessy(int n,double x)
+void special::HypergeometricSeries::evaluate(int n, const double *x, double *F, double *dF) const
 {
-	//Returns the Bessel Function Yn(x) for n >= 2
-	int j;
-	double by,bym,byp,tox;
+	// Evaluate the truncated series at n points
+	// Points are processed in blocks of BLOCK, the Horner recurrence is run for every point of a block together
+	// so that the inner loop over the block has no dependencies and maps onto SIMD registers
+	// Every point takes the same number of operations, points with |x| > xmax are redone with two_F_one
 
-	if(n<2){
-		std::cerr<<"Index n less than 2 in bessy\n";
-	}
-	tox=2.0/x;
-	by=bessy1(x);
-	bym=bessy0(x);
-	for(j=1;j<n;j++){
-		byp=j*tox*by-bym;
-		bym=by;
-		by=byp;
+	static const int BLOCK = 8; 
+
+	int i, j, k, nb, N = degree(); 
+	double xb[BLOCK], pF[BLOCK], pD[BLOCK]; 
+
+	for(i=0; i<n; i+=BLOCK){
+
+		nb = std::min(BLOCK, n - i); 
+
+		for(j=0; j<BLOCK; j++){
+			xb[j] = ( j < nb ? x[i + j] : 0.0 ); 
+			pF[j] = coef[N]; 
+			pD[j] = ( N > 0 ? dcoef[N - 1] : 0.0 ); 
+		}
+
+		for(k=N-1; k>=0; k--){
+			const double ck = coef[k]; 
+			for(j=0; j<BLOCK; j++){
+				pF[j] = pF[j]*xb[j] + ck; 
+			}
+		}
+
+		if(dF != nullptr){
+			for(k=N-2; k>=0; k--){
+				const double dk = dcoef[k]; 
+				for(j=0; j<BLOCK; j++){
+					pD[j] = pD[j]*xb[j] + dk; 
+				}
+			}
+		}
+
+		for(j=0; j<nb; j++){
+			if(fabs(xb[j]) <= pxmax){
+				F[i + j] = pF[j]; 
+				if(dF != nullptr) dF[i + j] = pD[j]; 
+			}
+			else if(dF != nullptr){
+				two_F_one(pa, pb, pc, xb[j], F[i + j], dF[i + j]); 
+			}
+			else{
+				F[i + j] = two_F_one(pa, pb, pc, xb[j]); 
+			}
+		}
 	}
-	return by;
 }
 
-double special::bessel_Y(int n,double x)
+double special::one_F_one(double a, double b, double x)
 {
-	if(n==0){
-		return bessy0(x);
-	}
-	else if(n==1){
-		return bessy1(x);
+	// Kummer's confluent hypergeometric function M(a, b, x) = {1}_F_{1}(a; b; x), A&S 13.1.2
+	// M(a, b, x) = sum_{k} (a)_k / (b)_k x^k / k!
+	// Single evaluation, the parameter setup is redone on every call
+
+	if(x == 0.0){
+		return 1.0; 
 	}
 	else{
-		return bessy(n,x);
+		ConfluentHypergeometric kummer(a, b, false); 
+
+		return kummer.M(x); 
 	}
 }
 
-double special::bessi0(double x)
+double special::tricomi_U(double a, double b, double x)
 {
-	//Returns the modified Bessel Function I0(x) for any real x
-	double ax,ans,y;
+	// Tricomi's confluent hypergeometric function U(a, b, x), A&S 13.1.3
+	// U(a, b, x) is the solution of Kummer's equation x w'' + (b - x) w' - a w = 0 that behaves as x^{-a} as x -> infinity
+	// Single evaluation, the parameter setup is redone on every call
 
-	if((ax=fabs(x))<3.75){
-		y=x/3.75;
-		y*=y;
-		ans=1.0+y*(3.5156229+y*(3.0899424+y*(1.2067492
-			+y*(0.2659732+y*(0.360768e-1+y*0.45813e-2)))));
+	ConfluentHypergeometric kummer(a, b, false); 
+
+	return kummer.U(x); 
+}
+
+void special::gaulag(int n, double alf, double *x, double *w, double lnscale)
+{
+	// Abscissas x[0..n-1] and weights w[0..n-1] of the n point Gauss-Laguerre quadrature rule
+	// int_{0}^{infty} x^{alf} exp(-x) f(x) dx ~ sum_{j} w[j] f(x[j]), alf > -1
+	// The abscissas are the roots of the Laguerre polynomial L_{n}^{alf}(x), found by Newton's method from the
+	// initial guesses given in NRinC, sect. 4.5
+	// The weights are returned multiplied by exp(-lnscale), lnscale = gammln(alf + 1) normalises them to sum to one
+	// and avoids their overflow when alf is large
+
+	try{
+		if(n > 0 && alf > -1.0){
+			static const int MAXIT = 10; 
+			static const double TOL = 1.0e-14; 
+
+			int i, its, j; 
+			double ai, p1, p2, p3, pp, z, z1, lnw; 
+
+			// ln[ Gamma(alf + n) / Gamma(n) ] = ln Gamma(alf + 1) + sum_{j=1}^{n-1} ln(1 + alf / j)
+			// the sum avoids the loss of accuracy in the difference of two large values of gammln
+			lnw = probability::gammln(alf + 1.0) - lnscale; 
+			for(j=1; j<n; j++) lnw += log1p(alf / j); 
+
+			z = 0.0; p2 = pp = 1.0; 
+			for(i=0; i<n; i++){
+				if(i == 0){
+					z = (1.0 + alf)*(3.0 + 0.92*alf) / (1.0 + 2.4*n + 1.8*alf); 
+				}
+				else if(i == 1){
+					z += (15.0 + 6.25*alf) / (1.0 + 0.9*alf + 2.5*n); 
+				}
+				else{
+					ai = i - 1; 
+					z += ( (1.0 + 2.55*ai) / (1.9*ai) + 1.26*ai*alf / (1.0 + 3.5*ai) )*(z - x[i-2]) / (1.0 + 0.3*alf); 
+				}
+				for(its=0; its<MAXIT; its++){
+					// L_{n}^{alf}(z) by upward recurrence, p2 = L_{n-1}^{alf}(z), pp = dL_{n}^{alf}/dz
+					p1 = 1.0; 
+					p2 = 0.0; 
+					for(j=0; j<n; j++){
+						p3 = p2; 
+						p2 = p1; 
+						p1 = ( (2*j + 1 + alf - z)*p2 - (j + alf)*p3 ) / (j + 1); 
+					}
+					pp = (n*p1 - (n + alf)*p2) / z; 
+					z1 = z; 
+					z = z1 - p1/pp; 
+					if(fabs(z - z1) <= TOL*z) break; 
+				}
+				if(its == MAXIT && fabs(z - z1) > 1.0e-12*z) std::cerr<<"gaulag: too many iterations\n"; 
+				// L_{n-1}^{alf} and the derivative at the converged root for the weight
+				p1 = 1.0; 
+				p2 = 0.0; 
+				for(j=0; j<n; j++){
+					p3 = p2; 
+					p2 = p1; 
+					p1 = ( (2*j + 1 + alf - z)*p2 - (j + alf)*p3 ) / (j + 1); 
+				}
+				pp = (n*p1 - (n + alf)*p2) / z; 
+				x[i] = z; 
+				w[i] = -exp(lnw) / (pp*n*p2); 
+			}
+		}
+		else{
+			std::string reason = "Error: void special::gaulag(int n, double alf, double *x, double *w, double lnscale)\n"; 
+			if(n <= 0) reason += "n = " + template_funcs::toString(n) + " must be positive\n"; 
+			if(alf <= -1.0) reason += "alf = " + template_funcs::toString(alf, 3) + " must be > -1\n"; 
+			throw std::invalid_argument(reason); 
+		}
 	}
-	else{
-		y=3.75/ax;
-		ans=(exp(ax)/sqrt(ax))*(0.39894228+y*(0.132859e-1
-			+y*(0.225319e-2+y*(-0.157565e-2+y*(0.916281e-2
-			+y*(-0.2057706e-1+y*(0.2635537e-1+y*(-0.1647633e-1
-			+y*0.392377e-2))))))));
+	catch(std::invalid_argument &e){
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
 	}
-	return ans;
 }
 
-double special::bessi1(double x)
+// Region selection for M(a, b, x) and U(a, b, x)
+// M, x < 0 : Kummer's transformation M(a, b, x) = e^{x} M(b - a, b, -x), A&S 13.1.27, so that only x > 0 is summed
+// M, x > 0 : asymptotic expansion A&S 13.5.1 once x >= xasym, otherwise the cheaper of the power series and, for a > 2,
+//            forward recurrence in a, A&S 13.4.1, from two asymptotic values at a0 = a - floor(a) + 1 and a0 + 1.
+//            M is the dominant solution of the recurrence for increasing a so the recurrence is stable
+// M, a < -1, x > 0 : the series is used while it cancels by less than CHF_COND. Otherwise, a polynomial follows from the
+//            recurrence in a downwards from a = 0, and any other M from the recurrence in b, A&S 13.4.2, downwards from
+//            b + N >= |a| x / 2 where the series hardly cancels. Beyond CHF_NBREC steps the Wronskian of M and U,
+//            A&S 13.1.22, is combined with the continued fraction for M(a, b+1, x) / M(a, b, x) instead
+// U, x >= xasym : asymptotic expansion A&S 13.5.2
+// U, a > 2, b > a + 1 : Kummer's transformation U(a, b, x) = x^{1-b} U(a - b + 1, 2 - b, x), A&S 13.1.29
+// U, x <= CHF_XSMALL : A&S 13.1.3 in terms of M, or its logarithmic limit DLMF 13.2.9 when b is an integer. Away from
+//            integer b the two terms cancel when |b - 1| > x, the form is then only kept if the cancellation is small
+// U, otherwise : U(a, b, x) = x^{-a} / Gamma(a) int_{0}^{infty} t^{a-1} e^{-t} (1 + t/x)^{b-a-1} dt, A&S 13.2.5,
+//            by Gauss-Laguerre quadrature. For a <= 0 the integral is done at a0 = a + nrec in (0, 1] and a0 + 1 and the
+//            recurrence A&S 13.4.15 is run downwards to a, which is stable as U is the minimal solution for increasing a
+// U, a > 2 : the quadrature loses accuracy as the integrand peaks, below xasym Miller's algorithm is applied to A&S 13.4.15,
+//            normalised by U(a - floor(a), b, x), except at small a x where the small x form is used
+// The terminating cases of U, a or a - b + 1 a non-positive integer, are summed directly, as is M when a is a non-positive
+// integer and the series does not cancel
+
+static const int CHF_NASY = 60; // maximum number of terms of an asymptotic expansion
+static const int CHF_NSER = 2000; // maximum number of tabulated series coefficients
+static const int CHF_NQUAD = 64; // number of Gauss-Laguerre points used for U
+static const double CHF_XASY = 10.0; // the asymptotic form of M is not used below this point
+static const double CHF_XSMALL = 2.0; // upper limit of the small x form of U
+static const double CHF_AXSMALL = 1.0; // for a > 2 the small x form of U is also limited to a x <= CHF_AXSMALL
+static const double CHF_ASY_COST = 30.0; // cost of an asymptotic evaluation in units of series terms
+static const double CHF_ASY_GROW = 1.0e3; // largest term accepted in an asymptotic series, relative to the first
+static const double CHF_DEGEN = 1.0e-8; // integer b is detected to within this tolerance, see two_F_one
+static const double CHF_COND = 1.0e3; // largest cancellation accepted in a power series for M, or in the small x form of U
+static const double CHF_COND_QUAD = 1.0e4; // in the small x form of U in place of the quadrature, which is less accurate
+static const int CHF_NBREC = 100000; // maximum number of steps of the backward recurrence in b for M
+
+special::ConfluentHypergeometric::ConfluentHypergeometric()
 {
-	//Returns the modified Bessel Function I1(x) for any real x
-	double ax,ans,y;
-	if((ax=fabs(x))<3.75){
-		y=x/3.75;
-		y*=y;
-		ans=ax*(0.5+y*(0.87890594+y*(0.51498869+y*(0.15084934
-			+y*(0.2658733e-1+y*(0.301532e-2+y*0.32411e-3))))));
+	// Default constructor
+	pa = pb = 0.0; 
+	valid_M = false; 
+}
+
+special::ConfluentHypergeometric::ConfluentHypergeometric(double a, double b, bool tabulate)
+{
+	// Primary constructor
+	set_params(a, b, tabulate); 
+}
+
+void special::ConfluentHypergeometric::set_params(double a, double b, bool tabulate)
+{
+	// Parameter dependent setup for M(a, b, x) and U(a, b, x)
+	// M is undefined when b is a non-positive integer unless its series terminates first, this is reported by M(x)
+
+	int i; 
+	double a0; 
+
+	pa = a; pb = b; 
+
+	// M(a, b, x) for x > 0, M(b - a, b, x) for x < 0, and the sets at which recurrences in alpha start
+	valid_M = !( b <= 0.0 && useful_funcs::is_integer(b) ) || ( a <= 0.0 && useful_funcs::is_integer(a) && a > b ); 
+
+	sets.clear(); 
+	if(valid_M){
+		sets.resize(2); 
+		set_kummer(sets[0], a, b, tabulate); 
+		set_kummer(sets[1], b - a, b, tabulate); 
+
+		for(i=0; i<2; i++){
+			if( !sets[i].poly && sets[i].alpha > 2.0 ){
+				// forward recurrence from alpha0 + 1 and alpha0 + 2
+				KummerSet s0, s1; 
+				a0 = sets[i].alpha - floor(sets[i].alpha); 
+				sets[i].seed = static_cast<int>( sets.size() ); 
+				set_kummer(s0, a0 + 1.0, b, tabulate); 
+				set_kummer(s1, a0 + 2.0, b, tabulate); 
+				sets.push_back(s0); 
+				sets.push_back(s1); 
+			}
+		}
 	}
-	else{
-		y=3.75/ax;
-		ans=0.2282967e-1+y*(-0.2895312e-1+y*(0.1787654e-1
-			-y*0.420059e-2));
-		ans=0.39894228+y*(-0.3988024e-1+y*(-0.362018e-2
-			+y*(0.163801e-2+y*(-0.1031555e-1+y*ans))));
-		ans*=(exp(ax)/sqrt(ax));
+
+	// U(a, b, x), and for a > 2 either U(a - b + 1, 2 - b, x) for Kummer's transformation when b > a + 1, or
+	// U(a - floor(a), b, x) which normalises the recurrence
+	usets.clear(); 
+	usets.resize(1); 
+	set_tricomi(usets[0], a, b, tabulate); 
+	if(usets[0].poly == 0 && a > 2.0){
+		TricomiSet t0; 
+		if(b > a + 1.0) set_tricomi(t0, a - b + 1.0, 2.0 - b, tabulate); 
+		else set_tricomi(t0, a - floor(a), b, tabulate); 
+		usets.push_back(t0); 
+	}
+
+	// U(alpha, beta, x) and U(alpha, beta + 1, x) for the Kummer sets with alpha < -1
+	for(i=0; i<static_cast<int>( sets.size() ); i++){
+		if( !sets[i].poly && sets[i].alpha < -1.0 ){
+			TricomiSet t0, t1; 
+			sets[i].useed = static_cast<int>( usets.size() ); 
+			set_tricomi(t0, sets[i].alpha, b, tabulate); 
+			set_tricomi(t1, sets[i].alpha, b + 1.0, tabulate); 
+			usets.push_back(t0); 
+			usets.push_back(t1); 
+		}
 	}
-	return x<0.0?-ans:ans;
 }
 
-double special::bessi(int n,double x)
+void special::ConfluentHypergeometric::set_kummer(KummerSet &s, double alpha, double beta, bool tabulate)
 {
-	//Returns the modified Bessel Function In(x) for n>=2 for any real x
-	int j;
-	double bi,bim,bip,tox,ans;
+	// Fixed parameter data for M(alpha, beta, x), x >= 0
+	// A&S 13.5.1 for real x > 0, the real part of the two choices of sign in e^{+/- i pi alpha} is taken
+	// M(alpha, beta, x) ~ Gamma(beta) / Gamma(alpha) e^{x} x^{alpha-beta} sum_{k} (beta-alpha)_k (1-alpha)_k / k! x^{-k}
+	//   + cos(pi alpha) Gamma(beta) / Gamma(beta-alpha) x^{-alpha} sum_{k} (alpha)_k (1+alpha-beta)_k / k! (-x)^{-k}
+
+	int k, sb, sa, sc; 
+	double t, lb, ca, xs; 
+
+	s.alpha = alpha; s.beta = beta; 
+	s.poly = ( alpha <= 0.0 && useful_funcs::is_integer(alpha) ); 
+	s.seed = s.useed = -1; 
+	s.sgn1 = s.sgn2 = 0; 
+	s.lg1 = s.lg2 = 0.0; 
+	s.xasym = HUGE_VAL; 
+	s.ser.clear(); s.asy.clear(); s.sub.clear(); 
+
+	if(!s.poly){
+		// gamma function prefactors, a zero sign marks a vanishing term
+		lb = lngamma(beta, sb); 
+		s.lg1 = lb - lngamma(alpha, sa); 
+		s.sgn1 = sb * sa; 
+
+		ca = useful_funcs::cospi(alpha); 
+		s.lg2 = lb - lngamma(beta - alpha, sc); 
+		if(ca != 0.0) s.lg2 += log(fabs(ca)); 
+		s.sgn2 = ( ca == 0.0 ? 0 : sb * sc * ( ca > 0.0 ? 1 : -1 ) ); 
+
+		// coefficients of both asymptotic series, each vector stops before its first zero coefficient
+		std::vector<double> c(1, 1.0), d(1, 1.0); 
+		t = 1.0; 
+		for(k=0; k<CHF_NASY && t != 0.0; k++){
+			t *= ( (beta - alpha + k) * (1.0 - alpha + k) ) / (k + 1.0); 
+			if(t != 0.0) c.push_back(t); 
+		}
+		t = 1.0; 
+		for(k=0; k<CHF_NASY && t != 0.0; k++){
+			t *= ( (alpha + k) * (1.0 + alpha - beta + k) ) / (k + 1.0); 
+			if(t != 0.0) d.push_back(t); 
+		}
 
-	static const double ACC=40.0;
-	static const double BIGNO=1e10;
-	static const double BIGNI=1.0e-10;
+		xs = asym_start(c); 
+		if(s.sgn2 != 0) xs = std::max(xs, asym_start(d)); 
+		s.xasym = std::max( xs, std::max(CHF_XASY, beta) ); 
 
-	if(n<2) std::cerr<<"Index n less than 2 in bessi\n";
+		if(tabulate){
+			s.asy = c; 
+			s.sub = d; 
+		}
+	}
 
-	if(x==0.0){
-		return 0.0;
+	if(tabulate){
+		// term ratios of the series for every x at which the series can be selected
+		int nt = static_cast<int>( std::min( series_cost(s, std::min(s.xasym, 700.0)), static_cast<double>(CHF_NSER) ) ); 
+		for(k=0; k<nt; k++){
+			s.ser.push_back( (alpha + k) / ( (beta + k) * (k + 1.0) ) ); 
+		}
 	}
-	else{
-		tox=2.0/fabs(x);
-		bip=ans=0.0;
-		bi=1.0;
-		for(j=2*(n+static_cast<int>(sqrt(ACC*n)));j>0;j--){
-			bim=bip+j*tox*bi;
-			bip=bi;
-			bi=bim;
-			if(fabs(bi)>BIGNO){
-				ans*=BIGNI;
-				bi *=BIGNI;
-				bip*=BIGNI;
+}
+
+void special::ConfluentHypergeometric::set_tricomi(TricomiSet &t, double a, double b, bool tabulate)
+{
+	// Fixed parameter data for U(a, b, x), x > 0
+
+	int k; 
+	double c, a0; 
+
+	t.a = a; t.b = b; 
+	t.poly = ( a <= 0.0 && useful_funcs::is_integer(a) ? 1 : ( a - b + 1.0 <= 0.0 && useful_funcs::is_integer(a - b + 1.0) ? 2 : 0 ) ); 
+	t.bint = useful_funcs::is_integer(b, CHF_DEGEN); 
+	t.nrec = ( a > 0.0 ? 0 : static_cast<int>( floor(-a) ) + 1 ); 
+	t.g1 = t.g2 = 0.0; 
+	t.xasym = HUGE_VAL; 
+	t.asy.clear(); t.qx0.clear(); t.qw0.clear(); t.qx1.clear(); t.qw1.clear(); 
+
+	if(t.poly == 0){
+		if(!t.bint){
+			t.g1 = probability::gammf(1.0 - b) * probability::rgamma(a - b + 1.0); 
+			t.g2 = probability::gammf(b - 1.0) * probability::rgamma(a); 
+		}
+
+		// coefficients of the asymptotic series, which does not terminate when poly = 0
+		std::vector<double> e(1, 1.0); 
+		c = 1.0; 
+		for(k=0; k<CHF_NASY; k++){
+			c *= ( (a + k) * (a - b + 1.0 + k) ) / (k + 1.0); 
+			e.push_back(c); 
+		}
+		t.xasym = std::max( asym_start(e), CHF_XSMALL ); 
+
+		if(tabulate){
+			t.asy = e; 
+
+			// the quadrature is only used at a0 <= 2, larger a use the recurrence
+			a0 = a + t.nrec; 
+			if(a0 <= 2.0){
+				t.qx0.resize(CHF_NQUAD); t.qw0.resize(CHF_NQUAD); 
+				gaulag(CHF_NQUAD, a0 - 1.0, &t.qx0[0], &t.qw0[0], probability::gammln(a0)); 
+				if(t.nrec > 0){
+					t.qx1.resize(CHF_NQUAD); t.qw1.resize(CHF_NQUAD); 
+					gaulag(CHF_NQUAD, a0, &t.qx1[0], &t.qw1[0], probability::gammln(a0 + 1.0)); 
+				}
 			}
-			if(j==n) ans=bip;
 		}
-		ans*=bessi0(x)/bi;
-		return x<0.0 && (n&1) ? -ans:ans;
 	}
 }
 
-double special::bessel_I(int n,double x)
+double special::ConfluentHypergeometric::lngamma(double y, int &sgn)
 {
-	if(n==0){
-		return bessi0(x);
+	// ln|Gamma(y)| and the sign of Gamma(y), sgn = 0 at the poles where 1 / Gamma(y) = 0
+	// The reflection formula is used for y < 0
+
+	if(y > 0.0){
+		sgn = 1; 
+		return probability::gammln(y); 
 	}
-	else if(n==1){
-		return bessi1(x);
+	else if(useful_funcs::is_integer(y)){
+		sgn = 0; 
+		return HUGE_VAL; 
 	}
 	else{
-		return bessi(n,x);
+		double s = useful_funcs::sinpi(y); 
+		sgn = ( s > 0.0 ? 1 : -1 ); 
+		return log( PI / fabs(s) ) - probability::gammln(1.0 - y); 
 	}
 }
 
-double special::bessk0(double x)
+double special::ConfluentHypergeometric::asym_start(const std::vector<double> &c)
 {
-	//Returns the modified Bessel function K0(x) for positive real x
-	double y,ans;
-	if(x<=2.0){
-		y=template_funcs::DSQR(x)/4.0;
-		ans=(-log(x/2.0)*bessi0(x))+(-0.57721566+y*(0.42278420
-			+y*(0.23069756+y*(0.3488590e-1+y*(0.262698e-2
-			+y*(0.10750e-3+y*0.74e-5))))));
+	// Smallest x at which a term c[k] x^{-k} of the asymptotic series sum_{k} c[k] x^{-k} falls below EPS
+	// Checked at every fourth term, which is close enough for choosing between regions
+	// A series that terminates within CHF_NASY terms is exact for all x
+
+	int k, n = static_cast<int>( c.size() ); 
+	double xs = HUGE_VAL; 
+
+	if(n <= CHF_NASY) return 0.0; 
+
+	for(k=4; k<n; k+=4){
+		xs = std::min( xs, exp( ( log(fabs(c[k])) - log(EPS) ) / k ) ); 
 	}
-	else{
-		y=2.0/x;
-		ans=(exp(-x)/sqrt(x))*(1.25331414+y*(-0.7832358e-1
-			+y*(0.2189568e-1+y*(-0.1062446e-1+y*(0.587872e-2
-			+y*(-0.251540e-2+y*0.53208e-3))))));
+
+	return xs; 
+}
+
+double special::ConfluentHypergeometric::series_cost(const KummerSet &s, double x) const
+{
+	// Estimated number of terms of the power series of M(alpha, beta, x) at x >= 0
+	// Terms grow until the ratio (alpha+k) x / ( (beta+k) (k+1) ) falls below one, at k = kpeak, and then decay roughly
+	// like a Poisson distribution, so the tail is taken to be of length about 6 sqrt(kpeak)
+
+	double p, q, disc, kpeak; 
+
+	if(s.poly) return 1.0 - s.alpha; 
+
+	// kpeak is the larger root of k^2 + (beta + 1 - x) k + beta - alpha x = 0
+	p = s.beta + 1.0 - x; 
+	q = s.beta - s.alpha * x; 
+	disc = p*p - 4.0*q; 
+	kpeak = ( disc > 0.0 ? std::max( 0.5*( -p + sqrt(disc) ), 0.0 ) : 0.0 ); 
+
+	return kpeak + 6.0*sqrt(kpeak) + 30.0; 
+}
+
+double special::ConfluentHypergeometric::M_series(const KummerSet &s, double x, double *asum) const
+{
+	// Power series of M(alpha, beta, x), A&S 13.1.2
+	// Tabulated term ratios are used while they last
+	// asum returns the sum of the absolute values of the terms, which measures the cancellation in the sum
+
+	static const int MAXIT = 10000; 
+
+	int k, nt = static_cast<int>( s.ser.size() ); 
+	double sum, t, as; 
+
+	sum = t = as = 1.0; 
+
+	for(k=0; k<MAXIT; k++){
+
+		t *= ( k < nt ? s.ser[k] : (s.alpha + k) / ( (s.beta + k) * (k + 1.0) ) ) * x; 
+
+		sum += t; 
+		as += fabs(t); 
+
+		if(t == 0.0) break; 
+
+		if( fabs(t) <= EPS*fabs(sum) && fabs( (s.alpha + k + 1.0) * x ) < fabs( (s.beta + k + 1.0) * (k + 2.0) ) ) break; 
 	}
-	return ans;
+
+	if(k == MAXIT) std::cerr<<"ConfluentHypergeometric: power series failed to converge\n"; 
+
+	if(asum != nullptr) *asum = as; 
+
+	return sum; 
 }
 
-double special::bessk1(double x)
+bool special::ConfluentHypergeometric::M_asymp(const KummerSet &s, double x, double &val) const
 {
-	//Returns the modified Bessel function K1(x) for real positive x	
-	double y,ans;
-	if(x<=2.0){
-		y=x*x/4.0;
-		ans=(log(x/2.0)*bessi1(x))+(1.0/x)*(1.0+y*(0.15443144
-			+y*(-0.67278579+y*(-0.18156897+y*(-0.1919402e-1
-			+y*(-0.110404e-2+y*(-0.4686e-4)))))));
+	// Asymptotic expansion of M(alpha, beta, x) for large x > 0, A&S 13.5.1
+	// The dominant series is summed until its terms fall below EPS relative to the sum, false is returned when its
+	// terms start to grow again first, or grow beyond CHF_ASY_GROW. The subdominant series is summed up to its smallest term
+
+	int k; 
+	int na = static_cast<int>( s.asy.size() ), ns = static_cast<int>( s.sub.size() ); 
+	bool tab = ( na > 0 ), conv = false, past = false; 
+	double w, wk, t, tn, S1, S2, lnx; 
+
+	w = 1.0 / x; 
+
+	// dominant series
+	S2 = t = wk = 1.0; 
+	for(k=0; k<CHF_NASY; k++){
+		if(tab){
+			wk *= w; 
+			tn = ( k + 1 < na ? s.asy[k + 1] * wk : 0.0 ); 
+		}
+		else{
+			tn = t * ( ( (s.beta - s.alpha + k) * (1.0 - s.alpha + k) ) / (k + 1.0) ) * w; 
+		}
+		if(tn == 0.0){
+			conv = true; 
+			break; 
+		}
+		if(fabs(tn) < fabs(t)) past = true; 
+		else if(past || fabs(tn) > CHF_ASY_GROW) break; 
+		S2 += tn; 
+		t = tn; 
+		if(fabs(t) <= EPS*fabs(S2)){
+			conv = true; 
+			break; 
+		}
 	}
-	else{
-		y=2.0/x;
-		ans=(exp(-x)/sqrt(x))*(1.25331414+y*(0.23498619
-			+y*(-0.3655620e-1+y*(0.1504268e-1+y*(-0.780353e-2
-			+y*(0.325614e-2+y*(-0.68245e-3)))))));
+
+	if(!conv) return false; 
+
+	// subdominant series
+	S1 = 0.0; 
+	if(s.sgn2 != 0){
+		S1 = t = wk = 1.0; 
+		past = false; 
+		for(k=0; k<CHF_NASY; k++){
+			if(tab){
+				wk *= -w; 
+				tn = ( k + 1 < ns ? s.sub[k + 1] * wk : 0.0 ); 
+			}
+			else{
+				tn = -t * ( ( (s.alpha + k) * (1.0 + s.alpha - s.beta + k) ) / (k + 1.0) ) * w; 
+			}
+			if(tn == 0.0) break; 
+			if(fabs(tn) < fabs(t)) past = true; 
+			else if(past || fabs(tn) > CHF_ASY_GROW) break; 
+			S1 += tn; 
+			t = tn; 
+			if(fabs(t) <= EPS*fabs(S1)) break; 
+		}
 	}
-	return ans;
+
+	lnx = log(x); 
+
+	val = ( s.sgn1 == 0 ? 0.0 : s.sgn1 * exp( s.lg1 + x + (s.alpha - s.beta)*lnx ) * S2 ); 
+	if(s.sgn2 != 0) val += s.sgn2 * exp( s.lg2 - s.alpha*lnx ) * S1; 
+
+	return true; 
 }
 
-double special::bessk(int n,double x)
+double special::ConfluentHypergeometric::M_recur(const KummerSet &s, double x) const
 {
-	//Returns the modified Bessel function Kn(x) for n >=2
-	int j;
-	double bk,bkm,bkp,tox;
+	// M(alpha, beta, x) for alpha > 2 by forward recurrence in alpha, A&S 13.4.1
+	// alpha M(alpha+1) = (2 alpha - beta + x) M(alpha) + (beta - alpha) M(alpha-1)
+	// started from asymptotic values at alpha0 + 1 and alpha0 + 2, alpha0 = alpha - floor(alpha)
+	// M is the dominant solution for increasing alpha when x > 0, so the recurrence is stable
 
-	if(n<2) std::cerr<<"Index n less than 2 in bessk\n";
+	int k, n; 
+	double m0, m1, m2, al; 
 
-	tox=2.0/x;
-	bkm=bessk0(x);
-	bk=bessk1(x);
-	for(j=1;j<n;j++){
-		bkp=bkm+j*tox*bk;
-		bkm=bk;
-		bk=bkp;
+	const KummerSet &s0 = sets[s.seed]; 
+	const KummerSet &s1 = sets[s.seed + 1]; 
+
+	if( !M_asymp(s0, x, m0) || !M_asymp(s1, x, m1) ) return M_series(s, x); 
+
+	al = s1.alpha; 
+	n = static_cast<int>( floor(s.alpha - s1.alpha + 0.5) ); 
+
+	for(k=0; k<n; k++){
+		m2 = ( (2.0*al - s.beta + x)*m1 + (s.beta - al)*m0 ) / al; 
+		m0 = m1; 
+		m1 = m2; 
+		al += 1.0; 
 	}
-	return bk;
+
+	return m1; 
 }
 
-double special::bessel_K(int n,double x)
+double special::ConfluentHypergeometric::M_brecur(const KummerSet &s, double x) const
 {
-	if(n==0){
-		return bessk0(x);
-	}
-	else if(n==1){
-		return bessk1(x);
+	// M(alpha, beta, x) for alpha < -1, x > 0 by backward recurrence in beta, A&S 13.4.2
+	// beta (beta-1) M(beta-1) = beta (beta - 1 + x) M(beta) - x (beta - alpha) M(beta+1)
+	// Unless M is a polynomial it grows like e^{x} and dominates the second solution downwards, so the recurrence is stable,
+	// also through beta < 0. It starts from the power series at B = beta + N >= |alpha| x / 2, whose terms are bounded by
+	// (|alpha| x / B)^k / k! so that it hardly cancels. Beyond CHF_NBREC steps the Wronskian is used instead
+
+	int k, N; 
+	double bb, m0, m1, m2; 
+	KummerSet s0, s1; 
+
+	N = static_cast<int>( std::min( ceil( std::max( 0.5*fabs(s.alpha)*x - s.beta, 0.0 ) ), static_cast<double>(CHF_NBREC) + 1.0 ) ) + 2; 
+
+	if(N > CHF_NBREC) return ( s.useed >= 0 ? M_wronskian(s, x) : M_series(s, x) ); 
+
+	s0.alpha = s1.alpha = s.alpha; 
+	s0.beta = s.beta + N; s1.beta = s0.beta + 1.0; 
+
+	m1 = M_series(s0, x); 
+	m2 = M_series(s1, x); 
+
+	bb = s0.beta; 
+	for(k=0; k<N; k++){
+		// m1 = M(bb), m2 = M(bb+1)
+		m0 = ( bb*(bb - 1.0 + x)*m1 - x*(bb - s.alpha)*m2 ) / ( bb*(bb - 1.0) ); 
+		m2 = m1; 
+		m1 = m0; 
+		bb -= 1.0; 
 	}
-	else{
-		return bessk(n,x);
+
+	return m1; 
+}
+
+static double kummer_poly_recur(int n, double beta, double x)
+{
+	// M(-n, beta, x) by recurrence in alpha, A&S 13.4.1, downwards from M(0) = 1 and M(-1) = 1 - x / beta
+	// (beta - alpha) M(alpha-1) = (beta - 2 alpha - x) M(alpha) + alpha M(alpha+1)
+
+	int k; 
+	double al, m0, m1, m2; 
+
+	if(n == 0) return 1.0; 
+
+	m2 = 1.0; 
+	m1 = 1.0 - x / beta; 
+	al = -1.0; 
+
+	for(k=1; k<n; k++){
+		// m1 = M(al), m2 = M(al+1)
+		m0 = ( (beta - 2.0*al - x)*m1 + al*m2 ) / (beta - al); 
+		m2 = m1; 
+		m1 = m0; 
+		al -= 1.0; 
 	}
+
+	return m1; 
 }
 
-void special::bessjy(double x, double xnu, double *rj, double *ry, double *rjp, double *ryp)
+double special::ConfluentHypergeometric::M_arecur(const KummerSet &s, double x) const
 {
-	// Returns the Bessel functions J_{\nu}(x), Y_{\nu}(x) and their derivatives for x > 0 and \nu >= 0
-	// J_{\nu}(x) is stored in rj
-	// Y_{\nu}(x) is stored in ry
-	// J_{\nu}'(x) is stored in rjp
-	// Y_{\nu}'(x) is stored in ryp
+	// M(alpha, beta, x) for alpha = -n, n > 1, x > 0, where the power series cancels
+	// The recurrence in alpha is the three term recurrence of the Laguerre polynomials, which is stable both between the
+	// zeros and beyond them, where M is too small to be computed by the recurrence in beta. It goes wrong for beta < 0 and
+	// x < -beta, there M is found at beta + K and beta + K + 1 > 0, K = ceil(-beta) + 1, and the recurrence in beta,
+	// A&S 13.4.2, is run K steps downwards
+	// beta (beta-1) M(beta-1) = beta (beta - 1 + x) M(beta) - x (beta - alpha) M(beta+1)
 
-	int i,isign,l,nl;
-	double a,b,br,bi,c,cr,ci,d,del,del1,den,di,dlr,dli,dr,e,f,fact,fact2,
-		fact3,ff,gam,gam1,gam2,gammi,gampl,h,p,pimu,pimu2,q,r,rjl,
-		rjl1,rjmu,rjp1,rjpl,rjtemp,ry1,rymu,rymup,rytemp,sum,sum1,
-		temp,w,x2,xi,xi2,xmu,xmu2;
+	int k, n, K; 
+	double bb, m0, m1, m2; 
 
-	int MAXIT = 10000; 
-	double XMIN = 2.0; 
+	n = static_cast<int>( floor(-s.alpha + 0.5) ); 
+
+	if(s.beta > 0.0 || x >= -s.beta) return kummer_poly_recur(n, s.beta, x); 
+
+	K = static_cast<int>( ceil(-s.beta) ) + 1; 
+	bb = s.beta + K; 
+
+	m1 = kummer_poly_recur(n, bb, x); 
+	m2 = kummer_poly_recur(n, bb + 1.0, x); 
+
+	for(k=0; k<K; k++){
+		// m1 = M(bb), m2 = M(bb+1)
+		m0 = ( bb*(bb - 1.0 + x)*m1 - x*(bb - s.alpha)*m2 ) / ( bb*(bb - 1.0) ); 
+		m2 = m1; 
+		m1 = m0; 
+		bb -= 1.0; 
+	}
+
+	return m1; 
+}
+
+double special::ConfluentHypergeometric::M_wronskian(const KummerSet &s, double x) const
+{
+	// M(alpha, beta, x) for alpha < -1, x > 0, where the power series suffers cancellation and neither direction of the
+	// recurrence in alpha is stable. The method follows Steed's method in bessjy
+	// M is the minimal solution of the recurrence in beta, A&S 13.4.2, so r = M(alpha, beta+1, x) / M(alpha, beta, x)
+	// is given by the continued fraction
+	// r = beta / D, D = B_0 + A_1 / (B_1 + A_2 / (B_2 + ...)), B_k = beta + k + x, A_k = -x (beta + k - alpha)
+	// which is summed by the modified Lentz method. Then M' / M = 1 - (beta - alpha) r / beta, A&S 13.4.11, and with
+	// U' = U(alpha, beta, x) - U(alpha, beta+1, x), A&S 13.4.25, the Wronskian, A&S 13.1.22,
+	// M U' - M' U = -Gamma(beta) / Gamma(alpha) x^{-beta} e^{x}
+	// fixes M. U is computed stably for alpha < 0 by downward recurrence
+
+	static const int MAXIT = 100000; 
+
+	int k; 
+	double f, C, D, delta, u0, u1, r; 
+
+	// modified Lentz
+	f = s.beta + x; 
+	if(f == 0.0) f = FPMIN; 
+	C = f; 
+	D = 0.0; 
+	for(k=1; k<=MAXIT; k++){
+		const double Bk = s.beta + k + x; 
+		const double Ak = -x * (s.beta + k - s.alpha); 
+		D = Bk + Ak*D; 
+		if(D == 0.0) D = FPMIN; 
+		C = Bk + Ak/C; 
+		if(C == 0.0) C = FPMIN; 
+		D = 1.0 / D; 
+		delta = C*D; 
+		f *= delta; 
+		if(fabs(delta - 1.0) <= EPS) break; 
+	}
+
+	if(k > MAXIT) std::cerr<<"ConfluentHypergeometric: continued fraction failed to converge\n"; 
+
+	r = s.beta / f; 
+
+	u0 = U_eval(usets[s.useed], x); 
+	u1 = U_eval(usets[s.useed + 1], x); 
+
+	return -s.sgn1 * exp( s.lg1 - s.beta*log(x) + x ) / ( (u0 - u1) - ( 1.0 - ( (s.beta - s.alpha) / s.beta ) * r ) * u0 ); 
+}
+
+double special::ConfluentHypergeometric::M_pos(int set, double x) const
+{
+	// M(alpha, beta, x) at x > 0 from the cheapest region that is accurate
+
+	double val, asum; 
+
+	const KummerSet &s = sets[set]; 
+
+	if(!s.poly && x >= s.xasym && M_asymp(s, x, val)){
+		return val; 
+	}
+	else if(s.alpha < -1.0){
+		// the series alternates in sign and cancels unless x is small, or large enough for its last terms to dominate
+		val = M_series(s, x, &asum); 
+		if( asum <= CHF_COND*fabs(val) ) return val; 
+		if(s.poly) return M_arecur(s, x); 
+		return M_brecur(s, x); 
+	}
+	else if(s.poly){
+		return M_series(s, x); 
+	}
+	else if( s.seed >= 0 && x >= std::max(sets[s.seed].xasym, sets[s.seed + 1].xasym) && 
+		( s.alpha - sets[s.seed].alpha ) + 2.0*CHF_ASY_COST < series_cost(s, x) ){
+		return M_recur(s, x); 
+	}
+	else if(s.useed >= 0 && x > CHF_XSMALL){
+		return M_wronskian(s, x); 
+	}
+	else{
+		return M_series(s, x); 
+	}
+}
+
+double special::ConfluentHypergeometric::M(double x) const
+{
+	// Kummer's function M(a, b, x) for real x
+
+	try{
+		if(valid_M){
+			if(x == 0.0){
+				return 1.0; 
+			}
+			else if(x > 0.0){
+				return M_pos(0, x); 
+			}
+			else if( sets[0].poly && ( pb > 0.0 || sets[1].poly ) ){
+				// all terms have the same sign when b > 0
+				return M_series(sets[0], x); 
+			}
+			else{
+				// Kummer's transformation
+				return exp(x) * M_pos(1, -x); 
+			}
+		}
+		else{
+			std::string reason = "Error: double special::ConfluentHypergeometric::M(double x) const\n"; 
+			reason += "b = " + template_funcs::toString(pb, 3) + " is a non-positive integer\n"; 
+			throw std::invalid_argument(reason); 
+		}
+	}
+	catch(std::invalid_argument &e){
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
+	}
+}
+
+void special::ConfluentHypergeometric::M(int n, const double *x, double *res) const
+{
+	// M(a, b, x[i]) for i = 0, .., n-1
+
+	for(int i=0; i<n; i++){
+		res[i] = M(x[i]); 
+	}
+}
+
+double special::ConfluentHypergeometric::U_poly(double a, double b, double x) const
+{
+	// U(-m, b, x) = (-1)^m sum_{s=0}^{m} C(m, s) (b+s)_{m-s} (-x)^s, DLMF 13.2.7
+	// The coefficients are generated from s = m downwards and the polynomial is evaluated by Horner's rule
+
+	int s, m = static_cast<int>( floor(-a + 0.5) ); 
+	double q, sum; 
+
+	q = sum = 1.0; 
+	for(s=m-1; s>=0; s--){
+		q *= -( (b + s) * (s + 1.0) ) / (m - s); 
+		sum = sum*x + q; 
+	}
+
+	return sum; 
+}
+
+double special::ConfluentHypergeometric::U_log(double a, int n, double x) const
+{
+	// U(a, n+1, x) for integer n >= 0, DLMF 13.2.9
+	// U = (-1)^{n+1} / ( n! Gamma(a-n) ) sum_{k} (a)_k / ( (n+1)_k k! ) x^k ( ln x + psi(a+k) - psi(1+k) - psi(n+k+1) )
+	//   + 1 / Gamma(a) sum_{k=1}^{n} (k-1)! (1-a+k)_{n-k} / (n-k)! x^{-k}
+
+	static const int MAXIT = 1000; 
+	static const double EULER_GAMMA = 0.57721566490153286061; 
+
+	int j, k; 
+	double rg, lsum, fsum, coef, term, lnx, psia, psi1, psin, poch; 
+
+	lsum = 0.0; 
+	rg = probability::rgamma(a - n); 
+	if(rg != 0.0){
+		lnx = log(x); 
+		psia = probability::digamma(a); 
+		psi1 = psin = -EULER_GAMMA; 
+		for(k=1; k<=n; k++) psin += 1.0 / k; 
+		coef = 1.0; 
+
+		for(k=0; k<MAXIT; k++){
+			term = coef * ( lnx + psia - psi1 - psin ); 
+			lsum += term; 
+			if( fabs(term) <= EPS*fabs(lsum) && k > x ) break; 
+			coef *= ( (a + k) / ( (n + k + 1.0) * (k + 1.0) ) ) * x; 
+			psia += 1.0 / (a + k); 
+			psi1 += 1.0 / (k + 1.0); 
+			psin += 1.0 / (n + k + 1.0); 
+		}
+
+		if(k == MAXIT) std::cerr<<"ConfluentHypergeometric: logarithmic series failed to converge\n"; 
+
+		lsum *= ( n % 2 == 0 ? -1.0 : 1.0 ) * rg / probability::factorial(n); 
+	}
+
+	fsum = 0.0; 
+	rg = probability::rgamma(a); 
+	if(n > 0 && rg != 0.0){
+		for(k=n; k>=1; k--){
+			poch = 1.0; 
+			for(j=0; j<n-k; j++) poch *= (1.0 - a + k + j); 
+			fsum = fsum / x + probability::factorial(k - 1) * poch / probability::factorial(n - k); 
+		}
+		fsum *= rg / x; 
+	}
+
+	return lsum + fsum; 
+}
+
+double special::ConfluentHypergeometric::U_small(const TricomiSet &t, double x, double *cond) const
+{
+	// U(a, b, x) for small x > 0, A&S 13.1.3
+	// U = Gamma(1-b) / Gamma(a-b+1) M(a, b, x) + Gamma(b-1) / Gamma(a) x^{1-b} M(a-b+1, 2-b, x)
+	// For integer b the logarithmic form is used, for b <= 0 after Kummer's transformation U(a, b, x) = x^{1-b} U(a-b+1, 2-b, x)
+	// cond returns the sum of the absolute values of all terms relative to |U|, the factor by which cancellation magnifies
+	// rounding errors, it is only measured for non-integer b and is HUGE_VAL otherwise
+
+	if(t.bint){
+		int nb = static_cast<int>( floor(t.b + 0.5) ); 
+
+		if(cond != nullptr) *cond = HUGE_VAL; 
+
+		return ( nb >= 1 ? U_log(t.a, nb - 1, x) : pow(x, 1.0 - nb) * U_log(t.a - nb + 1.0, 1 - nb, x) ); 
+	}
+	else{
+		KummerSet s1, s2; 
+		double p2, m1, m2, as1, as2, val; 
+
+		s1.alpha = t.a; s1.beta = t.b; 
+		s2.alpha = t.a - t.b + 1.0; s2.beta = 2.0 - t.b; 
+
+		p2 = t.g2 * pow(x, 1.0 - t.b); 
+		m1 = M_series(s1, x, &as1); 
+		m2 = M_series(s2, x, &as2); 
+
+		val = t.g1 * m1 + p2 * m2; 
+
+		if(cond != nullptr) *cond = ( fabs(t.g1) * as1 + fabs(p2) * as2 ) / fabs(val); 
+
+		return val; 
+	}
+}
+
+bool special::ConfluentHypergeometric::U_asymp(const TricomiSet &t, double x, double &val) const
+{
+	// Asymptotic expansion of U(a, b, x) for large x > 0, A&S 13.5.2
+	// U ~ x^{-a} sum_{k} (a)_k (a-b+1)_k / k! (-x)^{-k}
+	// false is returned when the terms start to grow again before they fall below EPS relative to the sum
+
+	int k; 
+	bool tab = !t.asy.empty(), conv = false, past = false; 
+	double w, wk, c, cn, S; 
+
+	w = -1.0 / x; 
+	S = c = wk = 1.0; 
+	for(k=0; k<CHF_NASY; k++){
+		if(tab){
+			wk *= w; 
+			cn = t.asy[k + 1] * wk; 
+		}
+		else{
+			cn = c * ( ( (t.a + k) * (t.a - t.b + 1.0 + k) ) / (k + 1.0) ) * w; 
+		}
+		if(fabs(cn) < fabs(c)) past = true; 
+		else if(past || fabs(cn) > CHF_ASY_GROW) break; 
+		S += cn; 
+		c = cn; 
+		if(fabs(c) <= EPS*fabs(S)){
+			conv = true; 
+			break; 
+		}
+	}
+
+	if(conv) val = pow(x, -t.a) * S; 
+
+	return conv; 
+}
+
+double special::ConfluentHypergeometric::U_quad(const TricomiSet &t, double x) const
+{
+	// U(a, b, x) from its integral representation, A&S 13.2.5, with the substitution t -> t / x
+	// U(a, b, x) = x^{-a} / Gamma(a) int_{0}^{infty} t^{a-1} e^{-t} (1 + t/x)^{b-a-1} dt
+	// The integrand has its branch point at t = -x so the Gauss-Laguerre rule converges quickly away from x = 0
+	// For a <= 0 the integral is taken at a0 = a + nrec and a0 + 1 and A&S 13.4.15 is used downwards
+	// U(a-1) = (2a - b + x) U(a) - a (a - b + 1) U(a+1), U is the dominant solution for decreasing a
+
+	int i, k; 
+	double a0, u0, u1, um, al, p; 
+
+	a0 = t.a + t.nrec; 
+
+	std::vector<double> lx0, lw0, lx1, lw1; 
+	const std::vector<double> *x0 = &t.qx0, *w0 = &t.qw0, *x1 = &t.qx1, *w1 = &t.qw1; 
+
+	if(t.qx0.empty()){
+		lx0.resize(CHF_NQUAD); lw0.resize(CHF_NQUAD); 
+		gaulag(CHF_NQUAD, a0 - 1.0, &lx0[0], &lw0[0], probability::gammln(a0)); 
+		x0 = &lx0; w0 = &lw0; 
+		if(t.nrec > 0){
+			lx1.resize(CHF_NQUAD); lw1.resize(CHF_NQUAD); 
+			gaulag(CHF_NQUAD, a0, &lx1[0], &lw1[0], probability::gammln(a0 + 1.0)); 
+			x1 = &lx1; w1 = &lw1; 
+		}
+	}
+
+	p = t.b - a0 - 1.0; 
+	u0 = 0.0; 
+	for(i=0; i<CHF_NQUAD; i++) u0 += (*w0)[i] * exp( p * log1p( (*x0)[i] / x ) ); 
+	u0 *= pow(x, -a0); 
+
+	if(t.nrec > 0){
+		p -= 1.0; 
+		u1 = 0.0; 
+		for(i=0; i<CHF_NQUAD; i++) u1 += (*w1)[i] * exp( p * log1p( (*x1)[i] / x ) ); 
+		u1 *= pow(x, -a0 - 1.0); 
+
+		al = a0; 
+		for(k=0; k<t.nrec; k++){
+			um = (2.0*al - t.b + x)*u0 - al*(al - t.b + 1.0)*u1; 
+			u1 = u0; 
+			u0 = um; 
+			al -= 1.0; 
+		}
+	}
+
+	return u0; 
+}
+
+double special::ConfluentHypergeometric::U_eval(const TricomiSet &t, double x) const
+{
+	// U(a, b, x) at x > 0 for a <= 2 or x >= xasym
+
+	double val; 
+
+	if(t.poly == 1){
+		return U_poly(t.a, t.b, x); 
+	}
+	else if(t.poly == 2){
+		return pow(x, 1.0 - t.b) * U_poly(t.a - t.b + 1.0, 2.0 - t.b, x); 
+	}
+	else if(x >= t.xasym && U_asymp(t, x, val)){
+		return val; 
+	}
+	else if(x <= CHF_XSMALL){
+		return U_small(t, x); 
+	}
+	else{
+		// the quadrature converges slowly when |b - a - 1| is large and x small, the small x form is then usually
+		// dominated by its x^{1-b} term and is used if its cancellation is small
+		double cond; 
+
+		if( !t.bint && fabs(t.b - 1.0) > x ){
+			val = U_small(t, x, &cond); 
+			if(cond <= CHF_COND_QUAD) return val; 
+		}
+
+		return U_quad(t, x); 
+	}
+}
+
+double special::ConfluentHypergeometric::U_miller(double x) const
+{
+	// U(a, b, x) for a > 2 below the asymptotic region
+	// U is the minimal solution of A&S 13.4.15 as a -> infinity, Miller's algorithm is used: the recurrence is started
+	// with trial values at a + N, run downwards to a0 = a - floor(a) and normalised by U(a0, b, x)
+	// N is doubled until the normalised value at a settles to within MILLER_TOL, the rounding errors of the recurrence
+	// leave it moving by about 1e-13 once converged. NaN is returned if it has not settled by NMAX
+	// U(a, b, x) called only for b <= a + 1, beyond that U is not minimal over the range of a used here and Kummer's
+	// transformation is applied instead
+
+	static const int NSTART = 16; 
+	static const int NMAX = 16384; 
+	static const double BIG = 1.0e200; 
+	static const double MILLER_TOL = 1.0e3*EPS; 
+
+	int k, n, N; 
+	double y0, y1, ym, al, ya, val, prev; 
+
+	const TricomiSet &t0 = usets[1]; 
+
+	n = static_cast<int>( floor(pa - t0.a + 0.5) ); // steps from a to a0
+
+	val = prev = 0.0; 
+	for(N=NSTART; N<=NMAX; N*=2){
+		al = pa + N; 
+		y1 = 0.0; 
+		y0 = 1.0; 
+		ya = 0.0; 
+		for(k=0; k<N+n; k++){
+			// y0 = y(al), y1 = y(al + 1)
+			ym = (2.0*al - pb + x)*y0 - al*(al - pb + 1.0)*y1; 
+			y1 = y0; 
+			y0 = ym; 
+			al -= 1.0; 
+			if(k == N - 1) ya = y0; 
+			if(fabs(y0) > BIG){
+				y0 /= BIG; y1 /= BIG; ya /= BIG; 
+			}
+		}
+
+		val = ( ya / y0 ) * U_eval(t0, x); 
+
+		if(N > NSTART && fabs(val - prev) <= MILLER_TOL*fabs(val)) break; 
+
+		prev = val; 
+	}
+
+	if(N > NMAX){
+		std::cerr<<"ConfluentHypergeometric: Miller's algorithm for U failed to converge\n"; 
+		return std::numeric_limits<double>::quiet_NaN(); 
+	}
+
+	return val; 
+}
+
+double special::ConfluentHypergeometric::U(double x) const
+{
+	// Tricomi's function U(a, b, x) for x > 0, and at x = 0 when b < 1
+
+	try{
+		if( x > 0.0 || ( x == 0.0 && pb < 1.0 ) ){
+			if(x == 0.0){
+				return probability::gammf(1.0 - pb) * probability::rgamma(pa - pb + 1.0); 
+			}
+			else if( usets[0].poly == 0 && pa > 2.0 ){
+				// the quadrature loses accuracy as a grows, the recurrence converges slowly when a x is small
+				double val; 
+
+				if(x >= usets[0].xasym && U_asymp(usets[0], x, val)){
+					return val; 
+				}
+				else if(pb > pa + 1.0){
+					// Kummer's transformation to a - b + 1 < 0, where U_eval is accurate
+					return pow(x, 1.0 - pb) * U_eval(usets[1], x); 
+				}
+				else if(x <= CHF_XSMALL && pa*x <= CHF_AXSMALL){
+					return U_small(usets[0], x); 
+				}
+				else{
+					// Miller's algorithm converges slowly when b is large, where the small x form usually does not cancel
+					double cond; 
+
+					if( !usets[0].bint && fabs(pb - 1.0) > x ){
+						val = U_small(usets[0], x, &cond); 
+						if(cond <= CHF_COND) return val; 
+					}
+
+					return U_miller(x); 
+				}
+			}
+			else{
+				return U_eval(usets[0], x); 
+			}
+		}
+		else{
+			std::string reason = "Error: double special::ConfluentHypergeometric::U(double x) const\n"; 
+			reason += "U(a, b, x) is not defined at x = " + template_funcs::toString(x, 3) + "\n"; 
+			throw std::invalid_argument(reason); 
+		}
+	}
+	catch(std::invalid_argument &e){
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
+	}
+}
+
+void special::ConfluentHypergeometric::U(int n, const double *x, double *res) const
+{
+	// U(a, b, x[i]) for i = 0, .., n-1
+
+	for(int i=0; i<n; i++){
+		res[i] = U(x[i]); 
+	}
+}
+
+double special::bessj0(double x)
+{
+	//Return the Bessel Function J0(x) for all real x
+	double z,ax,xx,y,ans,ans1,ans2;
+
+	if((ax=fabs(x))<8.0){
+		y=template_funcs::DSQR(x);
+		ans1=57568490574.0+y*(-13362590354.0+y*(651619640.7+
+			y*(-11214424.18+y*(77392.33017+y*(-184.9052456)))));
+		ans2=57568490411.0+y*(1029533985.0+y*(9494680.718+
+			y*(59272.64853+y*(267.8532712+y))));
+		ans=ans1/ans2;
+	}
+	else{
+		z=8.0/ax;
+		y=template_funcs::DSQR(z);
+		xx=ax-0.785398164;
+		ans1=1.0+y*(-0.1098628627e-2+y*(0.2734510407e-4+
+			y*(-0.2073370639e-5+y*0.2093887211e-6)));
+		ans2=-0.1562499995e-1+y*(0.1430488765e-3+
+			y*(-0.6911147651e-5+y*(0.7621095161e-6-y*0.934945152e-7)));
+		ans=sqrt(0.636619772/ax)*(cos(xx)*ans1-z*sin(xx)*ans2);
+	}
+	return ans;
+}
+
+double special::bessj1(double x)
+{
+	//Returns the Bessel function J1(x) for all real x
+	double ax,z,xx,y,ans,ans1,ans2;
+
+	if((ax=fabs(x))<8.0){
+		y=template_funcs::DSQR(x);
+		ans1=x*(72362614232.0+y*(-7895059235.0+y*(242396853.1
+			+y*(-2972611.439+y*(15704.48260+y*(-30.16036606))))));
+		ans2=144725228442.0+y*(2300535178.0+y*(18583304.74
+			+y*(99447.43394+y*(376.9991397+y))));
+		ans=ans1/ans2;
+	}
+	else{
+		z=8.0/ax;
+		y=template_funcs::DSQR(z);
+		xx=ax-2.356194491;
+		ans1=1.0+y*(0.183105e-2+y*(-0.3516396496e-4
+			+y*(0.245752017e-5+y*(-0.240337019e-6))));
+		ans2=0.04687499995+y*(-0.2002690873e-3
+			+y*(0.8449199096e-5+y*(-0.88228987e-6
+			+y*0.105787412e-6)));
+		ans=sqrt(0.636619772/ax)*(cos(xx)*ans1-z*sin(xx)*ans2);
+		if(x<0.0) ans=-ans;
+	}
+	return ans;
+}
+
+double special::bessj(int n,double x)
+{
+	//Returns te Bessel function Jn(x) for all real x and n >= 2
+	int j,jsum,m;
+	double ax,bj,bjm,bjp,sum,tox,ans;
+
+	static const double ACC=40.0;
+	static const double BIGNO=1e10;
+	static const double BIGNI=1.0e-10;
+
+	if(n<2){
+		std::cerr<<"Index n less than 2 in bessj\n";	
+	}
+	ax=fabs(x);
+	if(ax==0.0){
+		return 0.0;	
+	}
+	else if(ax>static_cast<double>(n)){
+		//Upwards recurrence from J0 and J1
+		tox=2.0/ax;
+		bjm=bessj0(ax);
+		bj=bessj1(ax);
+		for(j=1;j<n;j++){
+			bjp=j*tox*bj-bjm;
+			bjm=bj;
+			bj=bjp;
+		}
+		ans=bj;
+	}
+	else{
+		//Downwards recurrence from an even m here computed
+		tox=2.0/ax;
+		m=2*((n+static_cast<int>(sqrt(ACC*n)))/2);
+		jsum=0;
+		bjp=ans=sum=0.0;
+		bj=1.0;
+		for(j=m;j>0;j--){
+			bjm=j*tox*bj-bjp;
+			bjp=bj;
+			bj=bjm;
+			if(fabs(bj)>BIGNO){
+				bj*=BIGNI;
+				bjp*=BIGNI;
+				ans*=BIGNI;
+				sum*=BIGNI;
+			}
+			if(jsum) sum+=bj;
+			jsum=!jsum;
+			if(j==n) ans=bjp;
+		}
+		sum=2.0*sum-bj;
+		ans/=sum;
+	}
+	return x<0.0 && (n&1) ? -ans:ans; 
+}
+
+double special::bessel_J(int n,double x)
+{
+	if(n==0){
+		return bessj0(x);	
+	}
+	else if(n==1){
+		return bessj1(x);	
+	}
+	else{
+		return bessj(n,x);	
+	}
+}
+
+double special::bessy0(double x)
+{
+	//Returns the Bessel Function Y0(x) for real positive values of x
+	double z,xx,y,ans,ans1,ans2;
+
+	if(x<8.0){
+		y=template_funcs::DSQR(x);
+		ans1=-2957821389.0+y*(7062834065.0+y*(-512359803.6+
+			y*(10879881.29+y*(-86327.92757+y*228.4622733))));
+		ans2=40076544269.0+y*(745249964.8+y*(7189466.438+
+			y*(47447.26470+y*(226.1030244+y))));
+		ans=(ans1/ans2)+0.636619772*bessj0(x)*log(x);
+	}
+	else{
+		z=8.0/x;
+		y=template_funcs::DSQR(z);
+		xx=x-0.785398164;
+		ans1=1.0+y*(-0.1098628627e-2+y*(0.2734510407e-4+
+			y*(-0.2073370639e-5+y*0.2093887211e-6)));
+		ans2=-0.1562499995e-1+y*(0.1430488765e-3+
+			y*(-0.6911147651e-5+y*(0.7621095161e-6+y*(-0.934945152e-7))));
+		ans=sqrt(0.636619772/x)*(sin(xx)*ans1+z*cos(xx)*ans2);
+	}
+	return ans;
+}
+
+double special::bessy1(double x)
+{
+	//Returns the Bessel Function Y1(x) for real positive x
+	double z,xx,y,ans,ans1,ans2;
+
+	if(x<8.0){
+		y=template_funcs::DSQR(x);
+		ans1=x*(-0.4900604943e13+y*(0.1275274390e13
+			+y*(-0.5153438139e11+y*(0.7349264551e9
+			+y*(-0.4237922726e7+y*0.8511937935e4)))));
+		ans2=0.2499580570e14+y*(0.424441966e12
+			+y*(0.3733650367e10+y*(0.2245904002e8
+			+y*(0.1020426050e6+y*(0.3549632885e3+y)))));
+		ans=(ans1/ans2)+0.636619772*(bessj1(x)*log(x)-1.0/x);
+	}
+	else{
+		z=8.0/x;
+		y=template_funcs::DSQR(z);
+		xx=x-2.356194491;
+		ans1=1.0+y*(0.183105e-2+y*(-0.3516396496e-4
+			+y*(0.245752017e-5+y*(-0.240337019e-6))));
+		ans2=0.04687499995+y*(-0.2002690873e-3
+			+y*(0.8449199096e-5+y*(-0.88228987e-6
+			+y*0.105787412e-6)));
+		ans=sqrt(0.636619772/x)*(sin(xx)*ans1+z*cos(xx)*ans2);
+	}
+	return ans;
+}
+
+double special::bessy(int n,double x)
+{
+	//Returns the Bessel Function Yn(x) for n >= 2
+	int j;
+	double by,bym,byp,tox;
+
+	if(n<2){
+		std::cerr<<"Index n less than 2 in bessy\n";
+	}
+	tox=2.0/x;
+	by=bessy1(x);
+	bym=bessy0(x);
+	for(j=1;j<n;j++){
+		byp=j*tox*by-bym;
+		bym=by;
+		by=byp;
+	}
+	return by;
+}
+
+double special::bessel_Y(int n,double x)
+{
+	if(n==0){
+		return bessy0(x);
+	}
+	else if(n==1){
+		return bessy1(x);
+	}
+	else{
+		return bessy(n,x);
+	}
+}
+
+double special::bessi0(double x)
+{
+	//Returns the modified Bessel Function I0(x) for any real x
+	double ax,ans,y;
+
+	if((ax=fabs(x))<3.75){
+		y=x/3.75;
+		y*=y;
+		ans=1.0+y*(3.5156229+y*(3.0899424+y*(1.2067492
+			+y*(0.2659732+y*(0.360768e-1+y*0.45813e-2)))));
+	}
+	else{
+		y=3.75/ax;
+		ans=(exp(ax)/sqrt(ax))*(0.39894228+y*(0.132859e-1
+			+y*(0.225319e-2+y*(-0.157565e-2+y*(0.916281e-2
+			+y*(-0.2057706e-1+y*(0.2635537e-1+y*(-0.1647633e-1
+			+y*0.392377e-2))))))));
+	}
+	return ans;
+}
+
+double special::bessi1(double x)
+{
+	//Returns the modified Bessel Function I1(x) for any real x
+	double ax,ans,y;
+	if((ax=fabs(x))<3.75){
+		y=x/3.75;
+		y*=y;
+		ans=ax*(0.5+y*(0.87890594+y*(0.51498869+y*(0.15084934
+			+y*(0.2658733e-1+y*(0.301532e-2+y*0.32411e-3))))));
+	}
+	else{
+		y=3.75/ax;
+		ans=0.2282967e-1+y*(-0.2895312e-1+y*(0.1787654e-1
+			-y*0.420059e-2));
+		ans=0.39894228+y*(-0.3988024e-1+y*(-0.362018e-2
+			+y*(0.163801e-2+y*(-0.1031555e-1+y*ans))));
+		ans*=(exp(ax)/sqrt(ax));
+	}
+	return x<0.0?-ans:ans;
+}
+
+double special::bessi(int n,double x)
+{
+	//Returns the modified Bessel Function In(x) for n>=2 for any real x
+	int j;
+	double bi,bim,bip,tox,ans;
+
+	static const double ACC=40.0;
+	static const double BIGNO=1e10;
+	static const double BIGNI=1.0e-10;
+
+	if(n<2) std::cerr<<"Index n less than 2 in bessi\n";
+
+	if(x==0.0){
+		return 0.0;
+	}
+	else{
+		tox=2.0/fabs(x);
+		bip=ans=0.0;
+		bi=1.0;
+		for(j=2*(n+static_cast<int>(sqrt(ACC*n)));j>0;j--){
+			bim=bip+j*tox*bi;
+			bip=bi;
+			bi=bim;
+			if(fabs(bi)>BIGNO){
+				ans*=BIGNI;
+				bi *=BIGNI;
+				bip*=BIGNI;
+			}
+			if(j==n) ans=bip;
+		}
+		ans*=bessi0(x)/bi;
+		return x<0.0 && (n&1) ? -ans:ans;
+	}
+}
+
+double special::bessel_I(int n,double x)
+{
+	if(n==0){
+		return bessi0(x);
+	}
+	else if(n==1){
+		return bessi1(x);
+	}
+	else{
+		return bessi(n,x);
+	}
+}
+
+double special::bessk0(double x)
+{
+	//Returns the modified Bessel function K0(x) for positive real x
+	double y,ans;
+	if(x<=2.0){
+		y=template_funcs::DSQR(x)/4.0;
+		ans=(-log(x/2.0)*bessi0(x))+(-0.57721566+y*(0.42278420
+			+y*(0.23069756+y*(0.3488590e-1+y*(0.262698e-2
+			+y*(0.10750e-3+y*0.74e-5))))));
+	}
+	else{
+		y=2.0/x;
+		ans=(exp(-x)/sqrt(x))*(1.25331414+y*(-0.7832358e-1
+			+y*(0.2189568e-1+y*(-0.1062446e-1+y*(0.587872e-2
+			+y*(-0.251540e-2+y*0.53208e-3))))));
+	}
+	return ans;
+}
+
+double special::bessk1(double x)
+{
+	//Returns the modified Bessel function K1(x) for real positive x	
+	double y,ans;
+	if(x<=2.0){
+		y=x*x/4.0;
+		ans=(log(x/2.0)*bessi1(x))+(1.0/x)*(1.0+y*(0.15443144
+			+y*(-0.67278579+y*(-0.18156897+y*(-0.1919402e-1
+			+y*(-0.110404e-2+y*(-0.4686e-4)))))));
+	}
+	else{
+		y=2.0/x;
+		ans=(exp(-x)/sqrt(x))*(1.25331414+y*(0.23498619
+			+y*(-0.3655620e-1+y*(0.1504268e-1+y*(-0.780353e-2
+			+y*(0.325614e-2+y*(-0.68245e-3)))))));
+	}
+	return ans;
+}
+
+double special::bessk(int n,double x)
+{
+	//Returns the modified Bessel function Kn(x) for n >=2
+	int j;
+	double bk,bkm,bkp,tox;
+
+	if(n<2) std::cerr<<"Index n less than 2 in bessk\n";
+
+	tox=2.0/x;
+	bkm=bessk0(x);
+	bk=bessk1(x);
+	for(j=1;j<n;j++){
+		bkp=bkm+j*tox*bk;
+		bkm=bk;
+		bk=bkp;
+	}
+	return bk;
+}
+
+double special::bessel_K(int n,double x)
+{
+	if(n==0){
+		return bessk0(x);
+	}
+	else if(n==1){
+		return bessk1(x);
+	}
+	else{
+		return bessk(n,x);
+	}
+}
+
+void special::bessjy(double x, double xnu, double *rj, double *ry, double *rjp, double *ryp)
+{
+	// Returns the Bessel functions J_{\nu}(x), Y_{\nu}(x) and their derivatives for x > 0 and \nu >= 0
+	// J_{\nu}(x) is stored in rj
+	// Y_{\nu}(x) is stored in ry
+	// J_{\nu}'(x) is stored in rjp
+	// Y_{\nu}'(x) is stored in ryp
+
+	int i,isign,l,nl;
+	double a,b,br,bi,c,cr,ci,d,del,del1,den,di,dlr,dli,dr,e,f,fact,fact2,
+		fact3,ff,gam,gam1,gam2,gammi,gampl,h,p,pimu,pimu2,q,r,rjl,
+		rjl1,rjmu,rjp1,rjpl,rjtemp,ry1,rymu,rymup,rytemp,sum,sum1,
+		temp,w,x2,xi,xi2,xmu,xmu2;
+
+	int MAXIT = 10000; 
+	double XMIN = 2.0; 
 
 	if (x <= 0.0 || xnu < 0.0) std::cerr<<"bad arguments in bessjy\n";
 	nl=(x < XMIN ? (int)(xnu+0.5) : std::max(0,(int)(xnu-x+1.5)));
@@ -451,8 +1983,153 @@ void special::bessjy(double x, double xnu, double *rj, double *ry, double *rjp,
 	xmu2=xmu*xmu;
 	xi=1.0/x;
 	xi2=2.0*xi;
-	w=xi2/PI;
-	isign=1;
+	w=xi2/PI;
+	isign=1;
+	h=xnu*xi;
+	if (h < FPMIN) h=FPMIN;
+	b=xi2*xnu;
+	d=0.0;
+	c=h;
+	for (i=1;i<=MAXIT;i++) {
+		b += xi2;
+		d=b-d;
+		if (fabs(d) < FPMIN) d=FPMIN;
+		c=b-1.0/c;
+		if (fabs(c) < FPMIN) c=FPMIN;
+		d=1.0/d;
+		del=c*d;
+		h=del*h;
+		if (d < 0.0) isign = -isign;
+		if (fabs(del-1.0) < EPS) break;
+	}
+	if (i > MAXIT) std::cerr<<"x too large in bessjy; try asymptotic expansion\n";
+	rjl=isign*FPMIN;
+	rjpl=h*rjl;
+	rjl1=rjl;
+	rjp1=rjpl;
+	fact=xnu*xi;
+	for (l=nl;l>=1;l--) {
+		rjtemp=fact*rjl+rjpl;
+		fact -= xi;
+		rjpl=fact*rjtemp-rjl;
+		rjl=rjtemp;
+	}
+	if (rjl == 0.0) rjl=EPS;
+	f=rjpl/rjl;
+	if (x < XMIN) {
+		x2=0.5*x;
+		pimu=PI*xmu;
+		fact = (fabs(pimu) < EPS ? 1.0 : pimu/sin(pimu));
+		d = -log(x2);
+		e=xmu*d;
+		fact2 = (fabs(e) < EPS ? 1.0 : sinh(e)/e);
+		beschb(xmu,&gam1,&gam2,&gampl,&gammi);
+		ff=2.0/PI*fact*(gam1*cosh(e)+gam2*fact2*d);
+		e=exp(e);
+		p=e/(gampl*PI);
+		q=1.0/(e*PI*gammi);
+		pimu2=0.5*pimu;
+		fact3 = (fabs(pimu2) < EPS ? 1.0 : sin(pimu2)/pimu2);
+		r=PI*pimu2*fact3*fact3;
+		c=1.0;
+		d = -x2*x2;
+		sum=ff+r*q;
+		sum1=p;
+		for (i=1;i<=MAXIT;i++) {
+			ff=(i*ff+p+q)/(i*i-xmu2);
+			c *= (d/i);
+			p /= (i-xmu);
+			q /= (i+xmu);
+			del=c*(ff+r*q);
+			sum += del;
+			del1=c*p-i*del;
+			sum1 += del1;
+			if (fabs(del) < (1.0+fabs(sum))*EPS) break;
+		}
+		if (i > MAXIT) std::cerr<<"bessy series failed to converge\n";
+		rymu = -sum;
+		ry1 = -sum1*xi2;
+		rymup=xmu*xi*rymu-ry1;
+		rjmu=w/(rymup-f*rymu);
+	} else {
+		a=0.25-xmu2;
+		p = -0.5*xi;
+		q=1.0;
+		br=2.0*x;
+		bi=2.0;
+		fact=a*xi/(p*p+q*q);
+		cr=br+q*fact;
+		ci=bi+p*fact;
+		den=br*br+bi*bi;
+		dr=br/den;
+		di = -bi/den;
+		dlr=cr*dr-ci*di;
+		dli=cr*di+ci*dr;
+		temp=p*dlr-q*dli;
+		q=p*dli+q*dlr;
+		p=temp;
+		for (i=2;i<=MAXIT;i++) {
+			a += 2*(i-1);
+			bi += 2.0;
+			dr=a*dr+br;
+			di=a*di+bi;
+			if (fabs(dr)+fabs(di) < FPMIN) dr=FPMIN;
+			fact=a/(cr*cr+ci*ci);
+			cr=br+cr*fact;
+			ci=bi-ci*fact;
+			if (fabs(cr)+fabs(ci) < FPMIN) cr=FPMIN;
+			den=dr*dr+di*di;
+			dr /= den;
+			di /= -den;
+			dlr=cr*dr-ci*di;
+			dli=cr*di+ci*dr;
+			temp=p*dlr-q*dli;
+			q=p*dli+q*dlr;
+			p=temp;
+			if (fabs(dlr-1.0)+fabs(dli) < EPS) break;
+		}
+		if (i > MAXIT) std::cerr<<"cf2 failed in bessjy\n";
+		gam=(p-f)/q;
+		rjmu=sqrt(w/((p-f)*gam+q));
+		rjmu=template_funcs::SIGN(rjmu,rjl);
+		rymu=rjmu*gam;
+		rymup=rymu*(p+q/gam);
+		ry1=xmu*xi*rymu-rymup;
+	}
+	fact=rjmu/rjl;
+	*rj=rjl1*fact;
+	*rjp=rjp1*fact;
+	for (i=1;i<=nl;i++) {
+		rytemp=(xmu+i)*xi2*ry1-rymu;
+		rymu=ry1;
+		ry1=rytemp;
+	}
+	*ry=rymu;
+	*ryp=xnu*xi*rymu-ry1;
+}
+
+void special::bessik(double x, double xnu, double *ri, double *rk, double *rip, double *rkp)
+{
+	// Returns the modified Bessel functions I_{\nu}(x), K_{\nu}(x) and their derivatives for x > 0 and \nu >= 0
+	// I_{\nu}(x) is stored in ri
+	// K_{\nu}(x) is stored in rk
+	// I_{\nu}'(x) is stored in rip
+	// K_{\nu}'(x) is stored in rkp
+	
+	int i,l,nl;
+	double a,a1,b,c,d,del,del1,delh,dels,e,f,fact,fact2,ff,gam1,gam2,
+		gammi,gampl,h,p,pimu,q,q1,q2,qnew,ril,ril1,rimu,rip1,ripl,
+		ritemp,rk1,rkmu,rkmup,rktemp,s,sum,sum1,x2,xi,xi2,xmu,xmu2;
+
+	int MAXIT = 10000; 
+	double XMIN = 2.0;
+
+	if (x <= 0.0 || xnu < 0.0) std::cerr<<"bad arguments in bessik\n";
+	nl=(int)(xnu+0.5);
+	xmu=xnu-nl;
+	xmu2=xmu*xmu;
+	xi=1.0/x;
+	xi2=2.0*xi;
 	h=xnu*xi;
 	if (h < FPMIN) h=FPMIN;
 	b=xi2*xnu;
@@ -460,634 +2137,1553 @@ void special::bessjy(double x, double xnu, double *rj, double *ry, double *rjp,
 	c=h;
 	for (i=1;i<=MAXIT;i++) {
 		b += xi2;
-		d=b-d;
-		if (fabs(d) < FPMIN) d=FPMIN;
-		c=b-1.0/c;
-		if (fabs(c) < FPMIN) c=FPMIN;
-		d=1.0/d;
+		d=1.0/(b+d);
+		c=b+1.0/c;
 		del=c*d;
 		h=del*h;
-		if (d < 0.0) isign = -isign;
 		if (fabs(del-1.0) < EPS) break;
 	}
-	if (i > MAXIT) std::cerr<<"x too large in bessjy; try asymptotic expansion\n";
-	rjl=isign*FPMIN;
-	rjpl=h*rjl;
-	rjl1=rjl;
-	rjp1=rjpl;
-	fact=xnu*xi;
-	for (l=nl;l>=1;l--) {
-		rjtemp=fact*rjl+rjpl;
-		fact -= xi;
-		rjpl=fact*rjtemp-rjl;
-		rjl=rjtemp;
+	if (i > MAXIT) std::cerr<<"x too large in bessik; try asymptotic expansion\n";
+	ril=FPMIN;
+	ripl=h*ril;
+	ril1=ril;
+	rip1=ripl;
+	fact=xnu*xi;
+	for (l=nl;l>=1;l--) {
+		ritemp=fact*ril+ripl;
+		fact -= xi;
+		ripl=fact*ritemp+ril;
+		ril=ritemp;
+	}
+	f=ripl/ril;
+	if (x < XMIN) {
+		x2=0.5*x;
+		pimu=PI*xmu;
+		fact = (fabs(pimu) < EPS ? 1.0 : pimu/sin(pimu));
+		d = -log(x2);
+		e=xmu*d;
+		fact2 = (fabs(e) < EPS ? 1.0 : sinh(e)/e);
+		beschb(xmu,&gam1,&gam2,&gampl,&gammi);
+		ff=fact*(gam1*cosh(e)+gam2*fact2*d);
+		sum=ff;
+		e=exp(e);
+		p=0.5*e/gampl;
+		q=0.5/(e*gammi);
+		c=1.0;
+		d=x2*x2;
+		sum1=p;
+		for (i=1;i<=MAXIT;i++) {
+			ff=(i*ff+p+q)/(i*i-xmu2);
+			c *= (d/i);
+			p /= (i-xmu);
+			q /= (i+xmu);
+			del=c*ff;
+			sum += del;
+			del1=c*(p-i*ff);
+			sum1 += del1;
+			if (fabs(del) < fabs(sum)*EPS) break;
+		}
+		if (i > MAXIT) std::cerr<<"bessk series failed to converge\n";
+		rkmu=sum;
+		rk1=sum1*xi2;
+	} else {
+		b=2.0*(1.0+x);
+		d=1.0/b;
+		h=delh=d;
+		q1=0.0;
+		q2=1.0;
+		a1=0.25-xmu2;
+		q=c=a1;
+		a = -a1;
+		s=1.0+q*delh;
+		for (i=2;i<=MAXIT;i++) {
+			a -= 2*(i-1);
+			c = -a*c/i;
+			qnew=(q1-b*q2)/a;
+			q1=q2;
+			q2=qnew;
+			q += c*qnew;
+			b += 2.0;
+			d=1.0/(b+a*d);
+			delh=(b*d-1.0)*delh;
+			h += delh;
+			dels=q*delh;
+			s += dels;
+			if (fabs(dels/s) < EPS) break;
+		}
+		if (i > MAXIT) std::cerr<<"bessik: failure to converge in cf2\n";
+		h=a1*h;
+		rkmu=sqrt(PI/(2.0*x))*exp(-x)/s;
+		rk1=rkmu*(xmu+x+0.5-h)*xi;
+	}
+	rkmup=xmu*xi*rkmu-rk1;
+	rimu=xi/(f*rkmu-rkmup);
+	*ri=(rimu*ril1)/ril;
+	*rip=(rimu*rip1)/ril;
+	for (i=1;i<=nl;i++) {
+		rktemp=(xmu+i)*xi2*rk1+rkmu;
+		rkmu=rk1;
+		rk1=rktemp;
+	}
+	*rk=rkmu;
+	*rkp=xnu*xi*rkmu-rk1;
+}
+
+void special::beschb(double x, double *gam1, double *gam2, double *gampl, double *gammi)
+{
+	// Computes \Gamma_{1} and \Gamma_{2} by Chebyshev expansion for |x| <= 1/2
+	// Returns 1/\Gamma(1+x) and 1/\Gamma(1-x)
+	// This function is used to compute Bessel functions of non-integer order
+	
+	double xx;
+	static double c1[] = {
+		-1.142022680371172e0,6.516511267076e-3,
+		3.08709017308e-4,-3.470626964e-6,6.943764e-9,
+		3.6780e-11,-1.36e-13};
+	static double c2[] = {
+		1.843740587300906e0,-0.076852840844786e0,
+		1.271927136655e-3,-4.971736704e-6,-3.3126120e-8,
+		2.42310e-10,-1.70e-13,-1.0e-15};
+
+	int NUSE1 = 7; 
+	int NUSE2 = 8; 
+
+	// the expansions are set up once, so that each call is two Clenshaw recurrences without the argument checks of chebev
+	// which would also reject |x| = 1/2, where xx = 1 is the end of the interval
+	static const cheb_appr::ChebyshevApproximant cheb1(-1.0, 1.0, c1, NUSE1); 
+	static const cheb_appr::ChebyshevApproximant cheb2(-1.0, 1.0, c2, NUSE2); 
+
+	xx=8.0*x*x-1.0;
+	*gam1=cheb1(xx); 
+	*gam2=cheb2(xx); 
+	*gampl= *gam2-x*(*gam1);
+	*gammi= *gam2+x*(*gam1);
+}
+
+void special::sphbes(int n, double x, double *sj, double *sy, double *sjp, double *syp)
+{
+	// Spherical Bessel functions j_{n}(x), y_{n}(x) and their derivatives at integer order
+	// j_{n}(x) is stored in sj
+	// y_{n}(x) is stored in sy
+	// j_{n}'(x) is stored in sjp
+	// y_{n}'(x) is stored in syp
+
+	double factor,order,rj,rjp,ry,ryp;
+	double RTPIO2 = sqrt(PI_2); 
+
+	if (n < 0 || x <= 0.0) std::cerr<<"bad arguments in sphbes\n";
+	order=n+0.5;
+	bessjy(x,order,&rj,&ry,&rjp,&ryp);
+	factor=RTPIO2/sqrt(x);
+	*sj=factor*rj;
+	*sy=factor*ry;
+	*sjp=factor*rjp-(*sj)/(2.0*x);
+	*syp=factor*ryp-(*sy)/(2.0*x);
+}
+
+void special::coulomb(double eta, double rho, double lmin, int nl, double *fc, double *gc, double *fcp, double *gcp)
+{
+	// Coulomb wave functions F_{L}(eta, rho), G_{L}(eta, rho) and their derivatives F_{L}', G_{L}' for L = lmin, .., lmin+nl-1
+	// F_{L}(eta, rho) is stored in fc[L - lmin]
+	// G_{L}(eta, rho) is stored in gc[L - lmin]
+	// F_{L}'(eta, rho) is stored in fcp[L - lmin]
+	// G_{L}'(eta, rho) is stored in gcp[L - lmin]
+	// Single evaluation, the parameter setup is redone on every call
+
+	CoulombWave cw(eta, lmin, nl, false); 
+
+	cw.evaluate(rho, fc, gc, fcp, gcp); 
+}
+
+special::CoulombWave::CoulombWave()
+{
+	// Default constructor
+	peta = plmin = 0.0; 
+	pnl = 0; 
+}
+
+special::CoulombWave::CoulombWave(double eta, double lmin, int nl, bool tabulate)
+{
+	// Primary constructor
+	set_params(eta, lmin, nl, tabulate); 
+}
+
+void special::CoulombWave::set_params(double eta, double lmin, int nl, bool tabulate)
+{
+	// Parameter dependent setup for the Coulomb wave functions
+	// The coefficients of the recurrences in L are always stored, those of the continued fractions only when tabulate = true
+	// the continued fractions fall back to computing their coefficients once the tables run out
+
+	static const int NTAB = 200; // number of tabulated continued fraction and series coefficients
+
+	try{
+		if(lmin > -1.0 && nl > 0){
+			int j; 
+			double k, lmax; 
+
+			peta = eta; plmin = lmin; pnl = nl; 
+
+			rl.resize(nl - 1); sl.resize(nl - 1); 
+			for(j=0; j<nl-1; j++){
+				k = lmin + 1.0 + j; 
+				sl[j] = eta / k; 
+				rl[j] = sqrt( 1.0 + sl[j]*sl[j] ); 
+			}
+
+			// C_{L}(eta) = 2^{L} e^{-pi eta / 2} |Gamma(L + 1 + i eta)| / Gamma(2L + 2), A&S 14.1.7
+			lncl = lmin*log(2.0) - 0.5*PI*eta + lnabsgamma(lmin + 1.0, eta) - probability::gammln(2.0*lmin + 2.0); 
+
+			cf1_a.clear(); cf1_c.clear(); cf2_a.clear(); ser_a.clear(); 
+			if(tabulate){
+				lmax = lmin + nl - 1; 
+				cf1_a.resize(NTAB); cf1_c.resize(NTAB); cf2_a.resize(NTAB); ser_a.resize(NTAB); 
+				for(j=0; j<NTAB; j++){
+					k = lmax + 1.0 + j; 
+					cf1_a[j] = -( 1.0 + (eta*eta) / (k*k) ); 
+					cf1_c[j] = eta * (2.0*k + 1.0) / ( k*(k + 1.0) ); 
+					cf2_a[j] = std::complex<double>(j - lmin, eta) * std::complex<double>(j + lmin + 1.0, eta); 
+				}
+				ser_a[0] = 1.0; 
+				ser_a[1] = eta / (lmin + 1.0); 
+				for(j=2; j<NTAB; j++){
+					ser_a[j] = ( 2.0*eta*ser_a[j-1] - ser_a[j-2] ) / ( j*(j + 2.0*lmin + 1.0) ); 
+				}
+			}
+		}
+		else{
+			std::string reason = "Error: void special::CoulombWave::set_params(double eta, double lmin, int nl, bool tabulate)\n"; 
+			if(lmin <= -1.0) reason += "lmin = " + template_funcs::toString(lmin, 3) + " <= -1\n"; 
+			if(nl < 1) reason += "nl = " + template_funcs::toString(nl) + " < 1\n"; 
+			throw std::invalid_argument(reason); 
+		}
+	}
+	catch(std::invalid_argument &e){
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
+	}
+}
+
+double special::CoulombWave::cf1(double rho, int &isign) const
+{
+	// CF1 of Steed's method, f = F_{L}' / F_{L} at L = lmax, A&S 14.2.1, 14.2.2
+	// f = S_{L+1} - R_{L+1}^2 / ( T_{L+1} - R_{L+2}^2 / ( T_{L+2} - .. ) )
+	// S_{k} = k / rho + eta / k, T_{k} = S_{k} + S_{k+1} = (2k+1) / rho + eta (2k+1) / ( k (k+1) ), R_{k}^2 = 1 + eta^2 / k^2
+	// Evaluated by the modified Lentz method, isign is the sign of F_{lmax} as in bessjy
+	// The number of iterations grows like rho
+
+	static const int MAXIT = 100000; 
+
+	int j, ntab = static_cast<int>( cf1_a.size() ); 
+	double a, b, c, d, del, f, k, xi, lmax; 
+
+	xi = 1.0 / rho; 
+	lmax = plmin + pnl - 1; 
+	isign = 1; 
+	f = (lmax + 1.0)*xi + peta / (lmax + 1.0); 
+	if(fabs(f) < FPMIN) f = FPMIN; 
+	c = f; 
+	d = 0.0; 
+	for(j=1; j<=MAXIT; j++){
+		k = lmax + j; 
+		if(j <= ntab){
+			a = cf1_a[j-1]; 
+			b = (2.0*k + 1.0)*xi + cf1_c[j-1]; 
+		}
+		else{
+			a = -( 1.0 + (peta*peta) / (k*k) ); 
+			b = (2.0*k + 1.0)*( xi + peta / ( k*(k + 1.0) ) ); 
+		}
+		d = b + a*d; 
+		if(fabs(d) < FPMIN) d = FPMIN; 
+		c = b + a/c; 
+		if(fabs(c) < FPMIN) c = FPMIN; 
+		d = 1.0/d; 
+		del = c*d; 
+		f *= del; 
+		if(d < 0.0) isign = -isign; 
+		if(fabs(del - 1.0) < EPS) break; 
+	}
+	if(j > MAXIT) std::cerr<<"CoulombWave: rho too large, cf1 failed to converge\n"; 
+
+	return f; 
+}
+
+std::complex<double> special::CoulombWave::cf2(double rho) const
+{
+	// CF2 of Steed's method, p + i q = ( G_{L}' + i F_{L}' ) / ( G_{L} + i F_{L} ) at L = lmin
+	// p + i q = i (1 - eta / rho) + (i / rho) a_{0} / ( b_{0} + a_{1} / ( b_{1} + .. ) )
+	// a_{k} = (k - L + i eta) (k + L + 1 + i eta), b_{k} = 2 (rho - eta) + 2 i (k + 1), Barnett, Comput. Phys. Commun. 27, 147, 1982
+	// Evaluated by the modified Lentz method, it converges rapidly beyond the turning point rho_{TP} = eta + sqrt(eta^2 + L (L+1))
+	// and increasingly slowly as rho falls below it
+
+	static const int MAXIT = 100000; 
+
+	int k, ntab = static_cast<int>( cf2_a.size() ); 
+	std::complex<double> a, b, c, d, del, g; 
+
+	g = std::complex<double>( 2.0*(rho - peta), 2.0 ); 
+	c = g; 
+	d = 0.0; 
+	for(k=1; k<=MAXIT; k++){
+		a = ( k < ntab ? cf2_a[k] : std::complex<double>(k - plmin, peta) * std::complex<double>(k + plmin + 1.0, peta) ); 
+		b = std::complex<double>( 2.0*(rho - peta), 2.0*(k + 1.0) ); 
+		d = b + a*d; 
+		if(std::abs(d) < FPMIN) d = FPMIN; 
+		c = b + a/c; 
+		if(std::abs(c) < FPMIN) c = FPMIN; 
+		d = 1.0/d; 
+		del = c*d; 
+		g *= del; 
+		if(fabs(del.real() - 1.0) + fabs(del.imag()) < EPS) break; 
+	}
+	if(k > MAXIT) std::cerr<<"CoulombWave: rho too small, cf2 failed to converge\n"; 
+
+	a = ( ntab > 0 ? cf2_a[0] : std::complex<double>(-plmin, peta) * std::complex<double>(plmin + 1.0, peta) ); 
+
+	return std::complex<double>(0.0, 1.0 - peta/rho) + eye * a / (rho * g); 
+}
+
+double special::CoulombWave::phi(double rho) const
+{
+	// Power series for F_{L}(eta, rho) / ( C_{L}(eta) rho^{L+1} ) at L = lmin, A&S 14.1.3 - 14.1.6
+	// phi = sum_{m} a_{m} rho^{m}, a_{0} = 1, a_{1} = eta / (L+1), m (m + 2L + 1) a_{m} = 2 eta a_{m-1} - a_{m-2}
+	// Only used inside the barrier, where the terms of the series do not cancel
+	// a_{1} vanishes when eta = 0 so the sum stops after two successive negligible terms
+
+	static const int MAXIT = 10000; 
+
+	int m, nsmall = 0, ntab = static_cast<int>( ser_a.size() ); 
+	double am, am1, am2, sum, term, pw; 
+
+	am2 = 1.0; 
+	am1 = peta / (plmin + 1.0); 
+	sum = 1.0 + am1*rho; 
+	pw = rho; 
+	for(m=2; m<=MAXIT; m++){
+		am = ( m < ntab ? ser_a[m] : ( 2.0*peta*am1 - am2 ) / ( m*(m + 2.0*plmin + 1.0) ) ); 
+		am2 = am1; am1 = am; 
+		pw *= rho; 
+		term = am*pw; 
+		sum += term; 
+		if(fabs(term) < EPS*fabs(sum)){
+			if(++nsmall == 2) break; 
+		}
+		else{
+			nsmall = 0; 
+		}
+	}
+	if(m > MAXIT) std::cerr<<"CoulombWave: power series failed to converge\n"; 
+
+	return sum; 
+}
+
+double special::CoulombWave::lnabsgamma(double x, double y)
+{
+	// ln|Gamma(x + i y)| for x > 0 from the Lanczos approximation used by probability::gammln, evaluated in complex arithmetic
+
+	static const double cof[14]={57.1562356658629235,-59.5979603554754912,
+		14.1360979747417471,-0.491913816097620199,0.339946499848118887e-4,
+		0.465236289270485756e-4,-0.983744753048795646e-4,0.158088703224912494e-3,
+		-0.210264441724104883e-3,0.217439618115212643e-3,-0.164318106536763890e-3,
+		0.844182239838527433e-4,-0.261908384015814087e-4,0.368991826595316234e-5}; 
+
+	std::complex<double> z(x, y), tmp, ser(0.999999999999997092, 0.0); 
+
+	tmp = z + 5.24218750000000000; 
+	tmp = (z + 0.5)*log(tmp) - tmp; 
+	for(int j=0; j<14; j++){
+		ser += cof[j] / ( z + (j + 1.0) ); 
+	}
+
+	return ( tmp + log( 2.5066282746310005*ser/z ) ).real(); 
+}
+
+void special::CoulombWave::evaluate(double rho, double *F, double *G, double *Fp, double *Gp) const
+{
+	// Steed's method, as in bessjy
+	// 1. CF1 gives F_{lmax}' / F_{lmax}, F and F' are recurred downwards to lmin from an arbitrary starting value
+	//    F_{L-1} = ( S_{L} F_{L} + F_{L}' ) / R_{L}, F_{L-1}' = S_{L} F_{L-1} - R_{L} F_{L}, A&S 14.2.1, 14.2.2
+	// 2. CF2 gives p + i q at lmin, with the Wronskian F' G - F G' = 1 this fixes F_{lmin} and G_{lmin}
+	//    G = gam F, gam = (f - p) / q, F = 1 / sqrt( (f - p) gam + q ), f = F_{lmin}' / F_{lmin}
+	// 3. G and G' are recurred upwards from lmin, G_{L+1} = ( S_{L+1} G_{L} - G_{L}' ) / R_{L+1}, G_{L+1}' = R_{L+1} G_{L} - S_{L+1} G_{L+1}
+	// Inside the barrier q = 1 / |G + i F|^2 is lost to rounding against p, F_{lmin} is then taken from its power series,
+	// p remains accurate and the Wronskian gives G = ( 1 - q F^2 ) / ( F (f - p) ), where q F^2 is only a small correction
+
+	try{
+		if(rho > 0.0 && pnl > 0){
+
+			static const double BIG = 1.0e250; 
+			static const double QMIN = 1.0e-3; // the power series is used when q < QMIN |p + i q|
+
+			int j, isign; 
+			double f, fl, fpl, ftmp, gam, gl, gpl, gtmp, L, sL, xi, scale; 
+			std::complex<double> pq; 
+
+			xi = 1.0 / rho; 
+
+			// 1. downward recurrence of F
+			f = cf1(rho, isign); 
+			fl = isign; 
+			fpl = f*fl; 
+			F[pnl-1] = fl; 
+			if(Fp != nullptr) Fp[pnl-1] = fpl; 
+			for(j=pnl-2; j>=0; j--){
+				L = plmin + j + 1.0; 
+				sL = L*xi + sl[j]; 
+				ftmp = ( sL*fl + fpl ) / rl[j]; 
+				fpl = sL*ftmp - rl[j]*fl; 
+				fl = ftmp; 
+				if(fabs(fl) > BIG){
+					// rescale the part of the ladder already stored
+					for(int i=j+1; i<pnl; i++){
+						F[i] /= BIG; 
+						if(Fp != nullptr) Fp[i] /= BIG; 
+					}
+					fl /= BIG; fpl /= BIG; 
+				}
+				F[j] = fl; 
+				if(Fp != nullptr) Fp[j] = fpl; 
+			}
+			f = fpl / fl; 
+
+			// 2. normalisation at lmin
+			pq = cf2(rho); 
+			if(pq.imag() > QMIN*std::abs(pq)){
+				gam = ( f - pq.real() ) / pq.imag(); 
+				ftmp = template_funcs::SIGN( 1.0 / sqrt( ( f - pq.real() )*gam + pq.imag() ), fl ); 
+				gl = gam*ftmp; 
+				gpl = pq.real()*gl - pq.imag()*ftmp; 
+			}
+			else{
+				ftmp = exp( lncl + (plmin + 1.0)*log(rho) ) * phi(rho); 
+				gl = ( 1.0 - pq.imag()*ftmp*ftmp ) / ( ftmp*( f - pq.real() ) ); 
+				gpl = pq.real()*gl - pq.imag()*ftmp; 
+			}
+			scale = ftmp / fl; 
+			for(j=0; j<pnl; j++){
+				F[j] *= scale; 
+				if(Fp != nullptr) Fp[j] *= scale; 
+			}
+
+			// 3. upward recurrence of G
+			G[0] = gl; 
+			if(Gp != nullptr) Gp[0] = gpl; 
+			for(j=0; j<pnl-1; j++){
+				L = plmin + j + 1.0; 
+				sL = L*xi + sl[j]; 
+				gtmp = ( sL*gl - gpl ) / rl[j]; 
+				gpl = rl[j]*gl - sL*gtmp; 
+				gl = gtmp; 
+				G[j+1] = gl; 
+				if(Gp != nullptr) Gp[j+1] = gpl; 
+			}
+		}
+		else{
+			std::string reason = "Error: void special::CoulombWave::evaluate(double rho, double *F, double *G, double *Fp, double *Gp) const\n"; 
+			if(rho <= 0.0) reason += "rho = " + template_funcs::toString(rho, 3) + " <= 0\n"; 
+			if(pnl < 1) reason += "parameters have not been set\n"; 
+			throw std::invalid_argument(reason); 
+		}
+	}
+	catch(std::invalid_argument &e){
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
+	}
+}
+
+void special::CoulombWave::evaluate(int n, const double *rho, double *F, double *G, double *Fp, double *Gp) const
+{
+	// L ladders at rho[i] for i = 0, .., n-1, stored at offset i*nl
+
+	for(int i=0; i<n; i++){
+		evaluate(rho[i], F + i*pnl, G + i*pnl, ( Fp != nullptr ? Fp + i*pnl : nullptr ), ( Gp != nullptr ? Gp + i*pnl : nullptr ) ); 
+	}
+}
+
+double special::struveh0(double x)
+{
+	// Polynomial approximation for the Struve function H_{0}(x)
+	// On 0 <= x <= 3, error is O(10^{-8})
+	// On x >= 3, error is O(10^{-9})
+	// H_{0}(x) is odd => H_{0}(x) = -H_{0}(-x)
+	// For details of polynomial approximation see J. N. Newman, Math. Comp., 43 (168), 1984
+
+	double ax, ans, y, ysqr; 
+
+	ax = fabs(x); 
+
+	if(ax >= 0.0 && ax <= 3.0){
+		// 0 <= x <= 3
+
+		y = ax/3.0; ysqr = template_funcs::DSQR(y); 
+		
+		ans = y * ( 1.909859164 + ysqr * ( -1.909855001 + ysqr * ( 0.687514637 + ysqr * ( -0.126164557 + ysqr * ( 0.013828813 - 0.000876918*ysqr ) ) ) ) ); 
+	}
+	else{
+		// x >= 3
+		double Nx, Dx; 
+
+		y = 3.0 / ax; ysqr = template_funcs::DSQR(y);
+
+		Nx = 2.0 * (0.99999906 + ysqr * (4.7722892 + ysqr * ( 3.85542044 + 0.3230360 * ysqr ) ) ); 
+		Dx = (PI * ax) * (1.0 + ysqr * ( 4.88331068 + ysqr * ( 4.28957333 + 0.52120508 * ysqr) ) ); 
+
+		ans = Nx/Dx; 
+
+		ans += bessy0(x); // Polynomial approximation is defined for H_{0}(x) - Y_{0}(x) so add Y_{0}(x)
+	}
+
+	// H_{0}(x) is odd
+
+	return x < 0.0 ? -ans : ans ;
+}
+
+double special::struveh1(double x)
+{
+	// Polynomial approximation for the Struve function H_{1}(x)
+	// On 0 <= x <= 3, error is O(10^{-9})
+	// On x >= 3, error is O(10^{-8})
+	// H_{1}(x) is even => H_{1}(x) = H_{1}(-x)
+	// For details of polynomial approximation see J. N. Newman, Math. Comp., 43 (168), 1984
+	// H_{0}'(x) = (2/pi) - H_{1}(x)
+
+	double ax, ans, y, ysqr; 
+
+	ax = fabs(x); 
+
+	if(ax >= 0.0 && ax <= 3.0){
+		// 0 <= x <= 3
+
+		y = ax/3.0; ysqr = template_funcs::DSQR(y); 
+		
+		ans = y * ( 1.909859286 + ysqr * ( -1.145914713 + ysqr * ( 0.294656958 + ysqr * ( -0.042070508 + ysqr * ( 0.003785727 -0.000207183*ysqr ) ) ) ) ); 
+	}
+	else{
+		// x >= 3
+		double Nx, Dx; 
+
+		y = 3.0 / ax; ysqr = template_funcs::DSQR(y);
+
+		Nx = 2.0 * (1.00000004 + ysqr * (3.92205313 + ysqr * ( 2.64893033 + 0.27450895 * ysqr ) ) ); 
+		Dx = PI * (1.0 + ysqr * ( 3.81095112 + ysqr * ( 2.26216956 + 0.10885141 * ysqr) ) ); 
+
+		ans = Nx/Dx;
+
+		ans += bessy1(x); // Polynomial approximation is defined for H_{1}(x) - Y_{1}(x) so add Y_{1}(x)
+	}
+
+	// H_{1}(x) is even
+
+	return ans;
+}
+
+void special::airy(double x, double *ai, double *bi, double *aip, double *bip)
+{
+	// Returns Airy Functions Ai(x), Bi(x) and their derivatives
+	// Ai(x) is stored in ai
+	// Bi(x) is stored in bi
+	// Ai'(x) is stored in aip
+	// Bi'(x) is stored in bip
+
+	double THIRD = (1.0/3.0); 
+	double TWOTHR = (2.0/3.0); 
+	double ONOVRT = (1.0/sqrt(3.0)); 
+	double absx,ri,rip,rj,rjp,rk,rkp,rootx,ry,ryp,z;
+
+	absx=fabs(x);
+	rootx=sqrt(absx);
+	z=TWOTHR*absx*rootx;
+	if (x > 0.0) {
+		bessik(z,THIRD,&ri,&rk,&rip,&rkp);
+		*ai=rootx*ONOVRT*rk/PI;
+		*bi=rootx*(rk/PI+2.0*ONOVRT*ri);
+		bessik(z,TWOTHR,&ri,&rk,&rip,&rkp);
+		*aip = -x*ONOVRT*rk/PI;
+		*bip=x*(rk/PI+2.0*ONOVRT*ri);
+	} else if (x < 0.0) {
+		bessjy(z,THIRD,&rj,&ry,&rjp,&ryp);
+		*ai=0.5*rootx*(rj-ONOVRT*ry);
+		*bi = -0.5*rootx*(ry+ONOVRT*rj);
+		bessjy(z,TWOTHR,&rj,&ry,&rjp,&ryp);
+		*aip=0.5*absx*(ONOVRT*ry+rj);
+		*bip=0.5*absx*(ONOVRT*rj-ry);
+	} else {
+		*ai=0.35502805;
+		*bi=(*ai)/ONOVRT;
+		*aip = -0.25881940;
+		*bip = -(*aip)/ONOVRT;
+	}
+}
+
+void special::fresnel(double x, double *s, double *c, int *nits, bool accelerate)
+{
+	// Computes the Fresnel integrals S(x) and C(x) for all real x.
+	// Taken from NRinC
+	// R. Sheehan 26 - 3 - 2009
+
+	// The continued fraction converges slowly just above XMIN, there its convergents are extrapolated by Wynn's epsilon algorithm
+	// The number of series terms or continued fraction iterations used is returned in nits, accelerate = false runs the plain
+	// continued fraction for comparison
+
+	int k, n, odd;
+
+	double a,ax,fact,pix2,sign,sum,sumc,sums,term,test;
+
+	std::complex<double> b,cc,d,h,del,cs,val;
+
+	std::complex<double> one(1.0, 0.0); 
+
+	static const int MAXIT=100;
+	static const int NACC=10; // the epsilon algorithm is started after NACC iterations
+	static const int TRUE=1;
+
+	static const double FPMIN=1.0e-30;
+	static const double XMIN=1.5;
+	static const double EPS=(3.0e-12);
+
+	ax=fabs(x);
+
+	k=0;
+	if(ax<sqrt(FPMIN)){					// Special case: avoid failure of convergence
+		*s=0.0;							// test because of underflow.
+		*c=ax;
+	}else if(ax<=XMIN){					// Evaluate both series simultaneously.
+		sum=sums=0.0;
+		sumc=ax;
+		sign=1.0;
+		fact=PI_2*ax*ax;
+		odd=TRUE;
+		term=ax;
+		n=3;
+		for(k=1;k<=MAXIT;k++){
+			term *= fact/k;
+			sum += sign*term/n;
+			test=fabs(sum)*EPS;
+			if(odd){
+				sign = -sign;
+				sums=sum;
+				sum=sumc;
+			}else{
+				sumc=sum;
+				sum=sums;
+			}
+			if(term<test)break;
+			odd=!odd;
+			n+=2;
+		}
+//		if (k > MAXIT) nrerror("series failed in frenel");
+		*s=sums;							
+		*c=sumc;
+	}else{								// Evaluate Integrals by use of Lentz's Continued Fraction Expansion Method
+		pix2=PI*ax*ax;
+		b=std::complex<double>(1.0,-pix2);
+		cc=std::complex<double>(1.0/FPMIN,0.0);
+		d=h=one/b;
+		n = -1;
+		series_accel::EpsilonAlgorithm< std::complex<double> > acc(EPS);
+		for(k=2;k<=MAXIT;k++){
+			n+=2;
+			a=-n*(n+1);
+			b=b+4.0;
+			d=one/((a*d)+b);
+			cc=(b+(a/cc));
+			del=(cc*d);
+			h=(h*del);
+			if(fabs(del.real()-1.0)+fabs(del.imag())<EPS)break;
+			if(accelerate && k>=NACC){
+				val=acc.next(h);
+				if(acc.converged()){
+					h=val;
+					break;
+				}
+			}
+		}
+//		if (k > MAXIT) nrerror("cf failed in frenel");
+		h=(std::complex<double>(ax,-ax)*h);
+		cs=(std::complex<double>(0.5,0.5)*(one-(std::complex<double>(cos(0.5*pix2),sin(0.5*pix2))*h)));
+		*c=cs.real();
+		*s=cs.imag();
+	}
+	if(x<0.0){						// Use antisymmetry to obtain values for negative x
+		*c=-(*c);
+		*s=-(*s);
+	}
+	if(nits != nullptr) *nits = std::min(k, MAXIT);
+}
+
+double special::Ell_K(double x, bool conjugate)
+{
+	// Complete elliptic integral of the first kind defined by Hypergeometric function
+	// Abramowitz and Stegun, Ch 17, sect 17.3
+	// function computes K'(k) = K(1-k) when conjugate = true, otherwise returns K(k)
+	// R. Sheehan 23 - 11 - 2015
+
+	try{
+
+		if(x >= 0.0 && x < 1){
+
+			double F, dF; 
+
+			special::two_F_one( 0.5, 0.5, 1, ( conjugate ? 1.0 - x :  x ), F, dF); 
+		
+			return (F*PI_2);
+
+		}
+		else{
+			std::string reason; 
+
+			reason = "Error in special::Ell_K(double x, bool conjugate)\n"; 
+			reason += "input argument x = " + template_funcs::toString(x, 3) + "\n"; 
+
+			throw std::invalid_argument(reason); 
+		}
+
+	}
+	catch(std::invalid_argument &e){		
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
+	}
+}
+
+double special::Ell_E(double x, bool conjugate)
+{
+	// Complete elliptic integral of the second kind defined by Hypergeometric function
+	// Abramowitz and Stegun, Ch 17, sect 17.3
+	// function computes E'(k) = E(1-k) when conjugate = true, otherwise returns E(k)
+	// R. Sheehan 23 - 11 - 2015
+
+	try{
+
+		if(x >= 0.0 && x < 1){
+
+			double F, dF; 
+
+			special::two_F_one( -0.5, 0.5, 1, ( conjugate ? 1.0 - x :  x ), F, dF); 
+		
+			return (F*PI_2);
+
+		}
+		else{
+			std::string reason; 
+
+			reason = "Error in special::Ell_E(double x, bool conjugate)\n"; 
+			reason += "input argument x = " + template_funcs::toString(x, 3) + "\n"; 
+
+			throw std::invalid_argument(reason); 
+		}
+
 	}
-	if (rjl == 0.0) rjl=EPS;
-	f=rjpl/rjl;
-	if (x < XMIN) {
-		x2=0.5*x;
-		pimu=PI*xmu;
-		fact = (fabs(pimu) < EPS ? 1.0 : pimu/sin(pimu));
-		d = -log(x2);
-		e=xmu*d;
-		fact2 = (fabs(e) < EPS ? 1.0 : sinh(e)/e);
-		beschb(xmu,&gam1,&gam2,&gampl,&gammi);
-		ff=2.0/PI*fact*(gam1*cosh(e)+gam2*fact2*d);
-		e=exp(e);
-		p=e/(gampl*PI);
-		q=1.0/(e*PI*gammi);
-		pimu2=0.5*pimu;
-		fact3 = (fabs(pimu2) < EPS ? 1.0 : sin(pimu2)/pimu2);
-		r=PI*pimu2*fact3*fact3;
-		c=1.0;
-		d = -x2*x2;
-		sum=ff+r*q;
-		sum1=p;
-		for (i=1;i<=MAXIT;i++) {
-			ff=(i*ff+p+q)/(i*i-xmu2);
-			c *= (d/i);
-			p /= (i-xmu);
-			q /= (i+xmu);
-			del=c*(ff+r*q);
-			sum += del;
-			del1=c*p-i*del;
-			sum1 += del1;
-			if (fabs(del) < (1.0+fabs(sum))*EPS) break;
+	catch(std::invalid_argument &e){		
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
+	}
+}
+
+void special::Ell_K_E(double k, double &Kval, double &Eval, bool conjugate)
+{
+	// complete elliptic integrals of the first and second kind
+	// polynomial approximation accurate to within |eps| <= 2e-8 when 0 <= k < 1
+	// Abramowitz and Stegun, Ch 17, sect 17.3
+	// functions compute K'(k) = K(1-k) when conjugate = true, otherwise returns K(k), or E(k)
+	// R. Sheehan 23 - 11 - 2015
+
+	//double arg = (conjugate ? k: 1.0 - k); // decide on the argument, i.e. return K(k) or K'(k) = K(1-k)
+
+	try{
+
+		if(k >= 0.0 && k < 1){
+
+			// polynomial coefficients for K(k)
+			double AK[5] = {1.38629436112, 0.09666344259, 0.03590092383, 0.03742563713, 0.01451196212}; 
+			double BK[5] = {0.5, 0.12498593597, 0.06880248576, 0.03328355346, 0.00441787012};
+
+			// polynomial coefficients for E(k)
+			double AE[5] = {1.0, 0.44325141463, 0.06260601220, 0.04757383546, 0.01736506451}; 
+			double BE[5] = {0.0, 0.24998368310, 0.09200180037, 0.04069697526, 0.00526449639};
+
+			double m1 = (1.0 - ( conjugate ? 1.0 - k :  k ) ); 
+			double lnm1 = log(1.0/m1); 
+			double akval, bkval, aeval, beval; 
+
+			// evaluate all polynomials simultaneously
+			akval = AK[4]; bkval = BK[4]; // K(k)
+			aeval = AE[4]; beval = BE[4]; // E(k)
+			for(int i=3; i>=0; i--){
+				// K(k)
+				akval = akval*m1 + AK[i]; 
+				bkval = bkval*m1 + BK[i]; 
+
+				// B(k)
+				aeval = aeval*m1 + AE[i]; 
+				beval = beval*m1 + BE[i]; 
+			}
+
+			// multiply b polynomials by lnm1
+			bkval *= lnm1; beval *= lnm1; 
+
+			// Assign values for K(k) and E(k)
+			Kval = (akval + bkval); 
+			Eval = (aeval + beval);
+
 		}
-		if (i > MAXIT) std::cerr<<"bessy series failed to converge\n";
-		rymu = -sum;
-		ry1 = -sum1*xi2;
-		rymup=xmu*xi*rymu-ry1;
-		rjmu=w/(rymup-f*rymu);
-	} else {
-		a=0.25-xmu2;
-		p = -0.5*xi;
-		q=1.0;
-		br=2.0*x;
-		bi=2.0;
-		fact=a*xi/(p*p+q*q);
-		cr=br+q*fact;
-		ci=bi+p*fact;
-		den=br*br+bi*bi;
-		dr=br/den;
-		di = -bi/den;
-		dlr=cr*dr-ci*di;
-		dli=cr*di+ci*dr;
-		temp=p*dlr-q*dli;
-		q=p*dli+q*dlr;
-		p=temp;
-		for (i=2;i<=MAXIT;i++) {
-			a += 2*(i-1);
-			bi += 2.0;
-			dr=a*dr+br;
-			di=a*di+bi;
-			if (fabs(dr)+fabs(di) < FPMIN) dr=FPMIN;
-			fact=a/(cr*cr+ci*ci);
-			cr=br+cr*fact;
-			ci=bi-ci*fact;
-			if (fabs(cr)+fabs(ci) < FPMIN) cr=FPMIN;
-			den=dr*dr+di*di;
-			dr /= den;
-			di /= -den;
-			dlr=cr*dr-ci*di;
-			dli=cr*di+ci*dr;
-			temp=p*dlr-q*dli;
-			q=p*dli+q*dlr;
-			p=temp;
-			if (fabs(dlr-1.0)+fabs(dli) < EPS) break;
+		else{
+			std::string reason; 
+
+			reason = "Error in special::Ell_K_E(double k, double &Kval, double &Eval, bool conjugate)\n"; 
+			reason += "input argument k = " + template_funcs::toString(k, 3) + "\n"; 
+
+			throw std::invalid_argument(reason); 
 		}
-		if (i > MAXIT) std::cerr<<"cf2 failed in bessjy\n";
-		gam=(p-f)/q;
-		rjmu=sqrt(w/((p-f)*gam+q));
-		rjmu=template_funcs::SIGN(rjmu,rjl);
-		rymu=rjmu*gam;
-		rymup=rymu*(p+q/gam);
-		ry1=xmu*xi*rymu-rymup;
+
 	}
-	fact=rjmu/rjl;
-	*rj=rjl1*fact;
-	*rjp=rjp1*fact;
-	for (i=1;i<=nl;i++) {
-		rytemp=(xmu+i)*xi2*ry1-rymu;
-		rymu=ry1;
-		ry1=rytemp;
+	catch(std::invalid_argument &e){		
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
+	}
+}
+
+double special::Voigt(double x, double h, double G, double x0)
+{
+	// This is an implementation of the Voigt function
+	// presumably x represents frequency
+	// x0 represents centre frequency
+	// h represents amplitude factor
+	// G represents HWHM
+
+	// There are problems with this implementation
+	// Technically Lorentz HWHM != Gauss HWHM so there should be another parameter
+	// Also the scale factor of 2.0 * sqrt(log10(2.0)) doesn't make any sense
+	// unless the idea was to have that factor be related to the real Gaussian HWHM 
+	// which is sqrt( 2 log(2) ) c
+	// R. Sheehan 30 - 11 - 2021
+
+	// Only Re[w(z)] is needed, so it is computed alone by Faddeeva::w_re, see Voigt_K
+	
+	double scl = 2.0 * sqrt(log10(2.0)) / G; 
+
+	return ( h * Faddeeva::w_re((x - x0) * scl, 0.5 * G * scl) ); 
+}
+
+void special::Voigt(int n, const double *x, double h, double G, double x0, double *V, Faddeeva::Method method)
+{
+	// Voigt function at the n points x[i], with the same parameters as Voigt(x, h, G, x0)
+	// The arguments z are formed in blocks of BLOCK points and passed to the array version of Faddeeva::w_re
+	// which evaluates Re[w(z)] alone in SIMD registers, Im(z) is the same for every point
+	// method = Faddeeva::WEIDEMAN16 or WEIDEMAN32 trades accuracy for a fixed cost per point, see Faddeeva.hh
+
+	static const int BLOCK = 256; 
+
+	int i, j, nb; 
+	double scl, zr[BLOCK], zi[BLOCK], wr[BLOCK], wi[BLOCK]; 
+
+	scl = 2.0 * sqrt(log10(2.0)) / G; 
+
+	for(j=0; j<BLOCK; j++) zi[j] = 0.5 * G * scl; 
+
+	for(i=0; i<n; i+=BLOCK){
+		nb = std::min(BLOCK, n - i); 
+
+		for(j=0; j<nb; j++) zr[j] = (x[i + j] - x0) * scl; 
+
+		if(method == Faddeeva::ADAPTIVE) Faddeeva::w_re(nb, zr, zi, wr); 
+		else Faddeeva::w(nb, zr, zi, wr, wi, method); 
+
+		for(j=0; j<nb; j++) V[i + j] = h * wr[j]; 
+	}
+}
+
+double special::Voigt_K(double x, double y)
+{
+	// Normalised Voigt function K(x, y) = Re[w(x + iy)], the absorption profile
+	// Re[w] is computed alone in real arithmetic, without the sums, sines and division that only feed Im[w]
+
+	return Faddeeva::w_re(x, y); 
+}
+
+void special::Voigt_K(int n, const double *x, const double *y, double *K)
+{
+	// K(x[i], y[i]) at n points, vectorised as the array version of Faddeeva::w
+
+	Faddeeva::w_re(n, x, y, K); 
+}
+
+void special::Voigt_KL(double x, double y, double &K, double &L)
+{
+	// K(x, y) = Re[w(x + iy)] and L(x, y) = Im[w(x + iy)], the absorption and dispersion profiles
+	// L needs every part of w that K does not, so both come from one evaluation of w
+
+	std::complex<double> w = Faddeeva::w(std::complex<double>(x, y)); 
+
+	K = real(w); L = imag(w); 
+}
+
+void special::Voigt_KL(int n, const double *x, const double *y, double *K, double *L)
+{
+	// K and L at n points
+
+	Faddeeva::w(n, x, y, K, L); 
+}
+
+static std::complex<double> plasma_dZ(std::complex<double> zeta, std::complex<double> Z)
+{
+	// Z'(zeta) = -2 (1 + zeta Z(zeta)) from Z(zeta)
+	// For large |zeta| the 1 and zeta Z cancel to O(1/|zeta|^2), as in voigt_dwdz_re, so there the asymptotic series
+	// Z' = sum_{k} (2k+1)!! / (2^k zeta^{2k+2}) is summed instead, with for Im(zeta) < 0 the term -4 i sqrt(pi) zeta exp(-zeta^2)
+	// that comes from w(zeta) = 2 exp(-zeta^2) - w(-zeta)
+
+	static const double ZASY = 15.0; 
+	static const int NASY = 10; 
+
+	if(norm(zeta) < ZASY*ZASY){
+		return ( -2.0 * (1.0 + zeta * Z) ); 
+	}
+	else{
+		int k; 
+		double c[NASY]; 
+		std::complex<double> u, S; 
+
+		c[0] = 1.0; 
+		for(k=1; k<NASY; k++) c[k] = c[k-1] * (k + 0.5); // (2k+1)!! / 2^k
+
+		u = 1.0 / (zeta * zeta); 
+
+		S = c[NASY-1]; 
+		for(k=NASY-2; k>=0; k--) S = c[k] + u * S; 
+
+		S *= u; 
+
+		if(imag(zeta) < 0.0) S -= std::complex<double>(0.0, 4.0 * sqrt(PI)) * zeta * exp(-zeta * zeta); 
+
+		return S; 
 	}
-	*ry=rymu;
-	*ryp=xnu*xi*rymu-ry1;
 }
 
-void special::bessik(double x, double xnu, double *ri, double *rk, double *rip, double *rkp)
+std::complex<double> special::plasma_Z(std::complex<double> zeta)
 {
-	// Returns the modified Bessel functions I_{\nu}(x), K_{\nu}(x) and their derivatives for x > 0 and \nu >= 0
-	// I_{\nu}(x) is stored in ri
-	// K_{\nu}(x) is stored in rk
-	// I_{\nu}'(x) is stored in rip
-	// K_{\nu}'(x) is stored in rkp
-	
-	int i,l,nl;
-	double a,a1,b,c,d,del,del1,delh,dels,e,f,fact,fact2,ff,gam1,gam2,
-		gammi,gampl,h,p,pimu,q,q1,q2,qnew,ril,ril1,rimu,rip1,ripl,
-		ritemp,rk1,rkmu,rkmup,rktemp,s,sum,sum1,x2,xi,xi2,xmu,xmu2;
+	// Plasma dispersion function Z(zeta) = i sqrt(pi) w(zeta)
 
-	int MAXIT = 10000; 
-	double XMIN = 2.0;
+	return ( std::complex<double>(0.0, sqrt(PI)) * Faddeeva::w(zeta) ); 
+}
 
-	if (x <= 0.0 || xnu < 0.0) std::cerr<<"bad arguments in bessik\n";
-	nl=(int)(xnu+0.5);
-	xmu=xnu-nl;
-	xmu2=xmu*xmu;
-	xi=1.0/x;
-	xi2=2.0*xi;
-	h=xnu*xi;
-	if (h < FPMIN) h=FPMIN;
-	b=xi2*xnu;
-	d=0.0;
-	c=h;
-	for (i=1;i<=MAXIT;i++) {
-		b += xi2;
-		d=1.0/(b+d);
-		c=b+1.0/c;
-		del=c*d;
-		h=del*h;
-		if (fabs(del-1.0) < EPS) break;
-	}
-	if (i > MAXIT) std::cerr<<"x too large in bessik; try asymptotic expansion\n";
-	ril=FPMIN;
-	ripl=h*ril;
-	ril1=ril;
-	rip1=ripl;
-	fact=xnu*xi;
-	for (l=nl;l>=1;l--) {
-		ritemp=fact*ril+ripl;
-		fact -= xi;
-		ripl=fact*ritemp+ril;
-		ril=ritemp;
+std::complex<double> special::plasma_Z(std::complex<double> zeta, std::complex<double> &dZ)
+{
+	// Z(zeta) and its derivative Z'(zeta) = -2 (1 + zeta Z(zeta)) from the same w(zeta)
+
+	std::complex<double> Z = std::complex<double>(0.0, sqrt(PI)) * Faddeeva::w(zeta); 
+
+	dZ = plasma_dZ(zeta, Z); 
+
+	return Z; 
+}
+
+void special::plasma_Z(int n, const double *re, const double *im, double *Zr, double *Zi, double *dZr, double *dZi)
+{
+	// Z and, when dZr and dZi are not null, Z' at the n points zeta = re[i] + i im[i]
+	// w is computed by the array version of Faddeeva::w straight into Zr and Zi, which are then turned into Z in place
+	// Points in Im(zeta) < 0 where exp(-zeta^2) overflows give infinite Z, as in the scalar version
+
+	int i; 
+	double wr, rtpi = sqrt(PI); 
+	std::complex<double> dZ; 
+
+	Faddeeva::w(n, re, im, Zr, Zi); 
+
+	for(i=0; i<n; i++){
+		wr = Zr[i]; 
+		Zr[i] = -rtpi * Zi[i]; 
+		Zi[i] = rtpi * wr; 
 	}
-	f=ripl/ril;
-	if (x < XMIN) {
-		x2=0.5*x;
-		pimu=PI*xmu;
-		fact = (fabs(pimu) < EPS ? 1.0 : pimu/sin(pimu));
-		d = -log(x2);
-		e=xmu*d;
-		fact2 = (fabs(e) < EPS ? 1.0 : sinh(e)/e);
-		beschb(xmu,&gam1,&gam2,&gampl,&gammi);
-		ff=fact*(gam1*cosh(e)+gam2*fact2*d);
-		sum=ff;
-		e=exp(e);
-		p=0.5*e/gampl;
-		q=0.5/(e*gammi);
-		c=1.0;
-		d=x2*x2;
-		sum1=p;
-		for (i=1;i<=MAXIT;i++) {
-			ff=(i*ff+p+q)/(i*i-xmu2);
-			c *= (d/i);
-			p /= (i-xmu);
-			q /= (i+xmu);
-			del=c*ff;
-			sum += del;
-			del1=c*(p-i*ff);
-			sum1 += del1;
-			if (fabs(del) < fabs(sum)*EPS) break;
-		}
-		if (i > MAXIT) std::cerr<<"bessk series failed to converge\n";
-		rkmu=sum;
-		rk1=sum1*xi2;
-	} else {
-		b=2.0*(1.0+x);
-		d=1.0/b;
-		h=delh=d;
-		q1=0.0;
-		q2=1.0;
-		a1=0.25-xmu2;
-		q=c=a1;
-		a = -a1;
-		s=1.0+q*delh;
-		for (i=2;i<=MAXIT;i++) {
-			a -= 2*(i-1);
-			c = -a*c/i;
-			qnew=(q1-b*q2)/a;
-			q1=q2;
-			q2=qnew;
-			q += c*qnew;
-			b += 2.0;
-			d=1.0/(b+a*d);
-			delh=(b*d-1.0)*delh;
-			h += delh;
-			dels=q*delh;
-			s += dels;
-			if (fabs(dels/s) < EPS) break;
+
+	if(dZr != nullptr && dZi != nullptr){
+		for(i=0; i<n; i++){
+			dZ = plasma_dZ(std::complex<double>(re[i], im[i]), std::complex<double>(Zr[i], Zi[i])); 
+			dZr[i] = real(dZ); 
+			dZi[i] = imag(dZ); 
 		}
-		if (i > MAXIT) std::cerr<<"bessik: failure to converge in cf2\n";
-		h=a1*h;
-		rkmu=sqrt(PI/(2.0*x))*exp(-x)/s;
-		rk1=rkmu*(xmu+x+0.5-h)*xi;
-	}
-	rkmup=xmu*xi*rkmu-rk1;
-	rimu=xi/(f*rkmu-rkmup);
-	*ri=(rimu*ril1)/ril;
-	*rip=(rimu*rip1)/ril;
-	for (i=1;i<=nl;i++) {
-		rktemp=(xmu+i)*xi2*rk1+rkmu;
-		rkmu=rk1;
-		rk1=rktemp;
 	}
-	*rk=rkmu;
-	*rkp=xnu*xi*rkmu-rk1;
 }
 
-void special::beschb(double x, double *gam1, double *gam2, double *gampl, double *gammi)
+float special::Voigt(float x, float h, float G, float x0)
 {
-	// Computes \Gamma_{1} and \Gamma_{2} by Chebyshev expansion for |x| <= 1/2
-	// Returns 1/\Gamma(1+x) and 1/\Gamma(1-x)
-	// This function is used to compute Bessel functions of non-integer order
-	
-	double xx;
-	static double c1[] = {
-		-1.142022680371172e0,6.516511267076e-3,
-		3.08709017308e-4,-3.470626964e-6,6.943764e-9,
-		3.6780e-11,-1.36e-13};
-	static double c2[] = {
-		1.843740587300906e0,-0.076852840844786e0,
-		1.271927136655e-3,-4.971736704e-6,-3.3126120e-8,
-		2.42310e-10,-1.70e-13,-1.0e-15};
+	// Single-precision Voigt function, with the same parameters as Voigt(double x, double h, double G, double x0)
+	// Relative accuracy is better than 1e-6 here and 2e-6 in the array version, see Faddeeva_Float.cc
 
-	int NUSE1 = 7; 
-	int NUSE2 = 8; 
+	float scl = 2.0f * sqrt(log10(2.0f)) / G; 
 
-	xx=8.0*x*x-1.0;
-	*gam1=cheb_appr::chebev(-1.0,1.0,c1,NUSE1,xx);
-	*gam2=cheb_appr::chebev(-1.0,1.0,c2,NUSE2,xx);
-	*gampl= *gam2-x*(*gam1);
-	*gammi= *gam2+x*(*gam1);
+	return ( h * real(Faddeeva::w(std::complex<float>((x - x0) * scl, 0.5f * G * scl))) ); 
 }
 
-void special::sphbes(int n, double x, double *sj, double *sy, double *sjp, double *syp)
+void special::Voigt(int n, const float *x, float h, float G, float x0, float *V)
 {
-	// Spherical Bessel functions j_{n}(x), y_{n}(x) and their derivatives at integer order
-	// j_{n}(x) is stored in sj
-	// y_{n}(x) is stored in sy
-	// j_{n}'(x) is stored in sjp
-	// y_{n}'(x) is stored in syp
+	// Single-precision Voigt function at the n points x[i], with the same parameters as Voigt(x, h, G, x0)
+	// The float array version of Faddeeva::w runs twice as many points per SIMD register as the double one
+	// Relative accuracy is better than 2e-6, enough for display, not for fitting
 
-	double factor,order,rj,rjp,ry,ryp;
-	double RTPIO2 = sqrt(PI_2); 
+	static const int BLOCK = 256; 
 
-	if (n < 0 || x <= 0.0) std::cerr<<"bad arguments in sphbes\n";
-	order=n+0.5;
-	bessjy(x,order,&rj,&ry,&rjp,&ryp);
-	factor=RTPIO2/sqrt(x);
-	*sj=factor*rj;
-	*sy=factor*ry;
-	*sjp=factor*rjp-(*sj)/(2.0*x);
-	*syp=factor*ryp-(*sy)/(2.0*x);
+	int i, j, nb; 
+	float scl, zr[BLOCK], zi[BLOCK], wr[BLOCK], wi[BLOCK]; 
+
+	scl = 2.0f * sqrt(log10(2.0f)) / G; 
+
+	for(j=0; j<BLOCK; j++) zi[j] = 0.5f * G * scl; 
+
+	for(i=0; i<n; i+=BLOCK){
+		nb = std::min(BLOCK, n - i); 
+
+		for(j=0; j<nb; j++) zr[j] = (x[i + j] - x0) * scl; 
+
+		Faddeeva::w(nb, zr, zi, wr, wi); 
+
+		for(j=0; j<nb; j++) V[i + j] = h * wr[j]; 
+	}
 }
 
-double special::struveh0(double x)
+static double voigt_dwdz_re(double zr, double zi, double wr, double wi)
 {
-	// Polynomial approximation for the Struve function H_{0}(x)
-	// On 0 <= x <= 3, error is O(10^{-8})
-	// On x >= 3, error is O(10^{-9})
-	// H_{0}(x) is odd => H_{0}(x) = -H_{0}(-x)
-	// For details of polynomial approximation see J. N. Newman, Math. Comp., 43 (168), 1984
+	// Re[dw/dz] = -2 Re[z w(z)], since the 2i / sqrt(pi) of dw/dz = -2 z w(z) + 2i / sqrt(pi) is imaginary
+	// For large |z| the two products in Re[z w] cancel to O(1/|z|^2) of their size, so there the asymptotic series
+	// dw/dz = -(i / sqrt(pi)) sum_{k} (2k+1)!! / (2^k z^{2k+2}) is summed instead, valid for Im(z) >= 0
+	// With 10 terms its truncation error at |z| = 15 is below 1e-16, while the cancellation would cost a factor |z|^2 = 225
 
-	double ax, ans, y, ysqr; 
+	static const double ZASY = 15.0; 
+	static const int NASY = 10; 
 
-	ax = fabs(x); 
+	if(zr*zr + zi*zi < ZASY*ZASY){
+		return ( -2.0 * (zr * wr - zi * wi) ); 
+	}
+	else{
+		int k; 
+		double c[NASY]; 
+		std::complex<double> u, S; 
 
-	if(ax >= 0.0 && ax <= 3.0){
-		// 0 <= x <= 3
+		c[0] = 1.0; 
+		for(k=1; k<NASY; k++) c[k] = c[k-1] * (k + 0.5); // (2k+1)!! / 2^k
 
-		y = ax/3.0; ysqr = template_funcs::DSQR(y); 
-		
-		ans = y * ( 1.909859164 + ysqr * ( -1.909855001 + ysqr * ( 0.687514637 + ysqr * ( -0.126164557 + ysqr * ( 0.013828813 - 0.000876918*ysqr ) ) ) ) ); 
+		u = 1.0 / (std::complex<double>(zr, zi) * std::complex<double>(zr, zi)); 
+
+		S = c[NASY-1]; 
+		for(k=NASY-2; k>=0; k--) S = c[k] + u * S; 
+
+		return ( imag(u * S) / sqrt(PI) ); 
 	}
-	else{
-		// x >= 3
-		double Nx, Dx; 
+}
 
-		y = 3.0 / ax; ysqr = template_funcs::DSQR(y);
+double special::Voigt_grad(double x, double h, double G, double x0, double *dV)
+{
+	// Voigt function with the same parameters as Voigt(x, h, G, x0) and its gradient dV[0..2] = dV/d(h, G, x0)
+	// V = h Re[w(z)] with z = s (x - x0) + i s G / 2, s = 2 sqrt(log10(2)) / G, so Im(z) does not depend on G and
+	// dz/dx0 = -s, dz/dG = -Re(z) / G
+	// The derivatives are exact apart from the accuracy of w(z), so a Levenberg-Marquardt fit needs no finite differences
 
-		Nx = 2.0 * (0.99999906 + ysqr * (4.7722892 + ysqr * ( 3.85542044 + 0.3230360 * ysqr ) ) ); 
-		Dx = (PI * ax) * (1.0 + ysqr * ( 4.88331068 + ysqr * ( 4.28957333 + 0.52120508 * ysqr) ) ); 
+	double scl, dwr; 
+	std::complex<double> z, w; 
 
-		ans = Nx/Dx; 
+	scl = 2.0 * sqrt(log10(2.0)) / G; 
 
-		ans += bessy0(x); // Polynomial approximation is defined for H_{0}(x) - Y_{0}(x) so add Y_{0}(x)
+	z = std::complex<double>((x - x0) * scl, 0.5 * G * scl); 
+
+	w = Faddeeva::w(z); 
+
+	dwr = voigt_dwdz_re(real(z), imag(z), real(w), imag(w)); 
+
+	dV[0] = real(w); 
+	dV[1] = -h * dwr * real(z) / G; 
+	dV[2] = -h * dwr * scl; 
+
+	return ( h * real(w) ); 
+}
+
+void special::Voigt_grad(int n, const double *x, double h, double G, double x0, double *V, double *dVdh, double *dVdG, double *dVdx0, Faddeeva::Method method)
+{
+	// Voigt function and its gradient at the n points x[i], see Voigt_grad(x, h, G, x0, dV)
+	// w(z) is evaluated in blocks of BLOCK points by the array version of Faddeeva::w as in Voigt(n, x, h, G, x0, V, method)
+
+	static const int BLOCK = 256; 
+
+	int i, j, nb; 
+	double scl, dwr, zr[BLOCK], zi[BLOCK], wr[BLOCK], wi[BLOCK]; 
+
+	scl = 2.0 * sqrt(log10(2.0)) / G; 
+
+	for(j=0; j<BLOCK; j++) zi[j] = 0.5 * G * scl; 
+
+	for(i=0; i<n; i+=BLOCK){
+		nb = std::min(BLOCK, n - i); 
+
+		for(j=0; j<nb; j++) zr[j] = (x[i + j] - x0) * scl; 
+
+		Faddeeva::w(nb, zr, zi, wr, wi, method); 
+
+		for(j=0; j<nb; j++){
+			dwr = voigt_dwdz_re(zr[j], zi[j], wr[j], wi[j]); 
+
+			V[i + j] = h * wr[j]; 
+			dVdh[i + j] = wr[j]; 
+			dVdG[i + j] = -h * dwr * zr[j] / G; 
+			dVdx0[i + j] = -h * dwr * scl; 
+		}
 	}
+}
 
-	// H_{0}(x) is odd
+double special::Voigt_profile(double x, double x0, double sigma, double gamma)
+{
+	// Voigt line shape of area one, V(x) = Re[w(z)] / (sigma sqrt(2 pi)) with z = (x - x0 + i gamma) / (sigma sqrt(2))
+	// The Gaussian and Lorentzian widths are independent here, unlike Voigt(x, h, G, x0) where one parameter sets both
+	// sigma = 0 is the Lorentzian gamma / (pi ((x - x0)^2 + gamma^2)), evaluated directly since z is then infinite
 
-	return x < 0.0 ? -ans : ans ;
+	try{
+		if( sigma >= 0.0 && gamma >= 0.0 && sigma + gamma > 0.0 ){
+
+			if(sigma == 0.0){
+				return ( gamma / ( PI * ( (x - x0) * (x - x0) + gamma * gamma ) ) ); 
+			}
+			else{
+				double scl = 1.0 / (sigma * sqrt(2.0)); 
+
+				return ( Faddeeva::w_re((x - x0) * scl, gamma * scl) * scl / sqrt(PI) ); 
+			}
+		}
+		else{
+			std::string reason = "Error: double special::Voigt_profile(double x, double x0, double sigma, double gamma)\n"; 
+			reason += "sigma = " + template_funcs::toString(sigma) + ", gamma = " + template_funcs::toString(gamma) + " must be non-negative and not both zero\n"; 
+			throw std::invalid_argument(reason); 
+		}
+	}
+	catch(std::invalid_argument &e){
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
+	}
 }
 
-double special::struveh1(double x)
+void special::Voigt_profile(int n, const double *x, double x0, double sigma, double gamma, double *V, Faddeeva::Method method)
 {
-	// Polynomial approximation for the Struve function H_{1}(x)
-	// On 0 <= x <= 3, error is O(10^{-9})
-	// On x >= 3, error is O(10^{-8})
-	// H_{1}(x) is even => H_{1}(x) = H_{1}(-x)
-	// For details of polynomial approximation see J. N. Newman, Math. Comp., 43 (168), 1984
-	// H_{0}'(x) = (2/pi) - H_{1}(x)
+	// Voigt line shape at the n points x[i], see Voigt_profile(x, x0, sigma, gamma)
+	// Re[w(z)] is evaluated in blocks of BLOCK points by the array version of Faddeeva::w_re, or of Faddeeva::w for the other methods
 
-	double ax, ans, y, ysqr; 
+	static const int BLOCK = 256; 
 
-	ax = fabs(x); 
+	int i, j, nb; 
+	double scl, zr[BLOCK], zi[BLOCK], wr[BLOCK], wi[BLOCK]; 
 
-	if(ax >= 0.0 && ax <= 3.0){
-		// 0 <= x <= 3
+	if( !(sigma > 0.0) ){
+		for(i=0; i<n; i++) V[i] = Voigt_profile(x[i], x0, sigma, gamma); 
+		return; 
+	}
 
-		y = ax/3.0; ysqr = template_funcs::DSQR(y); 
-		
-		ans = y * ( 1.909859286 + ysqr * ( -1.145914713 + ysqr * ( 0.294656958 + ysqr * ( -0.042070508 + ysqr * ( 0.003785727 -0.000207183*ysqr ) ) ) ) ); 
+	scl = 1.0 / (sigma * sqrt(2.0)); 
+
+	for(j=0; j<BLOCK; j++) zi[j] = gamma * scl; 
+
+	for(i=0; i<n; i+=BLOCK){
+		nb = std::min(BLOCK, n - i); 
+
+		for(j=0; j<nb; j++) zr[j] = (x[i + j] - x0) * scl; 
+
+		if(method == Faddeeva::ADAPTIVE) Faddeeva::w_re(nb, zr, zi, wr); 
+		else Faddeeva::w(nb, zr, zi, wr, wi, method); 
+
+		for(j=0; j<nb; j++) V[i + j] = wr[j] * scl / sqrt(PI); 
 	}
-	else{
-		// x >= 3
-		double Nx, Dx; 
+}
+
+double special::Voigt_hwhm(double sigma, double gamma)
+{
+	// Half width at half maximum of the Voigt line shape, from the Gaussian HWHM fG = sigma sqrt(2 ln 2) and the Lorentzian HWHM fL = gamma
+	// fV = 0.5346 fL + sqrt(0.2166 fL^2 + fG^2), J. J. Olivero and R. L. Longbothum, JQSRT, 17, 233, 1977
+
+	double fG = sigma * sqrt(2.0 * log(2.0)); 
+
+	return ( 0.5346 * gamma + sqrt(0.2166 * gamma * gamma + fG * fG) ); 
+}
 
-		y = 3.0 / ax; ysqr = template_funcs::DSQR(y);
+static void pseudo_voigt_params(double sigma, double gamma, double &f, double &eta)
+{
+	// FWHM f and Lorentzian fraction eta of the Thompson-Cox-Hastings pseudo-Voigt, from the Gaussian FWHM fG = 2 sqrt(2 ln 2) sigma
+	// and the Lorentzian FWHM fL = 2 gamma, f^5 = fG^5 + 2.69269 fG^4 fL + 2.42843 fG^3 fL^2 + 4.47163 fG^2 fL^3 + 0.07842 fG fL^4 + fL^5
 
-		Nx = 2.0 * (1.00000004 + ysqr * (3.92205313 + ysqr * ( 2.64893033 + 0.27450895 * ysqr ) ) ); 
-		Dx = PI * (1.0 + ysqr * ( 3.81095112 + ysqr * ( 2.26216956 + 0.10885141 * ysqr) ) ); 
+	double fG, fL, r; 
 
-		ans = Nx/Dx;
+	fG = 2.0 * sqrt(2.0 * log(2.0)) * sigma; 
+	fL = 2.0 * gamma; 
 
-		ans += bessy1(x); // Polynomial approximation is defined for H_{1}(x) - Y_{1}(x) so add Y_{1}(x)
-	}
+	f = pow( fG*fG*fG*fG*fG + 2.69269*fG*fG*fG*fG*fL + 2.42843*fG*fG*fG*fL*fL + 4.47163*fG*fG*fL*fL*fL + 0.07842*fG*fL*fL*fL*fL + fL*fL*fL*fL*fL, 0.2 ); 
 
-	// H_{1}(x) is even
+	r = fL / f; 
 
-	return ans;
+	eta = r * (1.36603 - r * (0.47719 - r * 0.11116)); 
 }
 
-void special::airy(double x, double *ai, double *bi, double *aip, double *bip)
+double special::pseudo_Voigt_profile(double x, double x0, double sigma, double gamma)
 {
-	// Returns Airy Functions Ai(x), Bi(x) and their derivatives
-	// Ai(x) is stored in ai
-	// Bi(x) is stored in bi
-	// Ai'(x) is stored in aip
-	// Bi'(x) is stored in bip
+	// Pseudo-Voigt approximation to Voigt_profile(x, x0, sigma, gamma), its area is one
 
-	double THIRD = (1.0/3.0); 
-	double TWOTHR = (2.0/3.0); 
-	double ONOVRT = (1.0/sqrt(3.0)); 
-	double absx,ri,rip,rj,rjp,rk,rkp,rootx,ry,ryp,z;
+	double V; 
 
-	absx=fabs(x);
-	rootx=sqrt(absx);
-	z=TWOTHR*absx*rootx;
-	if (x > 0.0) {
-		bessik(z,THIRD,&ri,&rk,&rip,&rkp);
-		*ai=rootx*ONOVRT*rk/PI;
-		*bi=rootx*(rk/PI+2.0*ONOVRT*ri);
-		bessik(z,TWOTHR,&ri,&rk,&rip,&rkp);
-		*aip = -x*ONOVRT*rk/PI;
-		*bip=x*(rk/PI+2.0*ONOVRT*ri);
-	} else if (x < 0.0) {
-		bessjy(z,THIRD,&rj,&ry,&rjp,&ryp);
-		*ai=0.5*rootx*(rj-ONOVRT*ry);
-		*bi = -0.5*rootx*(ry+ONOVRT*rj);
-		bessjy(z,TWOTHR,&rj,&ry,&rjp,&ryp);
-		*aip=0.5*absx*(ONOVRT*ry+rj);
-		*bip=0.5*absx*(ONOVRT*rj-ry);
-	} else {
-		*ai=0.35502805;
-		*bi=(*ai)/ONOVRT;
-		*aip = -0.25881940;
-		*bip = -(*aip)/ONOVRT;
-	}
+	pseudo_Voigt_profile(1, &x, x0, sigma, gamma, &V); 
+
+	return V; 
 }
 
-void special::fresnel(double x, double *s, double *c)
+void special::pseudo_Voigt_profile(int n, const double *x, double x0, double sigma, double gamma, double *V)
 {
-	// Computes the Fresnel integrals S(x) and C(x) for all real x.
-	// Taken from NRinC
-	// R. Sheehan 26 - 3 - 2009
+	// Pseudo-Voigt at the n points x[i]
+	// The Gaussian exp(-ln(2) t) = 2^{-t} is computed in the loop as 2^{-m} 2^{-f} with m = round(t), |f| <= 1/2, the first by
+	// writing the exponent bits and the second by its Taylor series to degree 9, relative error < 1e-11, far below that of the
+	// approximation itself; with no function calls or branches the loop can be vectorised by the compiler
+	// t is capped at 1000, where the Gaussian is 2^{-1000} of its peak
 
-	int k, n, odd;
+	try{
+		if( sigma >= 0.0 && gamma >= 0.0 && sigma + gamma > 0.0 ){
 
-	double a,ax,fact,pix2,sign,sum,sumc,sums,term,test;
+			int i, m; 
+			double f, eta, a, cg, cl, t, u, p2, sc; 
+			long long bits; 
 
-	std::complex<double> b,cc,d,h,del,cs;
+			pseudo_voigt_params(sigma, gamma, f, eta); 
 
-	std::complex<double> one(1.0, 0.0); 
+			a = 4.0 / (f * f); // 1 / HWHM^2
+			cg = (1.0 - eta) * sqrt(log(2.0) / PI) * 2.0 / f; // Gaussian peak times its weight
+			cl = eta * 2.0 / (PI * f); // Lorentzian peak times its weight
 
-	static const int MAXIT=100;
-	static const int TRUE=1;
+			for(i=0; i<n; i++){
+				t = (x[i] - x0) * (x[i] - x0) * a; 
 
-	static const double FPMIN=1.0e-30;
-	static const double XMIN=1.5;
-	static const double EPS=(3.0e-12);
+				m = static_cast<int>(std::min(t, 1000.0) + 0.5); 
+				u = (m - std::min(t, 1000.0)) * 0.69314718055994531; // ln(2) (m - t)
 
-	ax=fabs(x);
+				p2 = 1.0 + u*(1.0 + u*(1.0/2.0 + u*(1.0/6.0 + u*(1.0/24.0 + u*(1.0/120.0 + u*(1.0/720.0 + u*(1.0/5040.0 + u*(1.0/40320.0 + u/362880.0)))))))); 
 
-	if(ax<sqrt(FPMIN)){					// Special case: avoid failure of convergence
-		*s=0.0;							// test because of underflow.
-		*c=ax;
-	}else if(ax<=XMIN){					// Evaluate both series simultaneously.
-		sum=sums=0.0;
-		sumc=ax;
-		sign=1.0;
-		fact=PI_2*ax*ax;
-		odd=TRUE;
-		term=ax;
-		n=3;
-		for(k=1;k<=MAXIT;k++){
-			term *= fact/k;
-			sum += sign*term/n;
-			test=fabs(sum)*EPS;
-			if(odd){
-				sign = -sign;
-				sums=sum;
-				sum=sumc;
-			}else{
-				sumc=sum;
-				sum=sums;
+				bits = static_cast<long long>(1023 - m) << 52; // 2^{-m}
+				std::memcpy(&sc, &bits, sizeof(sc)); 
+
+				V[i] = cg * p2 * sc + cl / (1.0 + t); 
 			}
-			if(term<test)break;
-			odd=!odd;
-			n+=2;
 		}
-//		if (k > MAXIT) nrerror("series failed in frenel");
-		*s=sums;							
-		*c=sumc;
-	}else{								// Evaluate Integrals by use of Lentz's Continued Fraction Expansion Method
-		pix2=PI*ax*ax;
-		b=std::complex<double>(1.0,-pix2);
-		cc=std::complex<double>(1.0/FPMIN,0.0);
-		d=h=one/b;
-		n = -1;
-		for(k=2;k<=MAXIT;k++){
-			n+=2;
-			a=-n*(n+1);
-			b=b+4.0;
-			d=one/((a*d)+b);
-			cc=(b+(a/cc));
-			del=(cc*d);
-			h=(h*del);
-			if(fabs(del.real()-1.0)+fabs(del.imag())<EPS)break;
+		else{
+			std::string reason = "Error: void special::pseudo_Voigt_profile(int n, const double *x, double x0, double sigma, double gamma, double *V)\n"; 
+			reason += "sigma = " + template_funcs::toString(sigma) + ", gamma = " + template_funcs::toString(gamma) + " must be non-negative and not both zero\n"; 
+			throw std::invalid_argument(reason); 
 		}
-//		if (k > MAXIT) nrerror("cf failed in frenel");
-		h=(std::complex<double>(ax,-ax)*h);
-		cs=(std::complex<double>(0.5,0.5)*(one-(std::complex<double>(cos(0.5*pix2),sin(0.5*pix2))*h)));
-		*c=cs.real();
-		*s=cs.imag();
 	}
-	if(x<0.0){						// Use antisymmetry to obtain values for negative x
-		*c=-(*c);
-		*s=-(*s);
+	catch(std::invalid_argument &e){
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
 	}
 }
 
-double special::Ell_K(double x, bool conjugate)
+double special::pseudo_Voigt(double x, double h, double G, double x0)
 {
-	// Complete elliptic integral of the first kind defined by Hypergeometric function
-	// Abramowitz and Stegun, Ch 17, sect 17.3
-	// function computes K'(k) = K(1-k) when conjugate = true, otherwise returns K(k)
-	// R. Sheehan 23 - 11 - 2015
+	// Pseudo-Voigt approximation to Voigt(x, h, G, x0)
 
-	try{
+	double V; 
 
-		if(x >= 0.0 && x < 1){
+	pseudo_Voigt(1, &x, h, G, x0, &V); 
 
-			double F, dF; 
+	return V; 
+}
 
-			special::two_F_one( 0.5, 0.5, 1, ( conjugate ? 1.0 - x :  x ), F, dF); 
-		
-			return (F*PI_2);
+void special::pseudo_Voigt(int n, const double *x, double h, double G, double x0, double *V)
+{
+	// Voigt(x, h, G, x0) = h Re[w(z)] with z = s (x - x0 + i G / 2), s = 2 sqrt(log10(2)) / G, is the line shape
+	// Voigt_profile(x, x0, sigma, gamma) scaled by h sigma sqrt(2 pi), with sigma = 1 / (s sqrt(2)) and gamma = G / 2
 
-		}
-		else{
-			std::string reason; 
+	int i; 
+	double sigma, scl; 
 
-			reason = "Error in special::Ell_K(double x, bool conjugate)\n"; 
-			reason += "input argument x = " + template_funcs::toString(x, 3) + "\n"; 
+	sigma = G / (4.0 * sqrt(0.5 * log10(2.0))); 
+	scl = h * sigma * sqrt(2.0 * PI); 
+
+	pseudo_Voigt_profile(n, x, x0, sigma, 0.5 * G, V); 
+
+	for(i=0; i<n; i++) V[i] *= scl; 
+}
+
+special::VoigtSurrogate::VoigtSurrogate()
+{
+	// Default constructor, every point is passed to Faddeeva::w until build or load is called
+	ptol = pxmax = pymax = pcell = inv_cell = 0.0; 
+	pmaxlevel = nx = ny = 0; 
+}
+
+special::VoigtSurrogate::VoigtSurrogate(double tol, double xmax, double ymax, double cell, int maxlevel)
+{
+	// Primary constructor
+	build(tol, xmax, ymax, cell, maxlevel); 
+}
 
+void special::VoigtSurrogate::build(double tol, double xmax, double ymax, double cell, int maxlevel)
+{
+	// K is even in x, so the patches cover 0 <= x < xmax
+	// With w' = -2 z w + 2i / sqrt(pi) and w'' = -2 w - 2 z w', K_x = Re[w'], K_y = -Im[w'], K_xy = -Im[w''], so every patch corner
+	// costs one w(z); in the patch coordinates u = (x - x_c) / hp, v = (y - y_c) / hp the derivatives are scaled by hp and hp^2
+	// The coefficients are A = M F M^T with F = [f(0,0) f(0,1) f_v(0,0) f_v(0,1); f(1,0) f(1,1) f_v(1,0) f_v(1,1); f_u(0,0) ..; f_u(1,0) ..]
+	// and M the cubic Hermite basis matrix, see NRinC, sect. 3.6
+	// The test points include the edge v = 0, since on y = 0 K = exp(-x^2) is far smaller than K just above it for large x
+
+	try{
+		if( tol > 0.0 && xmax > 0.0 && ymax > 0.0 && cell > 0.0 && maxlevel >= 0 && maxlevel <= 10 ){
+
+			static const double M[4][4] = { {1.0, 0.0, 0.0, 0.0}, {0.0, 0.0, 1.0, 0.0}, {-3.0, 3.0, -2.0, -1.0}, {2.0, -2.0, 1.0, 1.0} }; 
+			static const double UT[4] = { 0.25, 0.5, 0.75, 0.0 }; // test points in each direction, in v also on the edge v = 0
+			static const double TEST_MARGIN = 0.25; // the error between the test points can be a few times larger
+
+			int i, j, l, np, pi, pj, a, b, c, d, ci, cj; 
+			double hp, xc, yc, F[4][4], MF[4][4], A[16], f[2][2], fu[2][2], fv[2][2], fuv[2][2]; 
+			std::complex<double> z, w, w1, w2; 
+			std::vector<double> cellcoef; 
+			bool ok; 
+
+			ptol = tol; pxmax = xmax; pymax = ymax; pcell = cell; pmaxlevel = maxlevel; 
+			inv_cell = 1.0 / cell; 
+
+			nx = static_cast<int>(ceil(xmax / cell)); 
+			ny = static_cast<int>(ceil(ymax / cell)); 
+
+			level.assign(nx * ny, 0); 
+			offset.assign(nx * ny, -1); 
+			coef.clear(); 
+
+			for(j=0; j<ny; j++){
+				for(i=0; i<nx; i++){
+
+					for(l=0; l<=maxlevel; l++){
+						np = 1 << l; 
+						hp = cell / np; 
+						ok = true; 
+						cellcoef.clear(); 
+
+						for(pj=0; pj<np && ok; pj++){
+							for(pi=0; pi<np && ok; pi++){
+
+								// corner values and scaled derivatives
+								for(ci=0; ci<2; ci++){
+									for(cj=0; cj<2; cj++){
+										xc = i * cell + (pi + ci) * hp; 
+										yc = j * cell + (pj + cj) * hp; 
+
+										z = std::complex<double>(xc, yc); 
+										w = Faddeeva::w(z); 
+										w1 = -2.0 * z * w + std::complex<double>(0.0, 2.0 / sqrt(PI)); 
+										w2 = -2.0 * w - 2.0 * z * w1; 
+
+										f[ci][cj] = real(w); 
+										fu[ci][cj] = hp * real(w1); 
+										fv[ci][cj] = -hp * imag(w1); 
+										fuv[ci][cj] = -hp * hp * imag(w2); 
+									}
+								}
+
+								for(a=0; a<2; a++){
+									for(b=0; b<2; b++){
+										F[a][b] = f[a][b]; 
+										F[a][b+2] = fv[a][b]; 
+										F[a+2][b] = fu[a][b]; 
+										F[a+2][b+2] = fuv[a][b]; 
+									}
+								}
+
+								for(a=0; a<4; a++){
+									for(b=0; b<4; b++){
+										MF[a][b] = 0.0; 
+										for(c=0; c<4; c++) MF[a][b] += M[a][c] * F[c][b]; 
+									}
+								}
+
+								for(a=0; a<4; a++){
+									for(b=0; b<4; b++){
+										A[4*b + a] = 0.0; 
+										for(d=0; d<4; d++) A[4*b + a] += MF[a][d] * M[b][d]; 
+									}
+								}
+
+								// compare with K at the test points
+								for(a=0; a<3 && ok; a++){
+									for(b=0; b<4 && ok; b++){
+										double u = UT[a], v = UT[b], p = 0.0, Kt; 
+
+										for(d=3; d>=0; d--) p = p * v + (((A[4*d + 3] * u + A[4*d + 2]) * u + A[4*d + 1]) * u + A[4*d]); 
+
+										Kt = exact(i * cell + (pi + u) * hp, j * cell + (pj + v) * hp); 
+
+										if( !(fabs(p - Kt) <= TEST_MARGIN * tol * Kt) ) ok = false; 
+									}
+								}
+
+								cellcoef.insert(cellcoef.end(), A, A + 16); 
+							}
+						}
+
+						if(ok){
+							level[i + nx*j] = l; 
+							offset[i + nx*j] = static_cast<int>(coef.size()); 
+							coef.insert(coef.end(), cellcoef.begin(), cellcoef.end()); 
+							break; 
+						}
+					}
+				}
+			}
+		}
+		else{
+			std::string reason = "Error: void special::VoigtSurrogate::build(double tol, double xmax, double ymax, double cell, int maxlevel)\n"; 
+			reason += "tol, xmax, ymax and cell must be positive and 0 <= maxlevel <= 10\n"; 
 			throw std::invalid_argument(reason); 
 		}
-
 	}
-	catch(std::invalid_argument &e){		
+	catch(std::invalid_argument &e){
 		useful_funcs::exit_failure_output(e.what()); 
 		exit(EXIT_FAILURE); 
 	}
 }
 
-double special::Ell_E(double x, bool conjugate)
+double special::VoigtSurrogate::exact(double x, double y) const
 {
-	// Complete elliptic integral of the second kind defined by Hypergeometric function
-	// Abramowitz and Stegun, Ch 17, sect 17.3
-	// function computes E'(k) = E(1-k) when conjugate = true, otherwise returns E(k)
-	// R. Sheehan 23 - 11 - 2015
+	// K(x, y) from Faddeeva::w_re
 
-	try{
+	return Faddeeva::w_re(x, y); 
+}
 
-		if(x >= 0.0 && x < 1){
+double special::VoigtSurrogate::K(double x, double y) const
+{
+	// Locate the cell and the patch by multiplication and truncation, then sum the bicubic by Horner's rule in u and in v
 
-			double F, dF; 
+	double ax = fabs(x); 
 
-			special::two_F_one( -0.5, 0.5, 1, ( conjugate ? 1.0 - x :  x ), F, dF); 
-		
-			return (F*PI_2);
+	if( ax < pxmax && y >= 0.0 && y < pymax ){
+		double sx = ax * inv_cell, sy = y * inv_cell; 
+		int i = static_cast<int>(sx), j = static_cast<int>(sy); 
+		int cell = i + nx*j; 
 
-		}
-		else{
-			std::string reason; 
+		if(offset[cell] >= 0){
+			int np = 1 << level[cell]; 
+			double ux = (sx - i) * np, vy = (sy - j) * np; 
+			int pi = std::min(static_cast<int>(ux), np - 1), pj = std::min(static_cast<int>(vy), np - 1); 
+			double u = ux - pi, v = vy - pj; 
+			const double *A = &coef[offset[cell] + 16 * (pi + np * pj)]; 
 
-			reason = "Error in special::Ell_E(double x, bool conjugate)\n"; 
-			reason += "input argument x = " + template_funcs::toString(x, 3) + "\n"; 
+			double p3 = ((A[15] * u + A[14]) * u + A[13]) * u + A[12]; 
+			double p2 = ((A[11] * u + A[10]) * u + A[9]) * u + A[8]; 
+			double p1 = ((A[7] * u + A[6]) * u + A[5]) * u + A[4]; 
+			double p0 = ((A[3] * u + A[2]) * u + A[1]) * u + A[0]; 
 
-			throw std::invalid_argument(reason); 
+			return ( ((p3 * v + p2) * v + p1) * v + p0 ); 
 		}
-
-	}
-	catch(std::invalid_argument &e){		
-		useful_funcs::exit_failure_output(e.what()); 
-		exit(EXIT_FAILURE); 
 	}
+
+	return exact(x, y); 
 }
 
-void special::Ell_K_E(double k, double &Kval, double &Eval, bool conjugate)
+void special::VoigtSurrogate::K(int n, const double *x, const double *y, double *res) const
 {
-	// complete elliptic integrals of the first and second kind
-	// polynomial approximation accurate to within |eps| <= 2e-8 when 0 <= k < 1
-	// Abramowitz and Stegun, Ch 17, sect 17.3
-	// functions compute K'(k) = K(1-k) when conjugate = true, otherwise returns K(k), or E(k)
-	// R. Sheehan 23 - 11 - 2015
+	// K at the n points (x[i], y[i])
 
-	//double arg = (conjugate ? k: 1.0 - k); // decide on the argument, i.e. return K(k) or K'(k) = K(1-k)
+	for(int i=0; i<n; i++) res[i] = K(x[i], y[i]); 
+}
 
-	try{
+double special::VoigtSurrogate::Voigt(double x, double h, double G, double x0) const
+{
+	// Voigt(x, h, G, x0) = h K(s (x - x0), s G / 2), s = 2 sqrt(log10(2)) / G
 
-		if(k >= 0.0 && k < 1){
+	static const double s = 2.0 * sqrt(log10(2.0)); 
 
-			// polynomial coefficients for K(k)
-			double AK[5] = {1.38629436112, 0.09666344259, 0.03590092383, 0.03742563713, 0.01451196212}; 
-			double BK[5] = {0.5, 0.12498593597, 0.06880248576, 0.03328355346, 0.00441787012};
+	double scl = s / G; 
 
-			// polynomial coefficients for E(k)
-			double AE[5] = {1.0, 0.44325141463, 0.06260601220, 0.04757383546, 0.01736506451}; 
-			double BE[5] = {0.0, 0.24998368310, 0.09200180037, 0.04069697526, 0.00526449639};
+	return ( h * K((x - x0) * scl, 0.5 * s) ); 
+}
 
-			double m1 = (1.0 - ( conjugate ? 1.0 - k :  k ) ); 
-			double lnm1 = log(1.0/m1); 
-			double akval, bkval, aeval, beval; 
+double special::VoigtSurrogate::Voigt_profile(double x, double x0, double sigma, double gamma) const
+{
+	// Voigt_profile(x, x0, sigma, gamma) = K((x - x0) / (sigma sqrt(2)), gamma / (sigma sqrt(2))) / (sigma sqrt(2 pi)), sigma > 0
 
-			// evaluate all polynomials simultaneously
-			akval = AK[4]; bkval = BK[4]; // K(k)
-			aeval = AE[4]; beval = BE[4]; // E(k)
-			for(int i=3; i>=0; i--){
-				// K(k)
-				akval = akval*m1 + AK[i]; 
-				bkval = bkval*m1 + BK[i]; 
+	static const double rt2 = sqrt(2.0), rtpi = sqrt(PI); 
 
-				// B(k)
-				aeval = aeval*m1 + AE[i]; 
-				beval = beval*m1 + BE[i]; 
-			}
+	double scl = 1.0 / (sigma * rt2); 
 
-			// multiply b polynomials by lnm1
-			bkval *= lnm1; beval *= lnm1; 
+	return ( K((x - x0) * scl, gamma * scl) * scl / rtpi ); 
+}
 
-			// Assign values for K(k) and E(k)
-			Kval = (akval + bkval); 
-			Eval = (aeval + beval);
+double special::VoigtSurrogate::coverage() const
+{
+	// Fraction of the cells covered by patches
 
-		}
-		else{
-			std::string reason; 
+	int i, m = 0; 
 
-			reason = "Error in special::Ell_K_E(double k, double &Kval, double &Eval, bool conjugate)\n"; 
-			reason += "input argument k = " + template_funcs::toString(k, 3) + "\n"; 
+	for(i=0; i<nx*ny; i++) if(offset[i] >= 0) m++; 
 
-			throw std::invalid_argument(reason); 
-		}
+	return ( nx*ny > 0 ? static_cast<double>(m) / (nx*ny) : 0.0 ); 
+}
 
-	}
-	catch(std::invalid_argument &e){		
-		useful_funcs::exit_failure_output(e.what()); 
-		exit(EXIT_FAILURE); 
-	}
+bool special::VoigtSurrogate::save(const std::string &filename) const
+{
+	// Write the tables in binary, preceded by a tag and the parameters they were built with
+
+	std::ofstream write(filename.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc); 
+
+	if( !write.is_open() ) return false; 
+
+	int ncoef = static_cast<int>(coef.size()); 
+
+	write.write("VSUR0001", 8); 
+	write.write(reinterpret_cast<const char*>(&ptol), sizeof(double)); 
+	write.write(reinterpret_cast<const char*>(&pxmax), sizeof(double)); 
+	write.write(reinterpret_cast<const char*>(&pymax), sizeof(double)); 
+	write.write(reinterpret_cast<const char*>(&pcell), sizeof(double)); 
+	write.write(reinterpret_cast<const char*>(&pmaxlevel), sizeof(int)); 
+	write.write(reinterpret_cast<const char*>(&nx), sizeof(int)); 
+	write.write(reinterpret_cast<const char*>(&ny), sizeof(int)); 
+	write.write(reinterpret_cast<const char*>(&ncoef), sizeof(int)); 
+	write.write(reinterpret_cast<const char*>(level.data()), nx * ny * sizeof(int)); 
+	write.write(reinterpret_cast<const char*>(offset.data()), nx * ny * sizeof(int)); 
+	write.write(reinterpret_cast<const char*>(coef.data()), ncoef * sizeof(double)); 
+
+	return write.good(); 
 }
 
-double special::Voigt(double x, double h, double G, double x0)
+bool special::VoigtSurrogate::load(const std::string &filename)
 {
-	// This is an implementation of the Voigt function
-	// presumably x represents frequency
-	// x0 represents centre frequency
-	// h represents amplitude factor
-	// G represents HWHM
+	// Read tables written by save, checking the tag and that every offset points inside the coefficient table
 
-	// There are problems with this implementation
-	// Technically Lorentz HWHM != Gauss HWHM so there should be another parameter
-	// Also the scale factor of 2.0 * sqrt(log10(2.0)) doesn't make any sense
-	// unless the idea was to have that factor be related to the real Gaussian HWHM 
-	// which is sqrt( 2 log(2) ) c
-	// R. Sheehan 30 - 11 - 2021
+	std::ifstream read(filename.c_str(), std::ios_base::in | std::ios_base::binary); 
 
-	std::complex<double> z = ((x - x0 + 0.5*eye * G) * (2.0 * sqrt(log10(2.0)) / G));
-	std::complex<double> acb = 2.0 * sqrt(log10(2.0)) / (sqrt(PI) * G);
-	
-	return ( real(h * Faddeeva::w(z)) );
+	if( !read.is_open() ) return false; 
+
+	char tag[8]; 
+	double tol, xmax, ymax, cell; 
+	int maxlevel, mx, my, ncoef, i; 
+
+	read.read(tag, 8); 
+	if( !read.good() || std::string(tag, 8) != "VSUR0001" ) return false; 
+
+	read.read(reinterpret_cast<char*>(&tol), sizeof(double)); 
+	read.read(reinterpret_cast<char*>(&xmax), sizeof(double)); 
+	read.read(reinterpret_cast<char*>(&ymax), sizeof(double)); 
+	read.read(reinterpret_cast<char*>(&cell), sizeof(double)); 
+	read.read(reinterpret_cast<char*>(&maxlevel), sizeof(int)); 
+	read.read(reinterpret_cast<char*>(&mx), sizeof(int)); 
+	read.read(reinterpret_cast<char*>(&my), sizeof(int)); 
+	read.read(reinterpret_cast<char*>(&ncoef), sizeof(int)); 
+
+	if( !read.good() || !(cell > 0.0) || mx <= 0 || my <= 0 || mx != static_cast<int>(ceil(xmax / cell)) || my != static_cast<int>(ceil(ymax / cell)) ) return false; 
+	if( maxlevel < 0 || maxlevel > 10 || ncoef < 0 || ncoef % 16 != 0 ) return false; 
+
+	std::vector<int> lv(mx * my), off(mx * my); 
+	std::vector<double> cf(ncoef); 
+
+	read.read(reinterpret_cast<char*>(lv.data()), mx * my * sizeof(int)); 
+	read.read(reinterpret_cast<char*>(off.data()), mx * my * sizeof(int)); 
+	read.read(reinterpret_cast<char*>(cf.data()), ncoef * sizeof(double)); 
+
+	if( !read.good() ) return false; 
+
+	for(i=0; i<mx*my; i++){
+		if( lv[i] < 0 || lv[i] > maxlevel ) return false; 
+		if( off[i] >= 0 && static_cast<long long>(off[i]) + 16LL * (1LL << (2 * lv[i])) > ncoef ) return false; 
+	}
+
+	ptol = tol; pxmax = xmax; pymax = ymax; pcell = cell; pmaxlevel = maxlevel; 
+	inv_cell = 1.0 / cell; 
+	nx = mx; ny = my; 
+	level.swap(lv); offset.swap(off); coef.swap(cf); 
+
+	return true; 
 }
\ No newline at end of file
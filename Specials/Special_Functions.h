@@ -13,8 +13,130 @@
 namespace special{
 
 	// Hypergeometric Function
+	// Defined for all real x, for x > 1 the real part of the analytic continuation is returned
 	void two_F_one(double a, double b, double c, double x, double &F, double &dF); 
 
+	double two_F_one(double a, double b, double c, double x); 
+
+	// Pieces used by two_F_one to select the fastest converging representation of 2F1(a, b; c; x)
+	double two_F_one_series(double a, double b, double c, double x, int &nterms, bool accelerate = true); // power series about x = 0, used for |x| <= 1/2
+
+	double two_F_one_one_minus_x(double a, double b, double c, double x); // transformation x -> 1 - x, used for 1/2 < x <= 3/2
+
+	double two_F_one_one_over_x(double a, double b, double c, double x); // transformation x -> 1 / x, used for x > 1
+
+	// Power series for 2F1(a, b; c; x) with fixed parameters, truncated once for a target tolerance on |x| <= xmax
+	// Used for sweeps over many x at the same (a, b, c), e.g. Legendre functions and elliptic integrals
+	// Points with |x| > xmax are passed to two_F_one
+	class HypergeometricSeries{
+	public:
+		HypergeometricSeries(); 
+		HypergeometricSeries(double a, double b, double c, double xmax = 0.5, double tol = EPS); 
+
+		void set_params(double a, double b, double c, double xmax = 0.5, double tol = EPS); 
+
+		int degree() const { return static_cast<int>(coef.size()) - 1; }
+
+		double value(double x) const; 
+		void value(double x, double &F, double &dF) const; 
+
+		// F[i] = 2F1(a, b; c; x[i]), dF[i] = dF/dx at x[i] when dF != nullptr
+		void evaluate(int n, const double *x, double *F, double *dF = nullptr) const; 
+
+	private:
+		double pa, pb, pc, pxmax; 
+
+		std::vector<double> coef; // coef[k] = (a)_k (b)_k / ( (c)_k k! )
+		std::vector<double> dcoef; // dcoef[k] = (k+1) coef[k+1], coefficients of dF/dx
+	};
+
+	// Confluent Hypergeometric Functions, A&S Ch. 13
+	// Kummer's function M(a, b, x) = {1}_F_{1}(a; b; x), defined for all real x when b is not a non-positive integer
+	// Tricomi's function U(a, b, x), defined for x > 0
+	double one_F_one(double a, double b, double x); 
+
+	double tricomi_U(double a, double b, double x); 
+
+	// Abscissas and weights of the n point Gauss-Laguerre rule for the weight function x^{alf} exp(-x), NRinC sect. 4.5
+	// the weights are multiplied by exp(-lnscale)
+	void gaulag(int n, double alf, double *x, double *w, double lnscale = 0.0); 
+
+	// M(a, b, x) and U(a, b, x) with fixed parameters
+	// Everything that depends only on (a, b) is computed once by set_params: gamma function prefactors, the points beyond which
+	// the asymptotic expansions reach full precision, the quadrature rules used by U and, when tabulate = true, the series and
+	// asymptotic coefficients. Each x is then sent to the series, asymptotic expansion or recurrence that is cheapest for it
+	// one_F_one and tricomi_U use an untabulated object, grids of x should use this class directly
+	class ConfluentHypergeometric{
+	public:
+		ConfluentHypergeometric(); 
+		ConfluentHypergeometric(double a, double b, bool tabulate = true); 
+
+		void set_params(double a, double b, bool tabulate = true); 
+
+		double M(double x) const; 
+		double U(double x) const; 
+
+		// res[i] = M(a, b, x[i]), res[i] = U(a, b, x[i])
+		void M(int n, const double *x, double *res) const; 
+		void U(int n, const double *x, double *res) const; 
+
+	private:
+		// Fixed parameter data for M(alpha, beta, x), x >= 0
+		struct KummerSet{
+			double alpha, beta; 
+			bool poly; // alpha is a non-positive integer, M is a polynomial
+			int sgn1, sgn2; 
+			double lg1, lg2; // Gamma(beta) / Gamma(alpha) = sgn1 exp(lg1), cos(pi alpha) Gamma(beta) / Gamma(beta - alpha) = sgn2 exp(lg2)
+			double xasym; // the asymptotic expansion reaches full precision for x >= xasym
+			int seed; // index of the two sets from which the recurrence in alpha starts, -1 if none
+			int useed; // index of the sets for U(alpha, beta, x) and U(alpha, beta+1, x) used when alpha < -1, -1 if none
+			std::vector<double> ser; // ratios of successive series terms, (alpha+k) / ( (beta+k) (k+1) )
+			std::vector<double> asy; // (beta-alpha)_k (1-alpha)_k / k!
+			std::vector<double> sub; // (alpha)_k (1+alpha-beta)_k / k!
+		}; 
+
+		// Fixed parameter data for U(a, b, x), x > 0
+		struct TricomiSet{
+			double a, b; 
+			int poly; // 0: not a polynomial, 1: a is a non-positive integer, 2: a - b + 1 is a non-positive integer
+			bool bint; // b is an integer, the small x form is logarithmic
+			int nrec; // number of downward recurrence steps from a0 = a + nrec in (0, 1] when a <= 0
+			double g1, g2; // Gamma(1-b) / Gamma(a-b+1), Gamma(b-1) / Gamma(a)
+			double xasym; 
+			std::vector<double> asy; // (a)_k (a-b+1)_k / k!
+			std::vector<double> qx0, qw0, qx1, qw1; // Gauss-Laguerre rules at a0 and a0 + 1, weights normalised to sum to one
+		}; 
+
+		void set_kummer(KummerSet &s, double alpha, double beta, bool tabulate); 
+		void set_tricomi(TricomiSet &t, double a, double b, bool tabulate); 
+
+		double M_pos(int set, double x) const; 
+		double M_series(const KummerSet &s, double x, double *asum = nullptr) const; 
+		bool M_asymp(const KummerSet &s, double x, double &val) const; 
+		double M_recur(const KummerSet &s, double x) const; 
+		double M_brecur(const KummerSet &s, double x) const; 
+		double M_arecur(const KummerSet &s, double x) const; 
+		double M_wronskian(const KummerSet &s, double x) const; 
+		double series_cost(const KummerSet &s, double x) const; 
+
+		double U_eval(const TricomiSet &t, double x) const; 
+		double U_poly(double a, double b, double x) const; 
+		double U_log(double a, int n, double x) const; 
+		double U_small(const TricomiSet &t, double x, double *cond = nullptr) const; 
+		bool U_asymp(const TricomiSet &t, double x, double &val) const; 
+		double U_quad(const TricomiSet &t, double x) const; 
+		double U_miller(double x) const; 
+
+		static double lngamma(double y, int &sgn); 
+		static double asym_start(const std::vector<double> &c); 
+
+		double pa, pb; 
+		bool valid_M; 
+
+		std::vector<KummerSet> sets; // sets[0]: (a, b), sets[1]: (b - a, b) for x < 0 through Kummer's transformation, then recurrence starts
+		std::vector<TricomiSet> usets; // usets[0]: (a, b), then (a - b + 1, 2 - b) when a > 2 and b > a + 1, or (a - floor(a), b) for the recurrence when a > 2, then the sets used by M_wronskian
+	};
+
 	// Bessel Functions of integer order
 	double bessel_J(int n, double x); // Bessel Function of the 1st kind Jnu(x)
 
@@ -60,6 +182,48 @@ namespace special{
 	// j_{n}(x), y_{n}(x) and their derivatives
 	void sphbes(int n, double x, double *sj, double *sy, double *sjp, double *syp); 
 
+	// Coulomb wave functions, A&S Ch. 14
+	// F_{L}(eta, rho), G_{L}(eta, rho) and their derivatives with respect to rho for L = lmin, lmin+1, .., lmin+nl-1
+	// rho > 0, lmin > -1, the arrays fc, gc, fcp, gcp have length nl
+	void coulomb(double eta, double rho, double lmin, int nl, double *fc, double *gc, double *fcp, double *gcp); 
+
+	// Coulomb wave functions with fixed (eta, lmin, nl), evaluated by Steed's method as in bessjy
+	// Inside the barrier, where CF2 cannot resolve F << G, F_{lmin} is normalised by its power series instead
+	// Everything that does not depend on rho, the coefficients of the recurrences in L, of both continued fractions and of the
+	// power series, is computed once by set_params, with the series and continued fraction coefficients tabulated when tabulate = true
+	class CoulombWave{
+	public:
+		CoulombWave(); 
+		CoulombWave(double eta, double lmin, int nl = 1, bool tabulate = true); 
+
+		void set_params(double eta, double lmin, int nl = 1, bool tabulate = true); 
+
+		int size() const { return pnl; }
+
+		// F[j] = F_{lmin+j}(eta, rho), G[j] = G_{lmin+j}(eta, rho), j = 0, .., nl-1, derivatives are stored when Fp, Gp != nullptr
+		void evaluate(double rho, double *F, double *G, double *Fp = nullptr, double *Gp = nullptr) const; 
+
+		// The L ladder at rho[i] is stored at F[i*nl + j], i = 0, .., n-1, and likewise for G, Fp, Gp
+		void evaluate(int n, const double *rho, double *F, double *G, double *Fp = nullptr, double *Gp = nullptr) const; 
+
+	private:
+		double cf1(double rho, int &isign) const; 
+		std::complex<double> cf2(double rho) const; 
+		double phi(double rho) const; 
+
+		static double lnabsgamma(double x, double y); 
+
+		double peta, plmin; 
+		int pnl; 
+
+		std::vector<double> rl, sl; // R_{L} = sqrt(1 + eta^2 / L^2), eta / L for L = lmin+1, .., lmin+nl-1
+		std::vector<double> cf1_a, cf1_c; // -R_{k}^2 and eta (2k+1) / (k (k+1)) for k = lmax+1, lmax+2, ..
+		std::vector< std::complex<double> > cf2_a; // (k - L + i eta) (k + L + 1 + i eta) for L = lmin, k = 0, 1, ..
+
+		double lncl; // ln C_{lmin}(eta), the normalisation of the power series for F
+		std::vector<double> ser_a; // coefficients of the power series for F_{lmin}, A&S 14.1.3
+	}; 
+
 	// Struve Functions Hnu(x)
 	double struveh0(double x); 
 	double struveh1(double x); 
@@ -71,7 +235,7 @@ namespace special{
 	void airy(double x, double *ai, double *bi, double *aip, double *bip); 
 	
 	// Fresnel Integrals
-	void fresnel(double x, double *s, double *c); // Fresnel Integrals 
+	void fresnel(double x, double *s, double *c, int *nits = nullptr, bool accelerate = true); // Fresnel Integrals, nits returns the number of iterations used, accelerate = false for comparison
 
 	// Complete Elliptic Integrals of the First and Second Kinds
 
@@ -81,6 +245,81 @@ namespace special{
 	void Ell_K_E(double k, double &Kval, double &Eval, bool conjugate = false); // polynomial approximation to K(k) and E(k) and their conjugates
 
 	double Voigt(double x, double h, double G, double x0); // Voigt function, convolution of a Gaussian and a Lorentzian
+	void Voigt(int n, const double *x, double h, double G, double x0, double *V, Faddeeva::Method method = Faddeeva::ADAPTIVE); // Voigt function at the n points x[i], uses the array version of Faddeeva::w
+	float Voigt(float x, float h, float G, float x0); // single-precision Voigt function, relative accuracy better than 2e-6
+	void Voigt(int n, const float *x, float h, float G, float x0, float *V); // single-precision Voigt function at the n points x[i], uses the float array version of Faddeeva::w
+
+	// Normalised Voigt functions K(x, y) = Re[w(x + iy)] and L(x, y) = Im[w(x + iy)], the absorption and dispersion profiles
+	// Voigt_K computes Re[w] alone in real arithmetic by Faddeeva::w_re, use it when L is not needed
+	double Voigt_K(double x, double y); 
+	void Voigt_K(int n, const double *x, const double *y, double *K); 
+	void Voigt_KL(double x, double y, double &K, double &L); 
+	void Voigt_KL(int n, const double *x, const double *y, double *K, double *L); 
+
+	// Plasma dispersion function of Fried and Conte, Z(zeta) = i sqrt(pi) w(zeta), and Z'(zeta) = -2 (1 + zeta Z(zeta))
+	// w is entire, so this is also the Landau continuation of Z into Im(zeta) < 0, through w(zeta) = 2 exp(-zeta^2) - w(-zeta)
+	// Z' reuses the w of Z, and is summed from its asymptotic series for |zeta| >= 15 where 1 + zeta Z cancels
+	std::complex<double> plasma_Z(std::complex<double> zeta); 
+	std::complex<double> plasma_Z(std::complex<double> zeta, std::complex<double> &dZ); 
+	void plasma_Z(int n, const double *re, const double *im, double *Zr, double *Zi, double *dZr = nullptr, double *dZi = nullptr); 
+
+	// Voigt function with its derivatives with respect to the parameters, dV[0] = dV/dh, dV[1] = dV/dG, dV[2] = dV/dx0
+	// The derivatives come from the same w(z) through dw/dz = -2 z w(z) + 2i / sqrt(pi), so cost little more than the value
+	double Voigt_grad(double x, double h, double G, double x0, double *dV); 
+	void Voigt_grad(int n, const double *x, double h, double G, double x0, double *V, double *dVdh, double *dVdG, double *dVdx0, Faddeeva::Method method = Faddeeva::ADAPTIVE); 
+
+	// Voigt line shape centred on x0, the convolution of a Gaussian of standard deviation sigma with a Lorentzian of HWHM gamma
+	// Its area is one, sigma = 0 gives the Lorentzian and gamma = 0 the Gaussian, see line_spectrum for sums of many lines
+	double Voigt_profile(double x, double x0, double sigma, double gamma); 
+	void Voigt_profile(int n, const double *x, double x0, double sigma, double gamma, double *V, Faddeeva::Method method = Faddeeva::ADAPTIVE); 
+	double Voigt_hwhm(double sigma, double gamma); // HWHM of the Voigt line shape, Olivero and Longbothum approximation, relative error < 2e-4
+
+	// Pseudo-Voigt approximation of Thompson, Cox and Hastings, J. Appl. Cryst., 20, 79, 1987, with the same parameters as the
+	// exact functions above, eta L + (1 - eta) G for a Lorentzian L and a Gaussian G of a common FWHM, one division and a short polynomial for the Gaussian per point, with no calls to exp
+	// Its largest deviation from the exact function is 1.3% of the peak value, at gamma ~ sigma, and below 0.1% for gamma / sigma < 0.03
+	// or > 10, see Pseudo_Voigt_Test in Main.cpp
+	double pseudo_Voigt(double x, double h, double G, double x0); 
+	void pseudo_Voigt(int n, const double *x, double h, double G, double x0, double *V); 
+	double pseudo_Voigt_profile(double x, double x0, double sigma, double gamma); 
+	void pseudo_Voigt_profile(int n, const double *x, double x0, double sigma, double gamma, double *V); 
+
+	// Surrogate for the normalised Voigt function K(x, y) = Re[w(x + iy)] on |x| < xmax, 0 <= y < ymax, built once and then
+	// evaluated with about 30 flops and no transcendental functions
+	// The region is divided into square cells of side cell, each cell is split uniformly into 4^l patches, with the smallest l <= maxlevel
+	// for which the bicubic Hermite interpolant of K, K_x, K_y, K_xy at the patch corners is within tol / 4 relative of K at 3 x 4 test
+	// points in every patch; cells that need more than maxlevel levels, e.g. near y = 0 for x > 4 where K falls to exp(-x^2),
+	// and points outside the region are passed to Faddeeva::w
+	class VoigtSurrogate{
+	public:
+		VoigtSurrogate(); 
+		VoigtSurrogate(double tol, double xmax = 8.0, double ymax = 8.0, double cell = 0.5, int maxlevel = 5); 
+
+		void build(double tol, double xmax = 8.0, double ymax = 8.0, double cell = 0.5, int maxlevel = 5); 
+
+		// Binary file of the patch tables, load returns false and leaves the surrogate unchanged if the file cannot be read
+		bool save(const std::string &filename) const; 
+		bool load(const std::string &filename); 
+
+		double K(double x, double y) const; 
+		void K(int n, const double *x, const double *y, double *res) const; 
+
+		double Voigt(double x, double h, double G, double x0) const; // special::Voigt(x, h, G, x0)
+		double Voigt_profile(double x, double x0, double sigma, double gamma) const; // special::Voigt_profile(x, x0, sigma, gamma)
+
+		double tolerance() const { return ptol; }
+		double coverage() const; // fraction of the region covered by patches rather than passed to Faddeeva::w
+		int patches() const { return static_cast<int>(coef.size() / 16); }
+
+	private:
+		double exact(double x, double y) const; 
+
+		double ptol, pxmax, pymax, pcell, inv_cell; 
+		int pmaxlevel, nx, ny; 
+
+		std::vector<int> level; // level of each cell, cell (i, j) at i + nx*j
+		std::vector<int> offset; // index in coef of its first patch, -1 for a cell passed to Faddeeva::w
+		std::vector<double> coef; // 16 coefficients a_{ij}, at 4*j + i, of each patch sum_{i,j} a_{ij} u^i v^j, u, v in [0, 1]
+	}; 
 }
 
 #endif
\ No newline at end of file
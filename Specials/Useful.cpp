@@ -127,4 +127,37 @@ double useful_funcs::poly(double x, double *b, int m)
 	}
 
 	return p;
+}
+
+double useful_funcs::sinpi(double x)
+{
+	// Compute sin(pi x) after reducing x to [-1/2, 1/2]
+	// Reduction is exact, so sin(pi n) = 0 for all integers n, which matters for reflection formulae
+	// where sin(pi x) multiplies or divides a quantity that is large near the integers
+
+	double n = floor(x + 0.5); // nearest integer to x
+	double r = x - n; // |r| <= 1/2
+	double s = sin(PI*r);
+
+	return ( fmod(n, 2.0) == 0.0 ? s : -s );
+}
+
+double useful_funcs::cospi(double x)
+{
+	// Compute cos(pi x) after reducing x to [-1/2, 1/2]
+	// cos(pi (n + 1/2)) = 0 exactly for all integers n
+
+	double n = floor(x + 0.5); // nearest integer to x
+	double r = x - n; // |r| <= 1/2
+	double c = ( fabs(r) == 0.5 ? 0.0 : cos(PI*r) );
+
+	return ( fmod(n, 2.0) == 0.0 ? c : -c );
+}
+
+bool useful_funcs::is_integer(double x, double tol)
+{
+	// Test whether x lies within tol of an integer
+	// tol = 0 gives an exact test
+
+	return ( fabs(x - floor(x + 0.5)) <= tol );
 }
\ No newline at end of file
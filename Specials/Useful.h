@@ -14,6 +14,12 @@ namespace useful_funcs{
 
 	double poly(double x, double *b, int m); 
 
+	double sinpi(double x); // sin(pi x) with exact zeros at the integers
+
+	double cospi(double x); // cos(pi x) with exact zeros at the half-integers
+
+	bool is_integer(double x, double tol = 0.0); // is x within tol of an integer
+
 }
 
 #endif
\ No newline at end of file
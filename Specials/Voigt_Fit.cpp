@@ -0,0 +1,344 @@
+#ifndef ATTACH_H
+#include "Attach.h"
+#endif
+
+// Definition of the Levenberg-Marquardt Voigt fitter declared in the namespace voigt_fit
+
+namespace {
+
+	// Storage used by one fit, each thread of fit_all keeps one and reuses it for every spectrum it fits
+	struct Workspace{
+		std::vector<double> J; // column j holds d(model)/dp_j / sig_i, stored at J[j*n + i]
+		std::vector<double> r; // (y_i - model_i) / sig_i
+		std::vector<double> V; // one peak at a time
+		std::vector<double> alpha, beta; // J^T J and J^T r
+	}; 
+
+	double evaluate(const voigt_fit::Spectrum &s, const std::vector<double> &p, Faddeeva::Method method, Workspace &ws)
+	{
+		// Fill the weighted residual and Jacobian at the parameters p, form the normal equations and return chi^2
+		// Each peak is passed to the array version of special::Voigt_grad, which gives its value and its three Jacobian columns
+		// from one w(z) per point
+
+		int i, j, k, n, np; 
+		double chisq; 
+		double *Jh, *JG, *Jx0; 
+
+		n = static_cast<int>(s.x.size()); 
+		np = static_cast<int>(p.size()); 
+
+		ws.J.resize(n * np); ws.r.resize(n); ws.V.resize(n); 
+		ws.alpha.resize(np * np); ws.beta.resize(np); 
+
+		for(i=0; i<n; i++) ws.r[i] = s.y[i]; 
+
+		for(k=0; k<np; k+=voigt_fit::NPAR){
+			Jh = &ws.J[k*n]; JG = &ws.J[(k+1)*n]; Jx0 = &ws.J[(k+2)*n]; 
+
+			special::Voigt_grad(n, s.x.data(), p[k], p[k+1], p[k+2], ws.V.data(), Jh, JG, Jx0, method); 
+
+			for(i=0; i<n; i++) ws.r[i] -= ws.V[i]; 
+		}
+
+		if( !s.sig.empty() ){
+			for(i=0; i<n; i++) ws.r[i] /= s.sig[i]; 
+
+			for(j=0; j<np; j++){
+				for(i=0; i<n; i++) ws.J[j*n + i] /= s.sig[i]; 
+			}
+		}
+
+		chisq = 0.0; 
+		for(i=0; i<n; i++) chisq += ws.r[i] * ws.r[i]; 
+
+		// alpha and beta as dot products of columns, the upper triangle is copied to the lower
+		for(j=0; j<np; j++){
+			const double *Jj = &ws.J[j*n]; 
+
+			for(k=j; k<np; k++){
+				const double *Jk = &ws.J[k*n]; 
+				double sum = 0.0; 
+
+				for(i=0; i<n; i++) sum += Jj[i] * Jk[i]; 
+
+				ws.alpha[j*np + k] = ws.alpha[k*np + j] = sum; 
+			}
+
+			double sum = 0.0; 
+
+			for(i=0; i<n; i++) sum += Jj[i] * ws.r[i]; 
+
+			ws.beta[j] = sum; 
+		}
+
+		return chisq; 
+	}
+
+	bool cholesky(int n, std::vector<double> &A)
+	{
+		// Cholesky factorisation A = L L^T of the symmetric n*n matrix A, L is stored in the lower triangle of A
+		// Returns false when A is not positive definite
+
+		int i, j, k; 
+		double sum; 
+
+		for(i=0; i<n; i++){
+			for(j=i; j<n; j++){
+				sum = A[i*n + j]; 
+
+				for(k=i-1; k>=0; k--) sum -= A[i*n + k] * A[j*n + k]; 
+
+				if(i == j){
+					if(sum <= 0.0) return false; 
+
+					A[i*n + i] = sqrt(sum); 
+				}
+				else{
+					A[j*n + i] = sum / A[i*n + i]; 
+				}
+			}
+		}
+
+		return true; 
+	}
+
+	void cholesky_solve(int n, const std::vector<double> &L, const double *b, double *x)
+	{
+		// Solve L L^T x = b with the factor computed by cholesky, x and b may be the same array
+
+		int i, k; 
+		double sum; 
+
+		for(i=0; i<n; i++){
+			sum = b[i]; 
+			for(k=i-1; k>=0; k--) sum -= L[i*n + k] * x[k]; 
+			x[i] = sum / L[i*n + i]; 
+		}
+
+		for(i=n-1; i>=0; i--){
+			sum = x[i]; 
+			for(k=i+1; k<n; k++) sum -= L[k*n + i] * x[k]; 
+			x[i] = sum / L[i*n + i]; 
+		}
+	}
+
+	void check_spectrum(const voigt_fit::Spectrum &s)
+	{
+		// Throw std::invalid_argument if the spectrum cannot be fitted
+
+		int i, n, np; 
+
+		n = static_cast<int>(s.x.size()); 
+		np = static_cast<int>(s.p.size()); 
+
+		if( np == 0 || np % voigt_fit::NPAR != 0 ) throw std::invalid_argument("voigt_fit: the length of p must be a positive multiple of 3\n"); 
+
+		if( static_cast<int>(s.y.size()) != n || ( !s.sig.empty() && static_cast<int>(s.sig.size()) != n ) ) throw std::invalid_argument("voigt_fit: x, y and sig must have the same length\n"); 
+
+		if( n <= np ) throw std::invalid_argument("voigt_fit: there must be more points than parameters\n"); 
+
+		for(i=0; i<static_cast<int>(s.sig.size()); i++){
+			if( !(s.sig[i] > 0.0) ) throw std::invalid_argument("voigt_fit: sig must be positive\n"); 
+		}
+
+		for(i=1; i<np; i+=voigt_fit::NPAR){
+			if( !(s.p[i] > 0.0) ) throw std::invalid_argument("voigt_fit: the starting widths G must be positive\n"); 
+		}
+	}
+
+	voigt_fit::Result fit_spectrum(const voigt_fit::Spectrum &s, const voigt_fit::Options &opt, Workspace &ws)
+	{
+		// Levenberg-Marquardt iteration as in NRinC, sect. 15.5.2, for a spectrum that has passed check_spectrum
+		// A step is solved from (alpha + lambda diag(alpha)) dp = beta by Cholesky factorisation, a step that raises chi^2,
+		// makes a width G non-positive or meets a matrix that is not positive definite is rejected and lambda raised ten-fold
+		// The fit has converged when an accepted step lowers chi^2, or changes every parameter, by less than tol relative
+		// It stops unconverged once lambda exceeds LAMBDA_MAX, where no step downhill is left: the fit has stalled, the start is
+		// degenerate or every step is rejected, and the standard errors are then those of a matrix that may be near singular
+
+		static const double LAMBDA_MAX = 1.0e16; 
+
+		int j, n, np; 
+		double lambda, chisq, trial_chisq, dmax; 
+		bool small_step; 
+		std::vector<double> p, trial, A, dp, alpha, beta; 
+		voigt_fit::Result res; 
+
+		n = static_cast<int>(s.x.size()); 
+		np = static_cast<int>(s.p.size()); 
+
+		p = s.p; 
+		trial.resize(np); dp.resize(np); 
+
+		chisq = evaluate(s, p, opt.method, ws); 
+		alpha = ws.alpha; beta = ws.beta; 
+
+		lambda = opt.lambda; 
+		res.converged = false; 
+
+		for(res.iterations=1; res.iterations<=opt.max_iter; res.iterations++){
+
+			// a parameter whose column of J vanishes, e.g. G and x0 of a peak with h = 0, is held by the EPS * dmax term
+			dmax = 0.0; 
+			for(j=0; j<np; j++) dmax = std::max(dmax, alpha[j*np + j]); 
+
+			A = alpha; 
+			for(j=0; j<np; j++) A[j*np + j] += lambda * (alpha[j*np + j] + EPS * dmax); 
+
+			if( dmax > 0.0 && cholesky(np, A) ){
+
+				cholesky_solve(np, A, beta.data(), dp.data()); 
+
+				small_step = true; 
+				for(j=0; j<np; j++){
+					trial[j] = p[j] + dp[j]; 
+					if( fabs(dp[j]) > opt.tol * fabs(p[j]) ) small_step = false; 
+				}
+
+				bool widths_ok = true; 
+				for(j=1; j<np; j+=voigt_fit::NPAR){
+					if( !(trial[j] > 0.0) ) widths_ok = false; 
+				}
+
+				if(widths_ok){
+
+					trial_chisq = evaluate(s, trial, opt.method, ws); 
+
+					if(trial_chisq <= chisq){
+						bool small_change = ( chisq - trial_chisq <= opt.tol * chisq ); 
+
+						p = trial; chisq = trial_chisq; 
+						alpha = ws.alpha; beta = ws.beta; 
+						lambda *= 0.1; 
+
+						if(small_change || small_step){
+							res.converged = true; 
+							break; 
+						}
+
+						continue; 
+					}
+				}
+			}
+
+			lambda *= 10.0; 
+
+			if(lambda > LAMBDA_MAX){
+				res.converged = false; 
+				break; 
+			}
+		}
+
+		if(res.iterations > opt.max_iter) res.iterations = opt.max_iter; 
+
+		// standard errors from the diagonal of the covariance matrix alpha^{-1}
+		res.p = p; 
+		res.chisq = chisq; 
+		res.dp.assign(np, std::numeric_limits<double>::quiet_NaN()); 
+
+		A = alpha; 
+		if( cholesky(np, A) ){
+			double scale = s.sig.empty() ? chisq / (n - np) : 1.0; 
+
+			for(j=0; j<np; j++){
+				std::fill(trial.begin(), trial.end(), 0.0); 
+				trial[j] = 1.0; 
+
+				cholesky_solve(np, A, trial.data(), trial.data()); 
+
+				res.dp[j] = sqrt(trial[j] * scale); 
+			}
+		}
+
+		return res; 
+	}
+}
+
+voigt_fit::Options::Options()
+{
+	// Default options
+	max_iter = 200; 
+	tol = 1.0e-10; 
+	lambda = 1.0e-3; 
+	method = Faddeeva::ADAPTIVE; 
+}
+
+void voigt_fit::model(int n, const double *x, const std::vector<double> &p, double *y, Faddeeva::Method method)
+{
+	// Sum of the peaks with parameters p = (h_0, G_0, x0_0, h_1, ..) at the n points x[i]
+
+	int i, k; 
+	std::vector<double> V(n); 
+
+	std::fill(y, y + n, 0.0); 
+
+	for(k=0; k+voigt_fit::NPAR<=static_cast<int>(p.size()); k+=voigt_fit::NPAR){
+		special::Voigt(n, x, p[k], p[k+1], p[k+2], V.data(), method); 
+
+		for(i=0; i<n; i++) y[i] += V[i]; 
+	}
+}
+
+voigt_fit::Result voigt_fit::fit(const Spectrum &s, const Options &opt)
+{
+	// Fit the peaks of one spectrum, starting from s.p
+
+	try{
+		check_spectrum(s); 
+
+		Workspace ws; 
+
+		return fit_spectrum(s, opt, ws); 
+	}
+	catch(std::invalid_argument &e){
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
+	}
+}
+
+std::vector<voigt_fit::Result> voigt_fit::fit_all(const std::vector<Spectrum> &spectra, const Options &opt, int nthreads)
+{
+	// Fit every spectrum in spectra, res[i] is the fit of spectra[i]
+	// The spectra are handed out one at a time through an atomic counter, so threads that draw small spectra
+	// go on to the next one instead of waiting, and every thread allocates its workspace once
+	// All spectra are checked before any thread starts, so that a bad one stops the program from the calling thread
+
+	try{
+		int i, ns; 
+
+		ns = static_cast<int>(spectra.size()); 
+
+		for(i=0; i<ns; i++) check_spectrum(spectra[i]); 
+
+		if(nthreads <= 0) nthreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency())); 
+		nthreads = std::min(nthreads, ns); 
+
+		std::vector<Result> res(ns); 
+		std::atomic<int> next(0); 
+
+		auto worker = [&](){
+			Workspace ws; 
+			int k; 
+
+			while( (k = next++) < ns ) res[k] = fit_spectrum(spectra[k], opt, ws); 
+		}; 
+
+		if(nthreads <= 1){
+			worker(); 
+		}
+		else{
+			std::vector<std::thread> pool; 
+
+			for(i=1; i<nthreads; i++) pool.push_back(std::thread(worker)); 
+
+			worker(); 
+
+			for(i=0; i<static_cast<int>(pool.size()); i++) pool[i].join(); 
+		}
+
+		return res; 
+	}
+	catch(std::invalid_argument &e){
+		useful_funcs::exit_failure_output(e.what()); 
+		exit(EXIT_FAILURE); 
+	}
+}
\ No newline at end of file
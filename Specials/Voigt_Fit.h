@@ -0,0 +1,47 @@
+#ifndef VOIGT_FIT_H
+#define VOIGT_FIT_H
+
+// Declaration of a namespace for fitting sums of Voigt profiles to measured spectra by the Levenberg-Marquardt method
+// The model is y(x) = sum_{k} special::Voigt(x, h_k, G_k, x0_k), its Jacobian is computed by special::Voigt_grad
+// so that each iteration costs one evaluation of w(z) per point and peak, where a finite difference Jacobian costs three or four more
+// fit_all fits many independent spectra in parallel, each thread taking the next unfitted spectrum until none are left
+// See NRinC, sect. 15.5
+
+namespace voigt_fit{
+
+	static const int NPAR = 3; // parameters per peak, stored in the order (h, G, x0)
+
+	// A spectrum to be fitted
+	// sig holds the standard deviation of each y[i], leave it empty for unit weights
+	// p holds the starting values (h_0, G_0, x0_0, h_1, G_1, x0_1, ..), its length sets the number of peaks
+	struct Spectrum{
+		std::vector<double> x, y, sig, p; 
+	}; 
+
+	struct Options{
+		Options(); 
+
+		int max_iter; // maximum number of Levenberg-Marquardt iterations
+		double tol; // the fit has converged once an accepted step lowers chi^2, or changes every parameter, by less than tol relative
+		double lambda; // starting value of the Marquardt parameter
+		Faddeeva::Method method; // algorithm for w(z), see Faddeeva.hh
+	}; 
+
+	struct Result{
+		std::vector<double> p; // fitted parameters, same layout as Spectrum::p
+		std::vector<double> dp; // their standard errors, scaled by sqrt(chi^2 / (n - np)) when the spectrum has no sig
+		double chisq; 
+		int iterations; 
+		bool converged; // false when max_iter is reached or the fit stalls with no step downhill left
+	}; 
+
+	Result fit(const Spectrum &s, const Options &opt = Options()); 
+
+	// nthreads <= 0 uses std::thread::hardware_concurrency() threads
+	std::vector<Result> fit_all(const std::vector<Spectrum> &spectra, const Options &opt = Options(), int nthreads = 0); 
+
+	// y[i] = sum of the peaks with parameters p at the n points x[i]
+	void model(int n, const double *x, const std::vector<double> &p, double *y, Faddeeva::Method method = Faddeeva::ADAPTIVE); 
+}
+
+#endif
\ No newline at end of file